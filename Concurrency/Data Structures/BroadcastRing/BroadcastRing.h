@@ -0,0 +1,327 @@
+#ifndef BROADCASTRING_H_
+#define BROADCASTRING_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const auto RING_CACHE_LINE_SIZE =
+    std::hardware_constructive_interference_size;
+
+// -- WAIT STRATEGIES -- //
+//
+// A wait strategy decides what a producer or consumer does while the ring is
+// full or empty. wait(ready) returns once ready() is true, signal() is called
+// after every cursor move so blocking waiters can be woken.
+
+inline void ring_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/**
+ * Lowest latency, burns a core per waiting thread
+ */
+struct BusySpinWait {
+  template <typename Ready>
+  void wait(Ready ready) {
+    while (!ready()) {
+      ring_cpu_relax();
+    }
+  }
+
+  void signal() {}
+};
+
+/**
+ * Spins briefly then yields the core, good default when threads may
+ * outnumber cores
+ */
+struct YieldingWait {
+  template <typename Ready>
+  void wait(Ready ready) {
+    for (int spins = 0; !ready(); ++spins) {
+      if (spins < SPIN_LIMIT) {
+        ring_cpu_relax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void signal() {}
+
+  static constexpr int SPIN_LIMIT = 100;
+};
+
+/**
+ * Sleeps on a condition variable. signal() only takes the lock when someone
+ * is actually asleep, so the fast path stays a single atomic load.
+ */
+class BlockingWait {
+ public:
+  template <typename Ready>
+  void wait(Ready ready) {
+    if (ready()) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mtx_);
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    // pairs with the fence in signal(): either the signaller sees waiters_ or
+    // we see the cursor it published
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv_.wait(lock, ready);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void signal() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      cv_.notify_all();
+    }
+  }
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::atomic<int> waiters_{0};
+};
+
+/**
+ * Single producer, multi consumer broadcast ring in the style of the LMAX
+ * Disruptor.
+ *
+ * Every event is written once into a preallocated slot and every consumer
+ * reads it in place through its own cursor, instead of the producer copying
+ * it into one SPSCQueue per consumer. The producer never laps the slowest
+ * consumer. A consumer may depend on other consumers, in which case it only
+ * sees an event after all of its dependencies have finished with it (e.g.
+ * replication only after logging).
+ *
+ * Cursors count events, so cursor == n means events [0, n) are done.
+ *
+ * REQUIRES:
+ * T is default constructible and assignable (slots are preallocated), all
+ * consumers are added before the first publish
+ */
+template <typename T, typename WaitStrategy = YieldingWait>
+class BroadcastRing {
+ private:
+  struct Sequence;
+
+ public:
+  using size_type = std::size_t;
+
+  class Consumer;
+
+  /**
+   * Creates a ring with capacity rounded up to a power of two
+   *
+   * THROWS:
+   * std::invalid_argument if capacity is 0
+   */
+  explicit BroadcastRing(size_type capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("BroadcastRing: capacity must be > 0");
+    }
+    capacity_ = 1;
+    while (capacity_ < capacity) {
+      capacity_ <<= 1;
+    }
+    mask_ = capacity_ - 1;
+    buffer_ = std::make_unique<T[]>(capacity_);
+  }
+
+  BroadcastRing(const BroadcastRing& other) = delete;
+  BroadcastRing& operator=(const BroadcastRing& other) = delete;
+  BroadcastRing(BroadcastRing&& other) = delete;
+  BroadcastRing& operator=(BroadcastRing&& other) = delete;
+  ~BroadcastRing() = default;
+
+  /**
+   * Registers a new consumer that starts at the current producer cursor
+   *
+   * ARGS:
+   * depends_on: consumers that must finish an event before this one sees it
+   *
+   * RETURNS:
+   * handle the consumer thread polls through
+   */
+  Consumer add_consumer(const std::vector<Consumer>& depends_on = {}) {
+    auto cursor = std::make_unique<Sequence>();
+    cursor->value.store(producer_.value.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    std::vector<const Sequence*> barrier;
+    for (const Consumer& dep : depends_on) {
+      barrier.push_back(dep.cursor_);
+    }
+    Sequence* raw = cursor.get();
+    consumer_cursors_.push_back(std::move(cursor));
+    return Consumer(this, raw, std::move(barrier));
+  }
+
+  /**
+   * Writes item into the next slot, waiting while the slowest consumer is a
+   * full ring behind. Producer thread only.
+   */
+  void publish(T item) {
+    uint64_t next = producer_.value.load(std::memory_order_relaxed);
+    if (next - cached_gate_ >= capacity_) {
+      wait_.wait([&] {
+        cached_gate_ = min_consumer_cursor(next);
+        return next - cached_gate_ < capacity_;
+      });
+    }
+    buffer_[next & mask_] = std::move(item);
+    producer_.value.store(next + 1, std::memory_order_release);
+    wait_.signal();
+  }
+
+  /**
+   * Publishes item unless the ring is full. Producer thread only.
+   *
+   * RETURNS:
+   * false if the slowest consumer is a full ring behind
+   */
+  bool try_publish(T item) {
+    uint64_t next = producer_.value.load(std::memory_order_relaxed);
+    if (next - cached_gate_ >= capacity_) {
+      cached_gate_ = min_consumer_cursor(next);
+      if (next - cached_gate_ >= capacity_) {
+        return false;
+      }
+    }
+    buffer_[next & mask_] = std::move(item);
+    producer_.value.store(next + 1, std::memory_order_release);
+    wait_.signal();
+    return true;
+  }
+
+  /**
+   * Number of events published so far
+   */
+  uint64_t cursor() const {
+    return producer_.value.load(std::memory_order_acquire);
+  }
+
+  size_type capacity() const { return capacity_; }
+
+  /**
+   * Handle through which one consumer thread reads events. Cheap to copy, but
+   * only one thread may poll a given consumer.
+   */
+  class Consumer {
+   public:
+    /**
+     * Hands every event that is currently available to handler(event, seq)
+     * and then moves this consumer's cursor past the whole batch
+     *
+     * RETURNS:
+     * number of events handled
+     */
+    template <typename Handler>
+    size_type poll(Handler&& handler) {
+      uint64_t next = cursor_->value.load(std::memory_order_relaxed);
+      uint64_t available = ring_->available_to(barrier_);
+      if (available == next) {
+        return 0;
+      }
+      return consume(next, available, handler);
+    }
+
+    /**
+     * Like poll but waits, using the ring's wait strategy, until at least one
+     * event is available
+     */
+    template <typename Handler>
+    size_type wait_and_poll(Handler&& handler) {
+      uint64_t next = cursor_->value.load(std::memory_order_relaxed);
+      uint64_t available = next;
+      ring_->wait_.wait([&] {
+        available = ring_->available_to(barrier_);
+        return available != next;
+      });
+      return consume(next, available, handler);
+    }
+
+    /**
+     * Number of events this consumer has finished
+     */
+    uint64_t cursor() const {
+      return cursor_->value.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend class BroadcastRing;
+
+    Consumer(BroadcastRing* ring, Sequence* cursor,
+             std::vector<const Sequence*> barrier)
+        : ring_(ring), cursor_(cursor), barrier_(std::move(barrier)) {}
+
+    template <typename Handler>
+    size_type consume(uint64_t next, uint64_t available, Handler& handler) {
+      for (uint64_t seq = next; seq < available; ++seq) {
+        handler(static_cast<const T&>(ring_->buffer_[seq & ring_->mask_]),
+                seq);
+      }
+      cursor_->value.store(available, std::memory_order_release);
+      ring_->wait_.signal();
+      return static_cast<size_type>(available - next);
+    }
+
+    BroadcastRing* ring_;
+    Sequence* cursor_;
+    std::vector<const Sequence*> barrier_;
+  };
+
+ private:
+  struct alignas(RING_CACHE_LINE_SIZE) Sequence {
+    std::atomic<uint64_t> value{0};
+  };
+
+  // highest event a consumer with the given dependencies may read up to
+  uint64_t available_to(const std::vector<const Sequence*>& barrier) const {
+    uint64_t available = producer_.value.load(std::memory_order_acquire);
+    for (const Sequence* dep : barrier) {
+      uint64_t done = dep->value.load(std::memory_order_acquire);
+      if (done < available) {
+        available = done;
+      }
+    }
+    return available;
+  }
+
+  uint64_t min_consumer_cursor(uint64_t upper) const {
+    uint64_t slowest = upper;
+    for (const auto& cursor : consumer_cursors_) {
+      uint64_t done = cursor->value.load(std::memory_order_acquire);
+      if (done < slowest) {
+        slowest = done;
+      }
+    }
+    return slowest;
+  }
+
+  std::unique_ptr<T[]> buffer_;
+  size_type capacity_;
+  uint64_t mask_;
+  std::vector<std::unique_ptr<Sequence>> consumer_cursors_;
+  WaitStrategy wait_;
+  Sequence producer_;
+  // producer local copy of the slowest consumer cursor
+  alignas(RING_CACHE_LINE_SIZE) uint64_t cached_gate_ = 0;
+};
+
+#endif  // BROADCASTRING_H_
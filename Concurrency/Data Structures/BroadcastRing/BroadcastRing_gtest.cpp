@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "BroadcastRing.h"
+
+template <typename Wait>
+class BroadcastRingTest : public ::testing::Test {};
+
+using WaitStrategies = ::testing::Types<BusySpinWait, YieldingWait, BlockingWait>;
+TYPED_TEST_SUITE(BroadcastRingTest, WaitStrategies);
+
+TEST(BroadcastRing, CapacityRoundsUpToPowerOfTwo) {
+  BroadcastRing<int> ring(5);
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_THROW(BroadcastRing<int>(0), std::invalid_argument);
+}
+
+TEST(BroadcastRing, NonConEveryConsumerSeesEveryEvent) {
+  BroadcastRing<int> ring(8);
+  auto a = ring.add_consumer();
+  auto b = ring.add_consumer();
+
+  for (int i = 0; i < 5; ++i) {
+    ring.publish(i);
+  }
+
+  std::vector<int> seen_a;
+  std::vector<int> seen_b;
+  EXPECT_EQ(a.poll([&](const int& v, uint64_t) { seen_a.push_back(v); }), 5u);
+  EXPECT_EQ(b.poll([&](const int& v, uint64_t) { seen_b.push_back(v); }), 5u);
+  EXPECT_EQ(seen_a, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_EQ(seen_b, seen_a);
+  EXPECT_EQ(a.poll([](const int&, uint64_t) {}), 0u);
+}
+
+TEST(BroadcastRing, NonConProducerGatesOnSlowestConsumer) {
+  BroadcastRing<int> ring(4);
+  auto fast = ring.add_consumer();
+  auto slow = ring.add_consumer();
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring.try_publish(i));
+  }
+  fast.poll([](const int&, uint64_t) {});
+  // fast is caught up but slow still holds all four slots
+  EXPECT_FALSE(ring.try_publish(4));
+
+  EXPECT_EQ(slow.poll([](const int&, uint64_t) {}), 4u);
+  EXPECT_TRUE(ring.try_publish(4));
+}
+
+TEST(BroadcastRing, NonConDependentConsumerWaitsForUpstream) {
+  BroadcastRing<int> ring(8);
+  auto logger = ring.add_consumer();
+  auto replicator = ring.add_consumer({logger});
+
+  ring.publish(1);
+  ring.publish(2);
+  EXPECT_EQ(replicator.poll([](const int&, uint64_t) {}), 0u);
+
+  logger.poll([](const int&, uint64_t) {});
+  std::vector<int> seen;
+  EXPECT_EQ(replicator.poll([&](const int& v, uint64_t) { seen.push_back(v); }),
+            2u);
+  EXPECT_EQ(seen, (std::vector<int>{1, 2}));
+}
+
+TEST(BroadcastRing, NonConSequenceNumbersAreContiguous) {
+  BroadcastRing<int> ring(4);
+  auto c = ring.add_consumer();
+  uint64_t expected = 0;
+  for (int round = 0; round < 10; ++round) {
+    ring.publish(round);
+    ring.publish(round);
+    c.poll([&](const int&, uint64_t seq) { EXPECT_EQ(seq, expected++); });
+  }
+  EXPECT_EQ(c.cursor(), 20u);
+  EXPECT_EQ(ring.cursor(), 20u);
+}
+
+TYPED_TEST(BroadcastRingTest, ConcurrentFanOut) {
+  constexpr int NUM_CONSUMERS = 3;
+  constexpr uint64_t NUM_EVENTS = 20000;
+  BroadcastRing<uint64_t, TypeParam> ring(1024);
+
+  std::vector<typename BroadcastRing<uint64_t, TypeParam>::Consumer> consumers;
+  for (int i = 0; i < NUM_CONSUMERS; ++i) {
+    consumers.push_back(ring.add_consumer());
+  }
+
+  std::vector<uint64_t> sums(NUM_CONSUMERS, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < NUM_CONSUMERS; ++i) {
+    threads.emplace_back([&, i]() {
+      uint64_t expected = 0;
+      while (expected < NUM_EVENTS) {
+        consumers[i].wait_and_poll([&](const uint64_t& v, uint64_t seq) {
+          EXPECT_EQ(seq, expected);
+          EXPECT_EQ(v, expected);
+          sums[i] += v;
+          ++expected;
+        });
+      }
+    });
+  }
+
+  for (uint64_t i = 0; i < NUM_EVENTS; ++i) {
+    ring.publish(i);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (uint64_t sum : sums) {
+    EXPECT_EQ(sum, NUM_EVENTS * (NUM_EVENTS - 1) / 2);
+  }
+}
+
+TYPED_TEST(BroadcastRingTest, ConcurrentDependencyChain) {
+  constexpr uint64_t NUM_EVENTS = 10000;
+  BroadcastRing<uint64_t, TypeParam> ring(512);
+  auto first = ring.add_consumer();
+  auto second = ring.add_consumer({first});
+  auto third = ring.add_consumer({first, second});
+
+  std::atomic<bool> ordering_ok{true};
+  auto run = [&](auto& consumer, auto* upstream) {
+    uint64_t done = 0;
+    while (done < NUM_EVENTS) {
+      done += consumer.wait_and_poll([&](const uint64_t&, uint64_t seq) {
+        if (upstream != nullptr && upstream->cursor() <= seq) {
+          ordering_ok.store(false);
+        }
+      });
+    }
+  };
+
+  std::thread t1([&] { run(first, decltype(&first)(nullptr)); });
+  std::thread t2([&] { run(second, &first); });
+  std::thread t3([&] { run(third, &second); });
+
+  for (uint64_t i = 0; i < NUM_EVENTS; ++i) {
+    ring.publish(i);
+  }
+  t1.join();
+  t2.join();
+  t3.join();
+
+  EXPECT_TRUE(ordering_ok.load());
+  EXPECT_EQ(third.cursor(), NUM_EVENTS);
+}
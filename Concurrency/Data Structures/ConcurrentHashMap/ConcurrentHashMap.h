@@ -0,0 +1,305 @@
+#ifndef CONCURRENT_HASH_MAP_H_
+#define CONCURRENT_HASH_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../../../Data Structures/HashTable/HashTable.h"
+#include "../../../Data Structures/HashTable/XXHash.h"
+
+/**
+ * Thread-safe map made of independently locked HashTable shards (lock
+ * striping).
+ *
+ * The map hashes a key with Hash and reuses that hash inside the shard for
+ * lookups, erases and updates of existing keys; only inserting a new key
+ * hashes it a second time, inside HashTable. The shard comes from bits 32
+ * and up of the hash and the shard's HashTable masks its low bits to pick a
+ * bucket, so the two choices do not correlate. Hash must spread its entropy
+ * over all 64 bits, which the default XXHash does.
+ *
+ * Each shard sits on its own cache line behind a reader-writer lock,
+ * lookups in different shards never touch the same line and lookups in the
+ * same shard run in parallel. A shard grows on its own when its HashTable
+ * rehashes, the other shards keep serving while it does.
+ *
+ * Values are copied out of lookups rather than referenced, a reference would
+ * dangle as soon as the shard lock is released.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class ConcurrentHashMap {
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  static constexpr size_type DEFAULT_SHARDS = 16;
+
+  /**
+   * Constructs an empty map
+   *
+   * ARGS:
+   * num_shards: number of independently locked segments, rounded up to a
+   *             power of two
+   *
+   * THROWS:
+   * std::invalid_argument if num_shards is 0
+   */
+  explicit ConcurrentHashMap(size_type num_shards = DEFAULT_SHARDS);
+
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  // -- CAPACITY -- //
+
+  /**
+   * Number of key-value pairs. Shards are counted one at a time, so under
+   * concurrent writes this is only a snapshot
+   */
+  size_type size() const;
+
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Number of shards the keys are spread across
+   */
+  size_type shard_count() const { return shard_mask_ + 1; }
+
+  // -- MODIFIERS -- //
+
+  /**
+   * Adds the key-value pair, replacing the value if the key already exists
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   *
+   * RETURNS:
+   * true if the key was inserted, false if an existing value was replaced
+   */
+  bool insert_or_assign(const key_type& key, const value_type& value);
+
+  /**
+   * Removes the element with the specified key
+   *
+   * ARGS:
+   * key: the key of the element to remove
+   *
+   * RETURNS:
+   * true if an element was removed
+   */
+  bool erase(const key_type& key);
+
+  /**
+   * Updates the value of key in place while holding its shard exclusively,
+   * so read-modify-write sequences are atomic with respect to every other
+   * operation on the key. A default constructed value is inserted first if
+   * the key does not exist.
+   *
+   * ARGS:
+   * key: the key to update
+   * fn: callable taking value_type&, must not call back into this map
+   *
+   * RETURNS:
+   * whatever fn returned
+   */
+  template <typename F>
+  std::invoke_result_t<F&, value_type&> compute(const key_type& key, F&& fn);
+
+  /**
+   * Like compute() but leaves the map unchanged if the key does not exist
+   *
+   * RETURNS:
+   * true if fn was called
+   */
+  template <typename F>
+  bool compute_if_present(const key_type& key, F&& fn);
+
+  // -- LOOKUP -- //
+
+  /**
+   * Looks up the value of key
+   *
+   * ARGS:
+   * key: the key to search for
+   *
+   * RETURNS:
+   * a copy of the value, or std::nullopt if the key does not exist
+   */
+  std::optional<value_type> find(const key_type& key) const;
+
+  /**
+   * RETURNS:
+   * true if key is in the map, else false
+   */
+  bool contains(const key_type& key) const;
+
+ private:
+  // A key together with its hash, so a shard can look it up without hashing
+  // it again
+  struct HashedKey {
+    const key_type& key;
+    size_type hash;
+  };
+
+  // Transparent Hash and KeyEqual for the shards' tables, they take keys as
+  // well as HashedKeys
+  struct ShardHash {
+    using is_transparent = void;
+
+    size_type operator()(const key_type& key) const { return hash(key); }
+    size_type operator()(const HashedKey& key) const { return key.hash; }
+
+    Hash hash;
+  };
+
+  struct ShardEqual {
+    using is_transparent = void;
+
+    bool operator()(const key_type& a, const key_type& b) const {
+      return equal(a, b);
+    }
+    bool operator()(const key_type& a, const HashedKey& b) const {
+      return equal(a, b.key);
+    }
+
+    KeyEqual equal;
+  };
+
+  struct alignas(std::hardware_constructive_interference_size) Shard {
+    mutable std::shared_mutex mtx;
+    HashTable<key_type, value_type, ShardHash, ShardEqual> table;
+  };
+
+  HashedKey hashed(const key_type& key) const { return {key, hasher_(key)}; }
+
+  /**
+   * Helper function that picks the shard of a hashed key from bits 32 and
+   * up, the shard's HashTable picks its bucket from the low bits
+   */
+  Shard& shard_for(const HashedKey& key) const {
+    return shards_[(key.hash >> 32) & shard_mask_];
+  }
+
+  static size_type round_up_pow2(size_type n) {
+    if (n == 0) {
+      throw std::invalid_argument("ConcurrentHashMap needs at least one shard");
+    }
+    size_type pow2 = 1;
+    while (pow2 < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  size_type shard_mask_;
+  std::unique_ptr<Shard[]> shards_;
+  Hash hasher_;
+};
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+ConcurrentHashMap<K, V, Hash, KeyEqual>::ConcurrentHashMap(
+    size_type num_shards)
+    : shard_mask_(round_up_pow2(num_shards) - 1),
+      shards_(new Shard[shard_mask_ + 1]) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename ConcurrentHashMap<K, V, Hash, KeyEqual>::size_type
+ConcurrentHashMap<K, V, Hash, KeyEqual>::size() const {
+  size_type total = 0;
+  for (size_type i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock lock(shards_[i].mtx);
+    total += shards_[i].table.size();
+  }
+  return total;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual>::insert_or_assign(
+    const key_type& key, const value_type& value) {
+  HashedKey hk = hashed(key);
+  Shard& shard = shard_for(hk);
+  std::unique_lock lock(shard.mtx);
+  auto* node = shard.table.find(hk);
+  if (node != nullptr) {
+    node->value = value;
+    return false;
+  }
+  shard.table.insert(key, value);
+  return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual>::erase(const key_type& key) {
+  HashedKey hk = hashed(key);
+  Shard& shard = shard_for(hk);
+  std::unique_lock lock(shard.mtx);
+  size_type before = shard.table.size();
+  shard.table.erase(hk);
+  return shard.table.size() != before;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename F>
+std::invoke_result_t<F&, V&> ConcurrentHashMap<K, V, Hash, KeyEqual>::compute(
+    const key_type& key, F&& fn) {
+  HashedKey hk = hashed(key);
+  Shard& shard = shard_for(hk);
+  std::unique_lock lock(shard.mtx);
+  auto* node = shard.table.find(hk);
+  if (node == nullptr) {
+    node = shard.table.try_emplace(key).first;
+  }
+  return fn(node->value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename F>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual>::compute_if_present(
+    const key_type& key, F&& fn) {
+  HashedKey hk = hashed(key);
+  Shard& shard = shard_for(hk);
+  std::unique_lock lock(shard.mtx);
+  auto* node = shard.table.find(hk);
+  if (node == nullptr) {
+    return false;
+  }
+  fn(node->value);
+  return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> ConcurrentHashMap<K, V, Hash, KeyEqual>::find(
+    const key_type& key) const {
+  HashedKey hk = hashed(key);
+  const Shard& shard = shard_for(hk);
+  std::shared_lock lock(shard.mtx);
+  const auto& table = shard.table;
+  auto* node = table.find(hk);
+  if (node == nullptr) {
+    return std::nullopt;
+  }
+  return node->value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ConcurrentHashMap<K, V, Hash, KeyEqual>::contains(
+    const key_type& key) const {
+  HashedKey hk = hashed(key);
+  const Shard& shard = shard_for(hk);
+  std::shared_lock lock(shard.mtx);
+  return shard.table.contains(hk);
+}
+
+#endif  // CONCURRENT_HASH_MAP_H_
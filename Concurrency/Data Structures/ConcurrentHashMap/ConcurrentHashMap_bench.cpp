@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+
+#include "ConcurrentHashMap.h"
+
+// Sharded map against one HashTable behind a single reader-writer lock, on
+// a read-mostly mix (90% find, 10% insert_or_assign) over a fixed key space.
+
+class SingleLockMap {
+ public:
+  explicit SingleLockMap(size_t) {}
+
+  std::optional<int> find(int key) const {
+    std::shared_lock lock(mtx_);
+    auto* node = table_.find(key);
+    return node ? std::optional<int>(node->value) : std::nullopt;
+  }
+
+  void insert_or_assign(int key, int value) {
+    std::unique_lock lock(mtx_);
+    table_.insert_or_assign(key, value);
+  }
+
+ private:
+  mutable std::shared_mutex mtx_;
+  HashTable<int, int> table_;
+};
+
+constexpr int NUM_KEYS = 1 << 14;
+
+template <typename Map>
+static void BM_ReadMostly(benchmark::State& state) {
+  static Map* map = nullptr;
+  if (state.thread_index() == 0) {
+    map = new Map(64);
+    for (int key = 0; key < NUM_KEYS; ++key) {
+      map->insert_or_assign(key, key);
+    }
+  }
+  uint32_t rng = state.thread_index() * 7919 + 1;
+  for (auto _ : state) {
+    rng = rng * 1664525u + 1013904223u;
+    int key = static_cast<int>((rng >> 8) % NUM_KEYS);
+    if ((rng & 0xF) < 2) {
+      map->insert_or_assign(key, key);
+    } else {
+      benchmark::DoNotOptimize(map->find(key));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete map;
+    map = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_ReadMostly, SingleLockMap)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadMostly, ConcurrentHashMap<int, int>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
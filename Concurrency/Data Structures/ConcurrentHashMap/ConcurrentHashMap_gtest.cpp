@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentHashMap.h"
+
+// Basic operations
+TEST(ConcurrentHashMap, InsertFind) {
+  ConcurrentHashMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.insert_or_assign(1, "one"));
+  EXPECT_FALSE(map.insert_or_assign(1, "uno"));
+  EXPECT_EQ(map.find(1), "uno");
+  EXPECT_EQ(map.find(2), std::nullopt);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(ConcurrentHashMap, Erase) {
+  ConcurrentHashMap<int, int> map;
+  map.insert_or_assign(5, 50);
+  EXPECT_TRUE(map.erase(5));
+  EXPECT_FALSE(map.erase(5));
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentHashMap, Compute) {
+  ConcurrentHashMap<std::string, int> map;
+  // missing keys start from a default value
+  EXPECT_EQ(map.compute("hits", [](int& v) { return ++v; }), 1);
+  EXPECT_EQ(map.compute("hits", [](int& v) { return ++v; }), 2);
+  EXPECT_FALSE(map.compute_if_present("misses", [](int& v) { ++v; }));
+  EXPECT_FALSE(map.contains("misses"));
+  EXPECT_TRUE(map.compute_if_present("hits", [](int& v) { v *= 10; }));
+  EXPECT_EQ(map.find("hits"), 20);
+}
+
+TEST(ConcurrentHashMap, ShardCountRoundsUp) {
+  using Map = ConcurrentHashMap<int, int>;
+  EXPECT_EQ(Map(1).shard_count(), 1u);
+  EXPECT_EQ(Map(5).shard_count(), 8u);
+  EXPECT_EQ(Map().shard_count(), Map::DEFAULT_SHARDS);
+  EXPECT_THROW(Map(0), std::invalid_argument);
+}
+
+// XXHash that counts how often it is called
+struct CountingHash {
+  static inline int calls = 0;
+
+  size_t operator()(int key) const {
+    calls++;
+    return XXHash<int>{}(key);
+  }
+};
+
+// The map hashes a key once and hands the hash to the shard, only a new key
+// is hashed again when the shard's table stores it
+TEST(ConcurrentHashMap, HashesKeyOnce) {
+  ConcurrentHashMap<int, int, CountingHash> map;
+  CountingHash::calls = 0;
+  map.insert_or_assign(1, 10);
+  EXPECT_EQ(CountingHash::calls, 2);
+
+  CountingHash::calls = 0;
+  map.insert_or_assign(1, 11);
+  EXPECT_EQ(map.find(1), 11);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_EQ(map.compute(1, [](int& v) { return ++v; }), 12);
+  EXPECT_TRUE(map.compute_if_present(1, [](int& v) { ++v; }));
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_EQ(CountingHash::calls, 7);
+}
+
+// Each shard rehashes on its own
+TEST(ConcurrentHashMap, GrowsPastManyRehashes) {
+  ConcurrentHashMap<int, int> map(4);
+  for (int i = 0; i < 10000; ++i) {
+    map.insert_or_assign(i, i * 2);
+  }
+  EXPECT_EQ(map.size(), 10000u);
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_EQ(map.find(i), i * 2);
+  }
+}
+
+// Concurrency tests
+TEST(ConcurrentHashMap, ConcurrentDisjointInserts) {
+  ConcurrentHashMap<int, int> map;
+  const int num_threads = 4;
+  const int per_thread = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, t, per_thread]() {
+      for (int i = 0; i < per_thread; ++i) {
+        int key = t * per_thread + i;
+        map.insert_or_assign(key, key);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(map.size(), static_cast<size_t>(num_threads * per_thread));
+  for (int key = 0; key < num_threads * per_thread; ++key) {
+    ASSERT_EQ(map.find(key), key);
+  }
+}
+
+TEST(ConcurrentHashMap, ConcurrentComputeIsAtomic) {
+  ConcurrentHashMap<int, long> map(2);
+  const int num_threads = 4;
+  const int increments = 5000;
+  const int num_keys = 8;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, increments, num_keys]() {
+      for (int i = 0; i < increments; ++i) {
+        map.compute(i % num_keys, [](long& v) { ++v; });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  long total = 0;
+  for (int key = 0; key < num_keys; ++key) {
+    total += map.find(key).value_or(0);
+  }
+  EXPECT_EQ(total, static_cast<long>(num_threads) * increments);
+}
+
+TEST(ConcurrentHashMap, ConcurrentReadersAndWriters) {
+  ConcurrentHashMap<int, int> map;
+  const int num_keys = 512;
+  for (int key = 0; key < num_keys; ++key) {
+    map.insert_or_assign(key, 0);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<bool> torn{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&]() {
+      for (int round = 1; round <= 20; ++round) {
+        for (int key = 0; key < num_keys; ++key) {
+          map.insert_or_assign(key, round);
+          map.erase(key + num_keys);
+          map.insert_or_assign(key + num_keys, round);
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&]() {
+      while (!done) {
+        for (int key = 0; key < num_keys; ++key) {
+          auto val = map.find(key);
+          if (!val.has_value() || *val < 0 || *val > 20) {
+            torn = true;
+          }
+        }
+      }
+    });
+  }
+  threads[0].join();
+  threads[1].join();
+  done = true;
+  threads[2].join();
+  threads[3].join();
+
+  EXPECT_FALSE(torn);
+  EXPECT_EQ(map.size(), static_cast<size_t>(2 * num_keys));
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
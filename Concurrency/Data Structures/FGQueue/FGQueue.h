@@ -1,77 +1,114 @@
 #ifndef FGQUEUE_H_
 #define FGQUEUE_H_
 
-#include <algorithm>
-#include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <mutex>
+#include <optional>
+#include <utility>
 
+/**
+ * Two-lock queue (Michael & Scott). Pushers take tail_mtx_ and poppers take
+ * head_mtx_, so the two ends mostly work in parallel. They still meet
+ * briefly: every pop takes tail_mtx_ just long enough to read tail_ and see
+ * whether the queue is empty, and a push takes head_mtx_ to wake a consumer
+ * when one is waiting.
+ *
+ * Values are stored in place in the nodes and popped nodes go to a bounded
+ * freelist, so a queue in steady state does not touch the allocator.
+ * Consumers that would rather sleep than poll can use wait_and_pop() or
+ * wait_for_pop(), which block on a condition variable tied to head_mtx_.
+ */
 template <typename T>
 class FGQueue {
   using value_type = T;
 
  public:
+  static constexpr size_t DEFAULT_MAX_FREE_NODES = 256;
+
   /**
-   * default constructor that sets the tail to the head_
+   * constructor that sets up the dummy node
+   *
+   * ARGS:
+   * max_free_nodes: how many popped nodes are kept around for reuse, anything
+   *                 past that is deleted
    */
-  FGQueue() : head_(new Node), tail_(head_.get()) {}
+  explicit FGQueue(size_t max_free_nodes = DEFAULT_MAX_FREE_NODES)
+      : head_(new Node), tail_(head_), max_free_nodes_(max_free_nodes) {}
 
   FGQueue(const FGQueue& other) = delete;
   FGQueue& operator=(const FGQueue& other) = delete;
 
   /**
-   * unique ptrs handle clean up
+   * deallocates the queued nodes and the freelist
    */
-  ~FGQueue() = default;
+  ~FGQueue() { destroy(); }
 
   /**
-   * move constructor: steals from rvalue other
+   * move constructor: steals from rvalue other, other may only be destroyed
+   * or assigned to afterwards
    *
    * ARGS:
    * other: rvalue that will be stolen from
    */
   FGQueue(FGQueue&& other) noexcept {
-    if (this != &other) {
-      std::scoped_lock lock(head_mtx_, other.head_mtx_, tail_mtx_,
-                            other.tail_mtx_);
-      head_ = std::move(other.head_);
-      tail_ = other.tail_;
-
-      other.tail_ = nullptr;
-    }
+    std::scoped_lock lock(other.head_mtx_, other.tail_mtx_, other.free_mtx_);
+    steal(other);
   }
 
   /**
-   * move assignment operator: steals from rvalue other
+   * move assignment operator: deallocates and then steals from rvalue other,
+   * other may only be destroyed or assigned to afterwards
    *
    * ARGS:
    * other: rvalue that will be stolen from
+   *
+   * RETURNS:
+   * reference to this queue
    */
   FGQueue& operator=(FGQueue&& other) noexcept {
     if (this != &other) {
       std::scoped_lock lock(head_mtx_, other.head_mtx_, tail_mtx_,
-                            other.tail_mtx_);
-      head_.reset();
-
-      head_ = std::move(other.head_);
-      tail_ = other.tail_;
-
-      other.tail_ = nullptr;
+                            other.tail_mtx_, free_mtx_, other.free_mtx_);
+      destroy();
+      steal(other);
     }
     return *this;
   }
 
   /**
-   * pops from the front of the queue
+   * pops from the front of the queue without blocking
    *
    * RETURNS:
-   * returns a shared ptr that contains the value of the head if the queue is
-   * not empty. otherwise, the shared_ptr contains nullptr as the queue is empty
+   * the value at the front if the queue is not empty, otherwise std::nullopt
    */
-  std::shared_ptr<value_type> try_pop() {
-    std::unique_ptr<Node> old_head = pop_head();
-    Node* const node = old_head.get();
-    return node ? node->data : nullptr;
-  }
+  std::optional<value_type> try_pop();
+
+  /**
+   * pops from the front of the queue, sleeping until an element is pushed if
+   * the queue is empty
+   *
+   * RETURNS:
+   * the value at the front of the queue
+   */
+  value_type wait_and_pop();
+
+  /**
+   * pops from the front of the queue, sleeping for up to timeout if the queue
+   * is empty
+   *
+   * ARGS:
+   * timeout: longest time to wait for an element
+   *
+   * RETURNS:
+   * the value at the front of the queue, or std::nullopt if nothing was
+   * pushed before the timeout expired
+   */
+  template <typename Rep, typename Period>
+  std::optional<value_type> wait_for_pop(
+      const std::chrono::duration<Rep, Period>& timeout);
 
   /*
    * Adds client provided element to the end of the queue
@@ -79,73 +116,203 @@ class FGQueue {
    * ARGS:
    * item: element of type T that will be added to the queue
    */
-  void push(value_type item) {
-    // as unique and shared ptr are expensie to make we allow other threads to
-    // work while these get constructed
-    std::unique_ptr<Node> new_node = std::make_unique<Node>();
-    std::shared_ptr<value_type> new_value =
-        std::make_shared<T>(std::move(item));
-    // grab the new_tail so we can work on it
-    Node* const new_tail = new_node.get();
-    // lock the function so we can do our work now
-    std::lock_guard tail_lock(tail_mtx_);
-    tail_->data = new_value;
-    tail_->next = std::move(new_node);
-    // set the tail to the new_tail
-    tail_ = new_tail;
-  }
+  void push(value_type item);
 
  private:
   struct Node {
-    // shared_ptr so that this works on any type as we dont need the default
-    // constructor
-    std::shared_ptr<value_type> data;
-    // unique ptr handles clean up
-    std::unique_ptr<Node> next{nullptr};
-
-    Node() = default;
-
-    explicit Node(T data) : data(std::make_shared<T>(std::move(data))) {}
+    // empty in the dummy node at the tail
+    std::optional<value_type> value;
+    Node* next = nullptr;
   };
 
   /**
-   * helper function that pops head if the queue is not empty
+   * Helper function that reads the tail under its lock so poppers never race
+   * with a push that is linking a new node
    *
    * RETURNS:
-   * returns a unique_ptr with the old_head node if the queue is not empty.
-   * otherwise it will return a unique_ptr with a nullptr.
+   * the current dummy node
    */
-  std::unique_ptr<Node> pop_head() {
-    std::lock_guard head_lock(head_mtx_);
-    if (not_empty()) {
-      std::unique_ptr<Node> old_head = std::move(head_);
-      head_ = std::move(old_head->next);
-      return old_head;
-    }
-    return nullptr;
+  Node* get_tail() {
+    std::lock_guard tail_lock(tail_mtx_);
+    return tail_;
   }
 
   /**
-   * Helper function that checks if the queue is empty
+   * Helper function that moves the front value out and unlinks its node.
+   * IMPORTANT: head_mtx_ must be held and the queue must not be empty
+   *
+   * ARGS:
+   * value: receives the value that was at the front of the queue
    *
    * RETURNS:
-   * if the queue is empty returns true. otherwise, returns false
+   * the unlinked node, to be handed to release_node() once unlocked
    */
-  bool empty() const { return head_.get() == tail_; }
+  Node* unsafe_pop_head(std::optional<value_type>& value) {
+    Node* old_head = head_;
+    // if the move throws the queue is left untouched
+    value.emplace(std::move(*old_head->value));
+    old_head->value.reset();
+    head_ = old_head->next;
+    return old_head;
+  }
 
   /**
-   * Helper function that checks if the queue is not empty
-   *
-   * RETURNS:
-   * if the queue is not empty returns true, otherwise returns false
+   * Helper function that takes a node off the freelist, or allocates one if
+   * the freelist is empty
+   */
+  Node* acquire_node() {
+    {
+      std::lock_guard free_lock(free_mtx_);
+      if (free_head_ != nullptr) {
+        Node* node = free_head_;
+        free_head_ = node->next;
+        --free_count_;
+        node->next = nullptr;
+        return node;
+      }
+    }
+    return new Node;
+  }
+
+  /**
+   * Helper function that hands an empty node back to the freelist, or
+   * deletes it if the freelist is full
    */
-  bool not_empty() const { return head_->next != nullptr; }
+  void release_node(Node* node) {
+    {
+      std::lock_guard free_lock(free_mtx_);
+      if (free_count_ < max_free_nodes_) {
+        node->next = free_head_;
+        free_head_ = node;
+        ++free_count_;
+        return;
+      }
+    }
+    delete node;
+  }
 
-  std::unique_ptr<Node> head_;  // front
-  Node* tail_;                  // back
+  /**
+   * Helper function that deletes every node this queue owns. IMPORTANT: it
+   * does not lock
+   */
+  void destroy() noexcept {
+    for (Node* node : {head_, free_head_}) {
+      while (node != nullptr) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+    head_ = tail_ = free_head_ = nullptr;
+    free_count_ = 0;
+  }
+
+  /**
+   * Helper function that takes over other's nodes. IMPORTANT: it does not
+   * lock
+   */
+  void steal(FGQueue& other) noexcept {
+    head_ = std::exchange(other.head_, nullptr);
+    tail_ = std::exchange(other.tail_, nullptr);
+    free_head_ = std::exchange(other.free_head_, nullptr);
+    free_count_ = std::exchange(other.free_count_, 0);
+    max_free_nodes_ = other.max_free_nodes_;
+  }
+
+  Node* head_ = nullptr;  // front
+  Node* tail_ = nullptr;  // back, always the dummy node
+
+  Node* free_head_ = nullptr;
+  size_t free_count_ = 0;
+  size_t max_free_nodes_ = DEFAULT_MAX_FREE_NODES;
+
+  // consumers sleeping on not_empty_, lets push skip head_mtx_ when there
+  // are none
+  std::atomic<size_t> waiters_{0};
 
   std::mutex head_mtx_;
   std::mutex tail_mtx_;
+  std::mutex free_mtx_;
+  std::condition_variable not_empty_;
 };
 
+template <typename T>
+void FGQueue<T>::push(value_type item) {
+  // grab the next dummy before locking so other pushers can keep working
+  Node* const new_tail = acquire_node();
+  {
+    std::lock_guard tail_lock(tail_mtx_);
+    try {
+      tail_->value.emplace(std::move(item));
+    } catch (...) {
+      release_node(new_tail);
+      throw;
+    }
+    tail_->next = new_tail;
+    tail_ = new_tail;
+  }
+  // A waiter bumps waiters_ before it reads the tail under tail_mtx_, so
+  // either it saw the node linked above or the load below sees it waiting.
+  // Notifying under head_mtx_ makes sure it is actually asleep by then.
+  if (waiters_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard head_lock(head_mtx_);
+    not_empty_.notify_one();
+  }
+}
+
+template <typename T>
+std::optional<T> FGQueue<T>::try_pop() {
+  std::optional<value_type> value;
+  Node* old_head;
+  {
+    std::lock_guard head_lock(head_mtx_);
+    if (head_ == get_tail()) {
+      return std::nullopt;
+    }
+    old_head = unsafe_pop_head(value);
+  }
+  release_node(old_head);
+  return value;
+}
+
+template <typename T>
+T FGQueue<T>::wait_and_pop() {
+  std::optional<value_type> value;
+  Node* old_head;
+  {
+    std::unique_lock head_lock(head_mtx_);
+    if (head_ == get_tail()) {
+      waiters_.fetch_add(1, std::memory_order_relaxed);
+      not_empty_.wait(head_lock, [this] { return head_ != get_tail(); });
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    old_head = unsafe_pop_head(value);
+  }
+  release_node(old_head);
+  return std::move(*value);
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+std::optional<T> FGQueue<T>::wait_for_pop(
+    const std::chrono::duration<Rep, Period>& timeout) {
+  std::optional<value_type> value;
+  Node* old_head;
+  {
+    std::unique_lock head_lock(head_mtx_);
+    if (head_ == get_tail()) {
+      waiters_.fetch_add(1, std::memory_order_relaxed);
+      bool ready = not_empty_.wait_for(head_lock, timeout,
+                                       [this] { return head_ != get_tail(); });
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      if (!ready) {
+        return std::nullopt;
+      }
+    }
+    old_head = unsafe_pop_head(value);
+  }
+  release_node(old_head);
+  return value;
+}
+
 #endif  // FGQUEUE_H_
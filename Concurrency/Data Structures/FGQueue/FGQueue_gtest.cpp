@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -11,13 +14,13 @@ TEST(FGQueue, PushPop) {
   FGQueue<int> q;
   q.push(42);
   auto val = q.try_pop();
-  ASSERT_NE(val, nullptr);
+  ASSERT_TRUE(val.has_value());
   EXPECT_EQ(*val, 42);
 }
 
 TEST(FGQueue, PopEmpty) {
   FGQueue<int> q;
-  EXPECT_EQ(q.try_pop(), nullptr);
+  EXPECT_FALSE(q.try_pop().has_value());
 }
 
 TEST(FGQueue, FIFO) {
@@ -30,14 +33,14 @@ TEST(FGQueue, FIFO) {
   auto v2 = q.try_pop();
   auto v3 = q.try_pop();
 
-  ASSERT_NE(v1, nullptr);
-  ASSERT_NE(v2, nullptr);
-  ASSERT_NE(v3, nullptr);
+  ASSERT_TRUE(v1.has_value());
+  ASSERT_TRUE(v2.has_value());
+  ASSERT_TRUE(v3.has_value());
 
   EXPECT_EQ(*v1, 1);
   EXPECT_EQ(*v2, 2);
   EXPECT_EQ(*v3, 3);
-  EXPECT_EQ(q.try_pop(), nullptr);
+  EXPECT_FALSE(q.try_pop().has_value());
 }
 
 TEST(FGQueue, MultiplePushPop) {
@@ -49,11 +52,11 @@ TEST(FGQueue, MultiplePushPop) {
 
   for (int i = 0; i < 100; ++i) {
     auto val = q.try_pop();
-    ASSERT_NE(val, nullptr);
+    ASSERT_TRUE(val.has_value());
     EXPECT_EQ(*val, i);
   }
 
-  EXPECT_EQ(q.try_pop(), nullptr);
+  EXPECT_FALSE(q.try_pop().has_value());
 }
 
 // Concurrent tests
@@ -77,7 +80,7 @@ TEST(FGQueue, ConcurrentPush) {
 
   // Count total items
   int count = 0;
-  while (q.try_pop() != nullptr) {
+  while (q.try_pop().has_value()) {
     count++;
   }
   EXPECT_EQ(count, num_threads * pushes_per_thread);
@@ -118,7 +121,7 @@ TEST(FGQueue, ConcurrentPushPop) {
 
   EXPECT_EQ(push_count, 2 * operations);
   EXPECT_EQ(pop_count, 2 * operations);
-  EXPECT_EQ(q.try_pop(), nullptr);
+  EXPECT_FALSE(q.try_pop().has_value());
 }
 
 TEST(FGQueue, ProducerConsumer) {
@@ -137,7 +140,7 @@ TEST(FGQueue, ProducerConsumer) {
 
   // Consumer
   std::thread consumer([&q, &done, &total]() {
-    while (!done || q.try_pop() != nullptr) {
+    while (!done || q.try_pop().has_value()) {
       auto val = q.try_pop();
       if (val) {
         total += *val;
@@ -196,6 +199,132 @@ TEST(FGQueue, StressTest) {
   EXPECT_EQ(consumed, num_producers * items_per_producer);
 }
 
+// Blocking pops
+TEST(FGQueue, WaitAndPopReturnsQueuedValue) {
+  FGQueue<int> q;
+  q.push(7);
+  EXPECT_EQ(q.wait_and_pop(), 7);
+}
+
+TEST(FGQueue, WaitAndPopBlocksUntilPush) {
+  FGQueue<int> q;
+  std::atomic<bool> popped{false};
+  int value = 0;
+
+  std::thread consumer([&]() {
+    value = q.wait_and_pop();
+    popped = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(popped);
+  q.push(99);
+  consumer.join();
+
+  EXPECT_TRUE(popped);
+  EXPECT_EQ(value, 99);
+}
+
+TEST(FGQueue, WaitForPopTimesOut) {
+  FGQueue<int> q;
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(q.wait_for_pop(std::chrono::milliseconds(20)).has_value());
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(20));
+}
+
+TEST(FGQueue, WaitForPopWakesOnPush) {
+  FGQueue<int> q;
+  std::optional<int> value;
+
+  std::thread consumer(
+      [&]() { value = q.wait_for_pop(std::chrono::seconds(10)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  q.push(5);
+  consumer.join();
+
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(*value, 5);
+}
+
+TEST(FGQueue, ManyWaitersAllWoken) {
+  FGQueue<int> q;
+  const int num_consumers = 4;
+  const int items_per_consumer = 500;
+  std::atomic<long> total{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_consumers; ++i) {
+    threads.emplace_back([&q, &total, items_per_consumer]() {
+      for (int j = 0; j < items_per_consumer; ++j) {
+        total += q.wait_and_pop();
+      }
+    });
+  }
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([&q, num_consumers, items_per_consumer]() {
+      for (int j = 1; j <= num_consumers * items_per_consumer / 2; ++j) {
+        q.push(j);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  const long per_producer = num_consumers * items_per_consumer / 2;
+  EXPECT_EQ(total, 2 * per_producer * (per_producer + 1) / 2);
+  EXPECT_FALSE(q.try_pop().has_value());
+}
+
+// Values live in the nodes, so move-only types work
+TEST(FGQueue, MoveOnlyValues) {
+  FGQueue<std::unique_ptr<std::string>> q;
+  q.push(std::make_unique<std::string>("first"));
+  q.push(std::make_unique<std::string>("second"));
+
+  auto first = q.try_pop();
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(**first, "first");
+  EXPECT_EQ(*q.wait_and_pop(), "second");
+}
+
+// Nodes cycle through the freelist, including with a tiny bound
+TEST(FGQueue, RecyclesNodes) {
+  for (size_t max_free : {size_t{0}, size_t{1}, size_t{64}}) {
+    FGQueue<std::string> q(max_free);
+    for (int round = 0; round < 10; ++round) {
+      for (int i = 0; i < 100; ++i) {
+        q.push(std::to_string(i));
+      }
+      for (int i = 0; i < 100; ++i) {
+        auto val = q.try_pop();
+        ASSERT_TRUE(val.has_value());
+        EXPECT_EQ(*val, std::to_string(i));
+      }
+    }
+    EXPECT_FALSE(q.try_pop().has_value());
+  }
+}
+
+TEST(FGQueue, MoveConstructKeepsElements) {
+  FGQueue<int> q;
+  q.push(1);
+  q.push(2);
+  q.try_pop();
+
+  FGQueue<int> moved(std::move(q));
+  EXPECT_EQ(moved.try_pop(), 2);
+  EXPECT_FALSE(moved.try_pop().has_value());
+
+  FGQueue<int> assigned;
+  assigned.push(3);
+  assigned = std::move(moved);
+  EXPECT_FALSE(assigned.try_pop().has_value());
+  assigned.push(4);
+  EXPECT_EQ(assigned.wait_and_pop(), 4);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,65 @@
+#ifndef FCSTACK_H_
+#define FCSTACK_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "../CGStack/CGStack.h"
+#include "FlatCombining.h"
+
+/**
+ * CGStack behind flat combining. Only the combiner ever calls into the
+ * stack, so its mutex is always taken uncontended and the handoff between
+ * cores that dominates a contended CGStack goes away.
+ *
+ * wait_and_pop() and wait_and_peek() are not offered, an operation must not
+ * wait on another one inside a combining pass.
+ */
+template <typename T>
+class FCStack {
+ public:
+  /**
+   * ARGS:
+   * num_slots: see FlatCombining
+   */
+  explicit FCStack(
+      size_t num_slots = FlatCombining<CGStack<T>>::DEFAULT_SLOTS)
+      : stack_(num_slots) {}
+
+  /**
+   * adds an item to the stack
+   *
+   * ARGS:
+   * item: element to be added to the top of the stack of type T
+   */
+  void push(T item) {
+    stack_.apply([&item](CGStack<T>& stack) { stack.push(std::move(item)); });
+  }
+
+  /**
+   * removes the element from the top of the stack and returns it
+   *
+   * RETURNS:
+   * unique_ptr with the element that was at the top of the stack, nullptr if
+   * the stack was empty
+   */
+  std::unique_ptr<T> pop() {
+    return stack_.apply([](CGStack<T>& stack) { return stack.pop(); });
+  }
+
+  /**
+   * Looks at the top of the stack and returns what is there
+   *
+   * RETURNS:
+   * shared_ptr with a copy of the top element, nullptr if the stack is empty
+   */
+  std::shared_ptr<T> peek() {
+    return stack_.apply([](CGStack<T>& stack) { return stack.peek(); });
+  }
+
+ private:
+  FlatCombining<CGStack<T>> stack_;
+};
+
+#endif  // FCSTACK_H_
@@ -0,0 +1,243 @@
+#ifndef FLAT_COMBINING_H_
+#define FLAT_COMBINING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Flat combining (Hendler, Incze, Shavit, Tzafrir) around a sequential
+ * Container.
+ *
+ * Instead of every thread fighting over the container's lock, a thread
+ * publishes its operation in a slot and spins on that slot. Whichever thread
+ * grabs the combiner lock walks all the slots and applies every pending
+ * operation in one batch, so the container and the lock stay in one core's
+ * cache while the other threads only ever touch their own slot.
+ *
+ * Operations are callables taking Container& and returning by value (or
+ * void). Exceptions thrown by an operation are handed back to the thread that
+ * published it. A container gets a named API with a small adapter that
+ * forwards each method through apply(), see FCStack.h.
+ *
+ * Operations must not block waiting on another operation (e.g. a
+ * wait_and_pop), the thread that would satisfy it is spinning on its own
+ * slot until the combiner is done.
+ */
+template <typename Container>
+class FlatCombining {
+ public:
+  static constexpr size_t DEFAULT_SLOTS = 64;
+
+  /**
+   * ARGS:
+   * num_slots: number of publication slots, keep it at least the number of
+   *            threads using the structure at once, extra threads wait for
+   *            a free slot
+   * args: forwarded to the Container constructor
+   *
+   * THROWS:
+   * std::invalid_argument if num_slots is 0
+   */
+  template <typename... Args>
+  explicit FlatCombining(size_t num_slots = DEFAULT_SLOTS, Args&&... args)
+      : container_(std::forward<Args>(args)...),
+        num_slots_(num_slots),
+        slots_(make_slots(num_slots)) {}
+
+  FlatCombining(const FlatCombining&) = delete;
+  FlatCombining& operator=(const FlatCombining&) = delete;
+
+  /**
+   * Runs op(container) as part of some thread's combining pass
+   *
+   * ARGS:
+   * op: callable taking Container&, it runs on whichever thread is combining
+   *     but strictly before apply() returns
+   *
+   * RETURNS:
+   * whatever op returned
+   *
+   * THROWS:
+   * whatever op threw
+   */
+  template <typename F>
+  std::invoke_result_t<F&, Container&> apply(F&& op);
+
+ private:
+  enum : uint32_t { FREE, CLAIMED, PENDING, DONE };
+
+  struct alignas(std::hardware_constructive_interference_size) Slot {
+    std::atomic<uint32_t> state{FREE};
+    // written by the owner before PENDING, read by the combiner
+    void (*run)(Container&, void*) = nullptr;
+    void* call = nullptr;
+    // written by the combiner before DONE, read by the owner
+    std::exception_ptr error;
+  };
+
+  // lives on the publishing thread's stack for the duration of apply()
+  template <typename F, typename R>
+  struct Call {
+    F* op;
+    std::optional<std::conditional_t<std::is_void_v<R>, char, R>> result;
+
+    static void run(Container& container, void* self) {
+      auto* call = static_cast<Call*>(self);
+      if constexpr (std::is_void_v<R>) {
+        (*call->op)(container);
+      } else {
+        call->result.emplace((*call->op)(container));
+      }
+    }
+  };
+
+  static std::unique_ptr<Slot[]> make_slots(size_t num_slots) {
+    if (num_slots == 0) {
+      throw std::invalid_argument("FlatCombining needs at least one slot");
+    }
+    return std::unique_ptr<Slot[]>(new Slot[num_slots]);
+  }
+
+  /**
+   * Helper function that claims a free slot, starting at the calling
+   * thread's home slot so a thread usually gets the same one every time
+   */
+  Slot& claim_slot();
+
+  /**
+   * Helper function that applies every pending operation. IMPORTANT: the
+   * caller must hold combining_
+   */
+  void combine();
+
+  static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+  }
+
+  // spin a little, then give the core away so a preempted combiner can run
+  static void backoff(size_t spins) {
+    if (spins < SPINS_BEFORE_YIELD) {
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  static size_t thread_index() {
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index =
+        next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  // a combiner keeps rescanning while other threads keep publishing, up to
+  // this many passes
+  static constexpr size_t COMBINE_PASSES = 3;
+  static constexpr size_t SPINS_BEFORE_YIELD = 128;
+
+  Container container_;
+  const size_t num_slots_;
+  std::unique_ptr<Slot[]> slots_;
+  // one past the highest slot ever claimed, combiners scan [0, scan_bound_)
+  std::atomic<size_t> scan_bound_{0};
+  alignas(std::hardware_constructive_interference_size)
+      std::atomic<bool> combining_{false};
+};
+
+template <typename Container>
+template <typename F>
+std::invoke_result_t<F&, Container&> FlatCombining<Container>::apply(F&& op) {
+  using Result = std::invoke_result_t<F&, Container&>;
+  using OpType = std::remove_reference_t<F>;
+  Call<OpType, Result> call{&op, std::nullopt};
+
+  Slot& slot = claim_slot();
+  slot.run = &Call<OpType, Result>::run;
+  slot.call = &call;
+  slot.state.store(PENDING, std::memory_order_release);
+
+  for (size_t spins = 0; slot.state.load(std::memory_order_acquire) != DONE;
+       ++spins) {
+    if (!combining_.load(std::memory_order_relaxed) &&
+        !combining_.exchange(true, std::memory_order_acquire)) {
+      // our slot was pending before we took the lock, so this pass serves it
+      combine();
+      combining_.store(false, std::memory_order_release);
+      continue;
+    }
+    backoff(spins);
+  }
+
+  std::exception_ptr error = std::move(slot.error);
+  slot.error = nullptr;
+  slot.state.store(FREE, std::memory_order_release);
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if constexpr (!std::is_void_v<Result>) {
+    return std::move(*call.result);
+  }
+}
+
+template <typename Container>
+typename FlatCombining<Container>::Slot&
+FlatCombining<Container>::claim_slot() {
+  size_t idx = thread_index() % num_slots_;
+  for (size_t spins = 0;; ++spins) {
+    Slot& slot = slots_[idx];
+    uint32_t expected = FREE;
+    if (slot.state.load(std::memory_order_relaxed) == FREE &&
+        slot.state.compare_exchange_strong(expected, CLAIMED,
+                                           std::memory_order_acquire)) {
+      // a combiner that reads a stale bound only delays this slot, the owner
+      // keeps trying to combine for itself
+      size_t bound = scan_bound_.load(std::memory_order_relaxed);
+      while (idx >= bound && !scan_bound_.compare_exchange_weak(
+                                 bound, idx + 1, std::memory_order_relaxed)) {
+      }
+      return slot;
+    }
+    idx = idx + 1 == num_slots_ ? 0 : idx + 1;
+    backoff(spins / num_slots_);
+  }
+}
+
+template <typename Container>
+void FlatCombining<Container>::combine() {
+  for (size_t pass = 0; pass < COMBINE_PASSES; ++pass) {
+    size_t served = 0;
+    size_t bound = scan_bound_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < bound; ++i) {
+      Slot& slot = slots_[i];
+      if (slot.state.load(std::memory_order_acquire) != PENDING) {
+        continue;
+      }
+      try {
+        slot.run(container_, slot.call);
+      } catch (...) {
+        slot.error = std::current_exception();
+      }
+      slot.state.store(DONE, std::memory_order_release);
+      ++served;
+    }
+    // a pass that only found our own operation means nobody else is active
+    if (served <= 1) {
+      break;
+    }
+  }
+}
+
+#endif  // FLAT_COMBINING_H_
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "FCStack.h"
+
+// Flat combining against the plain mutex CGStack. Every thread alternates
+// push and pop on one shared stack, so the mutex version hands its lock
+// between cores on nearly every operation. StdVector is the same workload on
+// a std::vector that needs no lock of its own at all.
+
+class StdVectorStack {
+ public:
+  void push(int value) {
+    stack_.apply([value](std::vector<int>& v) { v.push_back(value); });
+  }
+
+  bool pop() {
+    return stack_.apply([](std::vector<int>& v) {
+      if (v.empty()) {
+        return false;
+      }
+      v.pop_back();
+      return true;
+    });
+  }
+
+ private:
+  FlatCombining<std::vector<int>> stack_;
+};
+
+template <typename Stack>
+static void BM_PushPop(benchmark::State& state) {
+  static Stack* stack = nullptr;
+  if (state.thread_index() == 0) {
+    stack = new Stack();
+  }
+  int value = state.thread_index();
+  for (auto _ : state) {
+    stack->push(value);
+    benchmark::DoNotOptimize(stack->pop());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+  if (state.thread_index() == 0) {
+    delete stack;
+    stack = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_PushPop, CGStack<int>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, FCStack<int>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, StdVectorStack)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
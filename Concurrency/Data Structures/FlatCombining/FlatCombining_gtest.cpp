@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "FCStack.h"
+#include "FlatCombining.h"
+
+// FCStack basic operations
+TEST(FCStack, PushPop) {
+  FCStack<int> s;
+  s.push(42);
+  auto val = s.pop();
+  ASSERT_NE(val, nullptr);
+  EXPECT_EQ(*val, 42);
+}
+
+TEST(FCStack, PopEmpty) {
+  FCStack<int> s;
+  EXPECT_EQ(s.pop(), nullptr);
+  EXPECT_EQ(s.peek(), nullptr);
+}
+
+TEST(FCStack, LIFO) {
+  FCStack<int> s;
+  s.push(1);
+  s.push(2);
+  s.push(3);
+  EXPECT_EQ(*s.peek(), 3);
+  EXPECT_EQ(*s.pop(), 3);
+  EXPECT_EQ(*s.pop(), 2);
+  EXPECT_EQ(*s.pop(), 1);
+  EXPECT_EQ(s.pop(), nullptr);
+}
+
+TEST(FCStack, ConcurrentPushPop) {
+  FCStack<int> s;
+  const int num_threads = 4;
+  const int ops_per_thread = 2000;
+  std::atomic<long> pushed_sum{0};
+  std::atomic<long> popped_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < ops_per_thread; ++j) {
+        int value = i * ops_per_thread + j;
+        s.push(value);
+        pushed_sum += value;
+        if (auto val = s.pop()) {
+          popped_sum += *val;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  while (auto val = s.pop()) {
+    popped_sum += *val;
+  }
+  EXPECT_EQ(pushed_sum, popped_sum);
+}
+
+// Generic wrapper
+TEST(FlatCombining, SerializesPlainCounter) {
+  FlatCombining<long> counter;
+  const int num_threads = 4;
+  const int increments = 5000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&counter, increments]() {
+      for (int j = 0; j < increments; ++j) {
+        counter.apply([](long& c) { ++c; });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(counter.apply([](long& c) { return c; }),
+            num_threads * increments);
+}
+
+TEST(FlatCombining, WrapsStandardContainer) {
+  FlatCombining<std::deque<int>> queue(8, 3, 7);
+  EXPECT_EQ(queue.apply([](std::deque<int>& q) { return q.size(); }), 3u);
+  queue.apply([](std::deque<int>& q) { q.push_back(9); });
+  int front = queue.apply([](std::deque<int>& q) {
+    int value = q.front();
+    q.pop_front();
+    return value;
+  });
+  EXPECT_EQ(front, 7);
+}
+
+TEST(FlatCombining, MoreThreadsThanSlots) {
+  FlatCombining<std::vector<int>> vec(2);
+  const int num_threads = 6;
+  const int pushes = 500;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&vec, i, pushes]() {
+      for (int j = 0; j < pushes; ++j) {
+        vec.apply([i](std::vector<int>& v) { v.push_back(i); });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(vec.apply([](std::vector<int>& v) { return v.size(); }),
+            static_cast<size_t>(num_threads * pushes));
+}
+
+TEST(FlatCombining, ExceptionReachesCaller) {
+  FlatCombining<std::vector<int>> vec;
+  EXPECT_THROW(vec.apply([](std::vector<int>& v) { return v.at(3); }),
+               std::out_of_range);
+  // the slot and the combiner lock were both released
+  vec.apply([](std::vector<int>& v) { v.push_back(1); });
+  EXPECT_EQ(vec.apply([](std::vector<int>& v) { return v.at(0); }), 1);
+}
+
+TEST(FlatCombining, ZeroSlotsThrows) {
+  EXPECT_THROW(FlatCombining<long>(0), std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
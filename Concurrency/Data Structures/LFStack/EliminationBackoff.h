@@ -0,0 +1,122 @@
+#ifndef ELIMINATION_BACKOFF_H_
+#define ELIMINATION_BACKOFF_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Backoff policies for LFStack. A policy provides a nested
+// Array<Node> with
+//   bool try_give(Node*)  push side, true if a pop took the node
+//   Node* try_take()      pop side, a node handed over by a push or nullptr
+// LFStack only calls into the array after losing a CAS on head_.
+
+/**
+ * Plain Treiber stack behaviour, a lost CAS is simply retried
+ */
+struct NoElimination {
+  template <typename Node>
+  struct Array {
+    bool try_give(Node*) { return false; }
+    Node* try_take() { return nullptr; }
+  };
+};
+
+/**
+ * Elimination backoff (Hendler, Shavit, Yerushalmi). A push and a pop that
+ * both lost the race on head_ cancel out: the pusher parks its node in a
+ * random slot for up to SpinLimit iterations and a popper that finds it
+ * there takes it directly, so neither of them touches head_ again.
+ *
+ * Each slot is either empty, holds a node on offer, or holds TAKEN while the
+ * owning pusher notices its node is gone. A node on offer was never linked
+ * into the stack, so once a popper wins the slot CAS it is the only thread
+ * that can see the node and no hazard pointer is needed.
+ *
+ * ARGS:
+ * Width: number of exchange slots, keep it around the number of threads
+ *        that collide on head_ at once
+ * SpinLimit: how long a pusher waits for a partner before going back to the
+ *            stack
+ */
+template <size_t Width = 8, size_t SpinLimit = 512>
+struct EliminationBackoff {
+  static_assert(Width > 0, "EliminationBackoff needs at least one slot");
+
+  template <typename Node>
+  class Array {
+   public:
+    bool try_give(Node* node) {
+      Slot& slot = slots_[next_index()];
+      Node* expected = nullptr;
+      if (!slot.value.compare_exchange_strong(expected, node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        return false;
+      }
+      for (size_t spin = 0; spin < SpinLimit; ++spin) {
+        if (slot.value.load(std::memory_order_acquire) == taken()) {
+          slot.value.store(nullptr, std::memory_order_release);
+          return true;
+        }
+        cpu_relax();
+      }
+      expected = node;
+      if (slot.value.compare_exchange_strong(expected, nullptr,
+                                             std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+        return false;
+      }
+      // a popper took it between the last check and the withdrawal
+      slot.value.store(nullptr, std::memory_order_release);
+      return true;
+    }
+
+    Node* try_take() {
+      Slot& slot = slots_[next_index()];
+      for (size_t spin = 0; spin < SpinLimit / 4; ++spin) {
+        Node* node = slot.value.load(std::memory_order_acquire);
+        if (node != nullptr && node != taken() &&
+            slot.value.compare_exchange_strong(node, taken(),
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+          return node;
+        }
+        cpu_relax();
+      }
+      return nullptr;
+    }
+
+   private:
+    struct alignas(std::hardware_constructive_interference_size) Slot {
+      std::atomic<Node*> value{nullptr};
+    };
+
+    static Node* taken() {
+      return reinterpret_cast<Node*>(static_cast<uintptr_t>(1));
+    }
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__)
+      asm volatile("yield");
+#endif
+    }
+
+    // xorshift, per thread so picking a slot never touches shared state
+    static size_t next_index() {
+      thread_local uint32_t state =
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state)) | 1u;
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state % Width;
+    }
+
+    Slot slots_[Width];
+  };
+};
+
+#endif  // ELIMINATION_BACKOFF_H_
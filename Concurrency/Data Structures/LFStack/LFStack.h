@@ -2,16 +2,38 @@
 #define LFSTACK_H_
 
 #include <atomic>
-#include <memory>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <utility>
 
+#include "../utils/EpochReclaimer/EpochReclaimer.h"
 #include "../utils/HazardPointer/HazardPointer.h"
+#include "../utils/NodePool/NodePool.h"
+#include "EliminationBackoff.h"
 
-template <typename T>
+// Treiber stack with pluggable memory reclamation.
+//
+// Backoff selects what happens after losing the CAS on head_, see
+// EliminationBackoff.h. NoElimination retries straight away,
+// EliminationBackoff<> lets colliding pushes and pops pair off.
+//
+// Reclaim selects how popped nodes are freed, see the policy interface in
+// HazardPointer.h. HazardPointerReclamation publishes and re-validates head_
+// on every pop attempt, EpochReclamation pins an epoch once per pop and reads
+// head_ with plain loads.
+template <typename T, typename Backoff = NoElimination,
+          typename Reclaim = HazardPointerReclamation>
 class LFStack {
   using type_name = T;
 
+ private:
+  struct Node;
+
  public:
-  LFStack() : hp_(8) {}
+  class Batch;
+
+  LFStack() : reclaim_(8) {}
 
   LFStack(const LFStack& other) = delete;
   LFStack(LFStack&& other) = delete;
@@ -22,23 +44,136 @@ class LFStack {
 
   void push(type_name item);
 
-  std::shared_ptr<T> pop();
+  std::optional<T> pop();
+
+  /**
+   * Pushes every element of [first, last) with a single CAS on head_. The
+   * nodes are linked privately first, so the result is the same as pushing
+   * the elements one by one in order (last ends up on top), except that no
+   * concurrent pop can observe a partial range.
+   */
+  template <typename InputIt>
+  void push_range(InputIt first, InputIt last);
+
+  /**
+   * Detaches the whole stack with one exchange and hands it back as an
+   * owning range, iterated from the top. Concurrent push/pop keep working on
+   * the now empty stack.
+   *
+   * REQUIRES:
+   * the returned Batch is destroyed before this stack
+   */
+  Batch pop_all();
 
   bool empty() const { return head_.load() == nullptr; }
 
+  /**
+   * Owning range returned by pop_all. Elements may be moved out while
+   * iterating. On destruction the nodes are retired through the stack's
+   * reclamation domain rather than freed, since a pop that read head_ just
+   * before the exchange may still be looking at the first node.
+   */
+  class Batch {
+   public:
+    class iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = T*;
+      using reference = T&;
+
+      iterator() = default;
+      explicit iterator(Node* node) : node_(node) {}
+
+      T& operator*() const { return node_->data; }
+      T* operator->() const { return &node_->data; }
+
+      iterator& operator++() {
+        node_ = node_->next;
+        return *this;
+      }
+
+      iterator operator++(int) {
+        iterator temp = *this;
+        node_ = node_->next;
+        return temp;
+      }
+
+      bool operator==(const iterator& other) const {
+        return node_ == other.node_;
+      }
+      bool operator!=(const iterator& other) const {
+        return node_ != other.node_;
+      }
+
+     private:
+      Node* node_ = nullptr;
+    };
+
+    Batch(const Batch& other) = delete;
+    Batch& operator=(const Batch& other) = delete;
+
+    Batch(Batch&& other) noexcept
+        : owner_(other.owner_), head_(std::exchange(other.head_, nullptr)) {}
+
+    Batch& operator=(Batch&& other) noexcept {
+      if (this != &other) {
+        release();
+        owner_ = other.owner_;
+        head_ = std::exchange(other.head_, nullptr);
+      }
+      return *this;
+    }
+
+    ~Batch() { release(); }
+
+    iterator begin() const { return iterator(head_); }
+    iterator end() const { return iterator(); }
+    bool empty() const { return head_ == nullptr; }
+
+   private:
+    friend class LFStack;
+
+    Batch(LFStack* owner, Node* head) : owner_(owner), head_(head) {}
+
+    void release() {
+      Node* curr = head_;
+      while (curr != nullptr) {
+        Node* next = curr->next;
+        owner_->reclaim_.retire(curr);
+        curr = next;
+      }
+      head_ = nullptr;
+    }
+
+    LFStack* owner_;
+    Node* head_;
+  };
+
  private:
+  // The value lives inside the node and the node itself comes from a
+  // NodePool, so a push/pop pair costs no trips to the allocator once the
+  // pool is warm. Nodes still go through reclaim_.retire before they are
+  // recycled, which is what keeps a recycled node from causing ABA on head_.
   struct Node {
-    std::shared_ptr<T> data;
+    T data;
     Node* next{nullptr};
-    explicit Node(T data) : data(std::make_shared<T>(std::move(data))) {}
+    explicit Node(T data) : data(std::move(data)) {}
+
+    static void* operator new(std::size_t) {
+      return NodePool<Node>::allocate();
+    }
+    static void operator delete(void* ptr) { NodePool<Node>::deallocate(ptr); }
   };
 
   std::atomic<Node*> head_{nullptr};
-  HazardPointer<Node> hp_;
+  typename Reclaim::template Domain<Node> reclaim_;
+  typename Backoff::template Array<Node> elimination_;
 };
 
-template <typename T>
-LFStack<T>::~LFStack() {
+template <typename T, typename Backoff, typename Reclaim>
+LFStack<T, Backoff, Reclaim>::~LFStack() {
   Node* curr = head_.load();
   while (curr != nullptr) {
     Node* temp = curr->next;
@@ -47,43 +182,88 @@ LFStack<T>::~LFStack() {
   }
 }
 
-template <typename T>
-void LFStack<T>::push(type_name item) {
+template <typename T, typename Backoff, typename Reclaim>
+void LFStack<T, Backoff, Reclaim>::push(type_name item) {
   Node* new_node = new Node(std::move(item));
   new_node->next = head_.load(std::memory_order_relaxed);
   while (!head_.compare_exchange_weak(new_node->next, new_node,
                                       std::memory_order_release,
                                       std::memory_order_relaxed)) {
+    if (elimination_.try_give(new_node)) {
+      return;
+    }
   }
 }
 
-template <typename T>
-std::shared_ptr<T> LFStack<T>::pop() {
-  while (true) {
-    Node* node_to_remove = head_.load(std::memory_order_acquire);
-
-    if (node_to_remove == nullptr) {
-      return nullptr;
+template <typename T, typename Backoff, typename Reclaim>
+template <typename InputIt>
+void LFStack<T, Backoff, Reclaim>::push_range(InputIt first, InputIt last) {
+  if (first == last) {
+    return;
+  }
+  Node* bottom = nullptr;
+  Node* top = nullptr;
+  try {
+    for (; first != last; ++first) {
+      Node* node = new Node(*first);
+      node->next = top;
+      top = node;
+      if (bottom == nullptr) {
+        bottom = node;
+      }
+    }
+  } catch (...) {
+    while (top != nullptr) {
+      Node* next = top->next;
+      delete top;
+      top = next;
     }
+    throw;
+  }
+
+  bottom->next = head_.load(std::memory_order_relaxed);
+  while (!head_.compare_exchange_weak(bottom->next, top,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+  }
+}
 
-    hp_.protect(node_to_remove);
+template <typename T, typename Backoff, typename Reclaim>
+typename LFStack<T, Backoff, Reclaim>::Batch
+LFStack<T, Backoff, Reclaim>::pop_all() {
+  return Batch(this, head_.exchange(nullptr, std::memory_order_acquire));
+}
 
-    // Verify head hasn't changed after protection
-    if (node_to_remove != head_.load(std::memory_order_acquire)) {
-      hp_.release();
-      continue;
+template <typename T, typename Backoff, typename Reclaim>
+std::optional<T> LFStack<T, Backoff, Reclaim>::pop() {
+  while (true) {
+    auto guard = reclaim_.guard();
+    Node* node_to_remove = guard.protect(head_);
+
+    if (node_to_remove == nullptr) {
+      return std::nullopt;
     }
 
     Node* next = node_to_remove->next;
     if (head_.compare_exchange_weak(node_to_remove, next,
                                     std::memory_order_release,
                                     std::memory_order_relaxed)) {
-      hp_.release();
-      std::shared_ptr<T> res = (node_to_remove->data);
-      hp_.retire(node_to_remove);
+      guard.reset();
+      // only the thread that won the CAS touches data, other threads that
+      // still protect this node only read next
+      std::optional<T> res(std::move(node_to_remove->data));
+      reclaim_.retire(node_to_remove);
+      return res;
+    }
+    guard.reset();
+
+    // the node came straight from a push that never linked it into the
+    // stack, so nobody else can reference it and it is freed directly
+    if (Node* eliminated = elimination_.try_take()) {
+      std::optional<T> res(std::move(eliminated->data));
+      delete eliminated;
       return res;
     }
-    hp_.release();
   }
 }
 
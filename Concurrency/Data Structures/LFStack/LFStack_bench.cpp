@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include "LFStack.h"
+
+// Scalability of the plain Treiber stack against the elimination backoff
+// variant, and of hazard pointer against epoch based reclamation. Every
+// thread alternates push and pop so pushes and pops collide on head_ as often
+// as possible.
+
+template <typename Stack>
+static void BM_PushPop(benchmark::State& state) {
+  static Stack* stack = nullptr;
+  if (state.thread_index() == 0) {
+    stack = new Stack();
+  }
+  int value = state.thread_index();
+  for (auto _ : state) {
+    stack->push(value);
+    benchmark::DoNotOptimize(stack->pop());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+  if (state.thread_index() == 0) {
+    // benchmark joins every thread's loop before thread 0 returns here
+    delete stack;
+    stack = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_PushPop, LFStack<int>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, LFStack<int, EliminationBackoff<>>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, LFStack<int, NoElimination, EpochReclamation>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <unordered_set>
 #include <vector>
@@ -14,7 +15,7 @@ TEST(LFStackTest, BasicPushPop) {
   stack.push(42);
   auto result = stack.pop();
 
-  ASSERT_NE(result, nullptr);
+  ASSERT_TRUE(result.has_value());
   EXPECT_EQ(*result, 42);
   EXPECT_TRUE(stack.empty());
 }
@@ -23,7 +24,7 @@ TEST(LFStackTest, EmptyPop) {
   LFStack<int> stack;
 
   auto result = stack.pop();
-  EXPECT_EQ(result, nullptr);
+  EXPECT_FALSE(result.has_value());
   EXPECT_TRUE(stack.empty());
 }
 
@@ -40,9 +41,9 @@ TEST(LFStackTest, LIFOOrder) {
   auto val2 = stack.pop();
   auto val3 = stack.pop();
 
-  ASSERT_NE(val1, nullptr);
-  ASSERT_NE(val2, nullptr);
-  ASSERT_NE(val3, nullptr);
+  ASSERT_TRUE(val1.has_value());
+  ASSERT_TRUE(val2.has_value());
+  ASSERT_TRUE(val3.has_value());
 
   EXPECT_EQ(*val1, 3);
   EXPECT_EQ(*val2, 2);
@@ -59,7 +60,7 @@ TEST(LFStackTest, MultiplePushPop) {
 
   for (int i = 99; i >= 0; --i) {
     auto val = stack.pop();
-    ASSERT_NE(val, nullptr);
+    ASSERT_TRUE(val.has_value());
     EXPECT_EQ(*val, i);
   }
 
@@ -188,7 +189,7 @@ TEST(LFStackTest, StressTestPushPop) {
         if (i % 2 == 0) {
           stack.push(static_cast<int>(t * ops_per_thread + i));
         } else {
-          stack.pop();  // May return nullptr
+          stack.pop();  // May return std::nullopt
         }
       }
     });
@@ -210,7 +211,7 @@ TEST(LFStackTest, StressTestPushPop) {
 
   // We pushed num_threads * ops_per_thread / 2 times
   // We attempted to pop num_threads * ops_per_thread / 2 times
-  // But some pops might have failed (returned nullptr)
+  // But some pops might have failed (returned std::nullopt)
   // So remaining should be >= 0
   EXPECT_GE(remaining, 0);
 }
@@ -258,9 +259,9 @@ TEST(LFStackTest, StringType) {
   auto val2 = stack.pop();
   auto val3 = stack.pop();
 
-  ASSERT_NE(val1, nullptr);
-  ASSERT_NE(val2, nullptr);
-  ASSERT_NE(val3, nullptr);
+  ASSERT_TRUE(val1.has_value());
+  ASSERT_TRUE(val2.has_value());
+  ASSERT_TRUE(val3.has_value());
 
   EXPECT_EQ(*val1, "test");
   EXPECT_EQ(*val2, "world");
@@ -278,11 +279,56 @@ TEST(LFStackTest, LargeDataType) {
   stack.push(LargeStruct{});
   auto result = stack.pop();
 
-  ASSERT_NE(result, nullptr);
+  ASSERT_TRUE(result.has_value());
   EXPECT_EQ(result->data[0], 42);
   EXPECT_EQ(result->data[999], 42);
 }
 
+TEST(LFStackTest, MoveOnlyType) {
+  LFStack<std::unique_ptr<int>> stack;
+
+  stack.push(std::make_unique<int>(1));
+  stack.push(std::make_unique<int>(2));
+
+  auto val1 = stack.pop();
+  auto val2 = stack.pop();
+  ASSERT_TRUE(val1.has_value());
+  ASSERT_TRUE(val2.has_value());
+  EXPECT_EQ(**val1, 2);
+  EXPECT_EQ(**val2, 1);
+  EXPECT_FALSE(stack.pop().has_value());
+}
+
+TEST(LFStackTest, ValueDestroyedOnce) {
+  auto counter = std::make_shared<int>(0);
+  {
+    LFStack<std::shared_ptr<int>> stack;
+    for (int i = 0; i < 50; ++i) {
+      stack.push(counter);
+    }
+    for (int i = 0; i < 25; ++i) {
+      auto val = stack.pop();
+      ASSERT_TRUE(val.has_value());
+    }
+    // popped copies are gone, the 25 left in the stack still hold a ref
+    EXPECT_EQ(counter.use_count(), 26);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(LFStackTest, SustainedPushPopReusesNodes) {
+  LFStack<int> stack;
+  const int rounds = 10000;
+
+  for (int i = 0; i < rounds; ++i) {
+    stack.push(i);
+    auto val = stack.pop();
+    ASSERT_TRUE(val.has_value());
+    ASSERT_EQ(*val, i);
+  }
+  EXPECT_TRUE(stack.empty());
+}
+
 TEST(LFStackTest, ABAProtectionScenario) {
   // Test the specific ABA scenario that hazard pointers prevent
   LFStack<int> stack;
@@ -336,6 +382,252 @@ TEST(LFStackTest, ABAProtectionScenario) {
   EXPECT_GT(successful_operations.load(), 0);
 }
 
+TEST(LFStackTest, PushRangeMatchesSequentialPush) {
+  LFStack<int> stack;
+  std::vector<int> items{1, 2, 3, 4};
+
+  stack.push(0);
+  stack.push_range(items.begin(), items.end());
+
+  for (int expected = 4; expected >= 0; --expected) {
+    auto val = stack.pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(*val, expected);
+  }
+  EXPECT_TRUE(stack.empty());
+}
+
+TEST(LFStackTest, PushRangeEmpty) {
+  LFStack<int> stack;
+  std::vector<int> items;
+  stack.push_range(items.begin(), items.end());
+  EXPECT_TRUE(stack.empty());
+}
+
+TEST(LFStackTest, PopAllReturnsTopFirst) {
+  LFStack<int> stack;
+  for (int i = 0; i < 5; ++i) {
+    stack.push(i);
+  }
+
+  auto batch = stack.pop_all();
+  EXPECT_TRUE(stack.empty());
+
+  std::vector<int> drained(batch.begin(), batch.end());
+  EXPECT_EQ(drained, (std::vector<int>{4, 3, 2, 1, 0}));
+  EXPECT_FALSE(stack.pop().has_value());
+}
+
+TEST(LFStackTest, PopAllEmpty) {
+  LFStack<int> stack;
+  auto batch = stack.pop_all();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(batch.begin(), batch.end());
+}
+
+TEST(LFStackTest, PopAllElementsCanBeMovedOut) {
+  LFStack<std::unique_ptr<int>> stack;
+  stack.push(std::make_unique<int>(1));
+  stack.push(std::make_unique<int>(2));
+
+  std::vector<std::unique_ptr<int>> out;
+  {
+    auto batch = stack.pop_all();
+    for (auto& item : batch) {
+      out.push_back(std::move(item));
+    }
+  }
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_EQ(*out[0], 2);
+  EXPECT_EQ(*out[1], 1);
+}
+
+TEST(LFStackTest, ConcurrentPushRangeAndPopAll) {
+  LFStack<int> stack;
+  const int num_producers = 4;
+  const int batches_per_producer = 200;
+  const int batch_size = 16;
+
+  std::atomic<int> producers_done{0};
+  std::atomic<long> pushed_sum{0};
+  std::atomic<long> drained_sum{0};
+  std::atomic<long> popped_sum{0};
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&, p]() {
+      std::vector<int> items(batch_size);
+      for (int b = 0; b < batches_per_producer; ++b) {
+        for (int i = 0; i < batch_size; ++i) {
+          items[i] = p * 100000 + b * batch_size + i;
+          pushed_sum.fetch_add(items[i], std::memory_order_relaxed);
+        }
+        stack.push_range(items.begin(), items.end());
+      }
+      producers_done.fetch_add(1);
+    });
+  }
+  // one thread drains in bulk while another pops one at a time
+  threads.emplace_back([&]() {
+    while (producers_done.load() < num_producers || !stack.empty()) {
+      auto batch = stack.pop_all();
+      for (int value : batch) {
+        drained_sum.fetch_add(value, std::memory_order_relaxed);
+      }
+    }
+  });
+  threads.emplace_back([&]() {
+    while (producers_done.load() < num_producers || !stack.empty()) {
+      if (auto val = stack.pop()) {
+        popped_sum.fetch_add(*val, std::memory_order_relaxed);
+      }
+    }
+  });
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(stack.empty());
+  EXPECT_EQ(pushed_sum.load(), drained_sum.load() + popped_sum.load());
+}
+
+using EliminationStack = LFStack<int, EliminationBackoff<4, 256>>;
+
+TEST(LFStackEliminationTest, LIFOOrder) {
+  EliminationStack stack;
+
+  stack.push(1);
+  stack.push(2);
+  stack.push(3);
+
+  EXPECT_EQ(*stack.pop(), 3);
+  EXPECT_EQ(*stack.pop(), 2);
+  EXPECT_EQ(*stack.pop(), 1);
+  EXPECT_FALSE(stack.pop().has_value());
+  EXPECT_TRUE(stack.empty());
+}
+
+TEST(LFStackEliminationTest, ArrayHandsNodeAcross) {
+  struct TestNode {
+    int value;
+  };
+  EliminationBackoff<1, 1 << 20>::Array<TestNode> array;
+  TestNode node{7};
+
+  std::atomic<bool> given{false};
+  std::atomic<bool> done{false};
+  std::thread pusher([&]() {
+    given = array.try_give(&node);
+    done = true;
+  });
+
+  TestNode* taken = nullptr;
+  while (taken == nullptr && !done.load()) {
+    taken = array.try_take();
+  }
+  pusher.join();
+
+  ASSERT_EQ(taken, &node);
+  EXPECT_TRUE(given.load());
+  EXPECT_EQ(taken->value, 7);
+  // the slot is free again once the pusher has seen the handoff
+  EXPECT_EQ(array.try_take(), nullptr);
+}
+
+TEST(LFStackEliminationTest, ArrayWithdrawsUnclaimedOffer) {
+  struct TestNode {
+    int value;
+  };
+  EliminationBackoff<1, 16>::Array<TestNode> array;
+  TestNode node{1};
+
+  EXPECT_FALSE(array.try_give(&node));
+  EXPECT_EQ(array.try_take(), nullptr);
+}
+
+TEST(LFStackEliminationTest, ConcurrentPushPopConservesItems) {
+  EliminationStack stack;
+  const size_t num_threads = 8;
+  const size_t ops_per_thread = 2000;
+
+  std::atomic<long> pushed_sum{0};
+  std::atomic<long> popped_sum{0};
+  std::atomic<bool> start{false};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      while (!start.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (size_t i = 0; i < ops_per_thread; ++i) {
+        int value = static_cast<int>(t * ops_per_thread + i);
+        stack.push(value);
+        pushed_sum.fetch_add(value, std::memory_order_relaxed);
+        if (auto val = stack.pop()) {
+          popped_sum.fetch_add(*val, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  start.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  while (auto val = stack.pop()) {
+    popped_sum.fetch_add(*val, std::memory_order_relaxed);
+  }
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
+using EpochStack = LFStack<int, NoElimination, EpochReclamation>;
+
+TEST(LFStackEpochTest, LIFOOrder) {
+  EpochStack stack;
+
+  stack.push(1);
+  stack.push(2);
+  stack.push(3);
+
+  EXPECT_EQ(*stack.pop(), 3);
+  EXPECT_EQ(*stack.pop(), 2);
+  EXPECT_EQ(*stack.pop(), 1);
+  EXPECT_FALSE(stack.pop().has_value());
+}
+
+TEST(LFStackEpochTest, ConcurrentPushPopConservesItems) {
+  LFStack<int, EliminationBackoff<4, 256>, EpochReclamation> stack;
+  const size_t num_threads = 8;
+  const size_t ops_per_thread = 2000;
+
+  std::atomic<long> pushed_sum{0};
+  std::atomic<long> popped_sum{0};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < ops_per_thread; ++i) {
+        int value = static_cast<int>(t * ops_per_thread + i);
+        stack.push(value);
+        pushed_sum.fetch_add(value, std::memory_order_relaxed);
+        if (auto val = stack.pop()) {
+          popped_sum.fetch_add(*val, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto rest = stack.pop_all();
+  for (int val : rest) {
+    popped_sum.fetch_add(val, std::memory_order_relaxed);
+  }
+  EXPECT_EQ(pushed_sum.load(), popped_sum.load());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
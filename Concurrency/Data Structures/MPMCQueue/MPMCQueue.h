@@ -8,17 +8,20 @@
 #include <optional>
 #include <vector>
 
+#include "../utils/EpochReclaimer/EpochReclaimer.h"
 #include "../utils/HazardPointer/HazardPointer.h"
 
 static const auto CACHE_SIZE = std::hardware_constructive_interference_size;
 
-template <typename T>
+// Reclaim selects how popped items are freed, see the policy interface in
+// HazardPointer.h (HazardPointerReclamation or EpochReclamation).
+template <typename T, typename Reclaim = HazardPointerReclamation>
 class MPMCQueue {
   using size_type = std::size_t;
 
  public:
   explicit MPMCQueue(size_t capacity)
-      : capacity_(capacity), buffer_(capacity), hp_(64) {
+      : capacity_(capacity), buffer_(capacity), reclaim_(64) {
     for (size_t i{}; i < capacity_; i++) {
       buffer_[i].store(nullptr, std::memory_order_relaxed);
     }
@@ -93,16 +96,11 @@ class MPMCQueue {
         return std::nullopt;
       }
 
-      T* item = buffer_[current].load(std::memory_order_acquire);
+      auto guard = reclaim_.guard();
+      T* item = guard.protect(buffer_[current]);
       if (!item) {
         return std::nullopt;
       }
-      hp_.protect(item);
-
-      if (buffer_[current].load(std::memory_order_acquire) != item) {
-        hp_.release();
-        continue;
-      }
 
       if (consumer_.index.compare_exchange_weak(current, next,
                                                 std::memory_order_release,
@@ -110,12 +108,10 @@ class MPMCQueue {
         // set to nullptr for the spin lock
         buffer_[current].store(nullptr, std::memory_order_release);
         T value = std::move(*item);
-        hp_.release();
-        hp_.retire(item);
+        guard.reset();
+        reclaim_.retire(item);
         return value;
       }
-
-      hp_.release();
     }
   }
 
@@ -126,27 +122,21 @@ class MPMCQueue {
       return std::nullopt;
     }
 
-    T* item = buffer_[current].load(std::memory_order_acquire);
+    auto guard = reclaim_.guard();
+    T* item = guard.protect(buffer_[current]);
     if (!item) {
       return std::nullopt;
     }
-    hp_.protect(item);
-
-    if (buffer_[current].load(std::memory_order_acquire) != item) {
-      hp_.release();
-      return std::nullopt;
-    }
 
     if (consumer_.index.compare_exchange_weak(current, next,
                                               std::memory_order_release,
                                               std::memory_order_relaxed)) {
       buffer_[current].store(nullptr, std::memory_order_release);
       T value = std::move(*item);
-      hp_.release();
-      hp_.retire(item);
+      guard.reset();
+      reclaim_.retire(item);
       return value;
     }
-    hp_.release();
     return std::nullopt;
   }
 
@@ -158,7 +148,7 @@ class MPMCQueue {
  private:
   size_t capacity_;
   std::vector<std::atomic<T*>> buffer_;
-  HazardPointer<T> hp_;
+  typename Reclaim::template Domain<T> reclaim_;
   alignas(CACHE_SIZE) struct {
     std::atomic<size_t> index{0};
   } consumer_;
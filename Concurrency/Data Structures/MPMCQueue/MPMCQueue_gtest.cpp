@@ -260,3 +260,49 @@ TEST(MPMCQueueTest, TryPushContention) {
 
   ASSERT_EQ(drained, successful_pushes.load());
 }
+
+TEST(MPMCQueueEpochTest, MultipleProducersMultipleConsumers) {
+  MPMCQueue<int, EpochReclamation> queue(256);
+  constexpr int NUM_PRODUCERS = 4;
+  constexpr int NUM_CONSUMERS = 4;
+  constexpr int ITEMS_PER_PRODUCER = 5000;
+  constexpr int TOTAL_ITEMS = NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+
+  std::atomic<int> consumed{0};
+  std::atomic<long> sum{0};
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < NUM_PRODUCERS; ++p) {
+    producers.emplace_back([&queue]() {
+      for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        queue.push(i);
+      }
+    });
+  }
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < NUM_CONSUMERS; ++c) {
+    consumers.emplace_back([&queue, &consumed, &sum]() {
+      while (consumed.load(std::memory_order_relaxed) < TOTAL_ITEMS) {
+        if (auto item = queue.pop()) {
+          sum.fetch_add(*item, std::memory_order_relaxed);
+          consumed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (auto& t : producers) {
+    t.join();
+  }
+  for (auto& t : consumers) {
+    t.join();
+  }
+
+  const long per_producer =
+      static_cast<long>(ITEMS_PER_PRODUCER) * (ITEMS_PER_PRODUCER - 1) / 2;
+  ASSERT_EQ(consumed.load(), TOTAL_ITEMS);
+  ASSERT_EQ(sum.load(), NUM_PRODUCERS * per_producer);
+}
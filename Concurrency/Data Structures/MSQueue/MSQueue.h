@@ -0,0 +1,174 @@
+#ifndef MSQUEUE_H_
+#define MSQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "../utils/HazardPointer/HazardPointer.h"
+#include "../utils/NodePool/NodePool.h"
+
+// Michael-Scott lock-free queue, the lock-free counterpart of FGQueue.
+//
+// The queue always holds a dummy node: head_ points at it and the first real
+// element is head_->next. A push links its node after the last node with a
+// CAS on next and then swings tail_, a pop swings head_ to head_->next and
+// that node becomes the new dummy. Whichever thread finds tail_ lagging
+// behind the last node helps move it along, so no thread ever waits on
+// another.
+//
+// Nodes are protected through the process wide HazardDomain (slot 0 for
+// head/tail, slot 1 for head->next) and recycled through a NodePool.
+template <typename T>
+class MSQueue {
+  using value_type = T;
+
+ public:
+  MSQueue() : hp_(HazardDomain::global()) {
+    Node* dummy = new Node();
+    head_.store(dummy, std::memory_order_relaxed);
+    tail_.store(dummy, std::memory_order_relaxed);
+  }
+
+  MSQueue(const MSQueue& other) = delete;
+  MSQueue(MSQueue&& other) = delete;
+  MSQueue& operator=(const MSQueue& other) = delete;
+  MSQueue& operator=(MSQueue&& other) = delete;
+
+  /**
+   * frees every node still linked, retired nodes belong to the hazard domain
+   *
+   * REQUIRES:
+   * no other thread is using the queue
+   */
+  ~MSQueue();
+
+  /**
+   * Adds item to the back of the queue, never blocks
+   *
+   * ARGS:
+   * item: element of type T that will be added to the queue
+   */
+  void push(value_type item);
+
+  /**
+   * Removes the front of the queue
+   *
+   * RETURNS:
+   * the front element, or std::nullopt if the queue was empty
+   */
+  std::optional<value_type> try_pop();
+
+ private:
+  // the dummy node has no value, so the value is an optional that is engaged
+  // for every node a push creates
+  struct Node {
+    std::optional<value_type> value;
+    std::atomic<Node*> next{nullptr};
+
+    Node() = default;
+    explicit Node(value_type item) : value(std::move(item)) {}
+
+    static void* operator new(std::size_t) {
+      return NodePool<Node>::allocate();
+    }
+    static void operator delete(void* ptr) { NodePool<Node>::deallocate(ptr); }
+  };
+
+  static constexpr size_t HEAD_SLOT = 0;
+  static constexpr size_t NEXT_SLOT = 1;
+
+  // loads src into the given hazard slot and re-reads until it is stable
+  Node* protect(const std::atomic<Node*>& src, size_t slot) {
+    Node* ptr = src.load(std::memory_order_acquire);
+    while (true) {
+      hp_.protect(ptr, slot);
+      Node* again = src.load(std::memory_order_acquire);
+      if (again == ptr) {
+        return ptr;
+      }
+      ptr = again;
+    }
+  }
+
+  HazardPointer<Node> hp_;
+  alignas(std::hardware_constructive_interference_size)
+      std::atomic<Node*> head_{nullptr};
+  alignas(std::hardware_constructive_interference_size)
+      std::atomic<Node*> tail_{nullptr};
+};
+
+template <typename T>
+MSQueue<T>::~MSQueue() {
+  Node* curr = head_.load(std::memory_order_relaxed);
+  while (curr != nullptr) {
+    Node* next = curr->next.load(std::memory_order_relaxed);
+    delete curr;
+    curr = next;
+  }
+}
+
+template <typename T>
+void MSQueue<T>::push(value_type item) {
+  Node* node = new Node(std::move(item));
+  while (true) {
+    Node* tail = protect(tail_, HEAD_SLOT);
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail != tail_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (next != nullptr) {
+      // tail_ is lagging, help the push that linked next finish
+      tail_.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+    if (tail->next.compare_exchange_weak(next, node, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+      // failing here is fine, someone already helped
+      tail_.compare_exchange_strong(tail, node, std::memory_order_release,
+                                    std::memory_order_relaxed);
+      break;
+    }
+  }
+  hp_.release(HEAD_SLOT);
+}
+
+template <typename T>
+std::optional<T> MSQueue<T>::try_pop() {
+  while (true) {
+    Node* head = protect(head_, HEAD_SLOT);
+    Node* tail = tail_.load(std::memory_order_acquire);
+    Node* next = head->next.load(std::memory_order_acquire);
+    hp_.protect(next, NEXT_SLOT);
+    // while head is still head_ it has not been retired, so next is still
+    // its successor and the protection above is valid
+    if (head != head_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (next == nullptr) {
+      hp_.release(HEAD_SLOT);
+      hp_.release(NEXT_SLOT);
+      return std::nullopt;
+    }
+    if (head == tail) {
+      tail_.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+    if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel,
+                                    std::memory_order_relaxed)) {
+      // next is the new dummy, only the thread that won the CAS touches its
+      // value and slot 1 keeps it alive until we are done with it
+      std::optional<T> res(std::move(next->value));
+      hp_.release(HEAD_SLOT);
+      hp_.release(NEXT_SLOT);
+      hp_.retire(head);
+      return res;
+    }
+  }
+}
+
+#endif  // MSQUEUE_H_
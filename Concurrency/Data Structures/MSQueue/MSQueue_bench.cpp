@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "../FGQueue/FGQueue.h"
+#include "MSQueue.h"
+
+// Michael-Scott queue against the two-lock FGQueue. Every thread pushes and
+// then pops, so producers contend on the tail and consumers on the head at
+// the same time.
+
+template <typename Queue>
+static void BM_PushPop(benchmark::State& state) {
+  static Queue* queue = nullptr;
+  if (state.thread_index() == 0) {
+    queue = new Queue();
+  }
+  int value = state.thread_index();
+  for (auto _ : state) {
+    queue->push(value);
+    benchmark::DoNotOptimize(queue->try_pop());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+  if (state.thread_index() == 0) {
+    delete queue;
+    queue = nullptr;
+  }
+}
+
+// half the threads only push, the other half only pop
+template <typename Queue>
+static void BM_ProducersConsumers(benchmark::State& state) {
+  static Queue* queue = nullptr;
+  if (state.thread_index() == 0) {
+    queue = new Queue();
+  }
+  const bool producer = state.thread_index() % 2 == 0;
+  int value = state.thread_index();
+  for (auto _ : state) {
+    if (producer) {
+      queue->push(value);
+    } else {
+      benchmark::DoNotOptimize(queue->try_pop());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete queue;
+    queue = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_PushPop, FGQueue<int>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PushPop, MSQueue<int>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, FGQueue<int>)
+    ->ThreadRange(2, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProducersConsumers, MSQueue<int>)
+    ->ThreadRange(2, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MSQueue.h"
+
+TEST(MSQueue, PushPop) {
+  MSQueue<int> q;
+  q.push(42);
+  auto val = q.try_pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(*val, 42);
+}
+
+TEST(MSQueue, PopEmpty) {
+  MSQueue<int> q;
+  EXPECT_FALSE(q.try_pop().has_value());
+}
+
+TEST(MSQueue, FIFO) {
+  MSQueue<int> q;
+  for (int i = 0; i < 100; ++i) {
+    q.push(i);
+  }
+  for (int i = 0; i < 100; ++i) {
+    auto val = q.try_pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(*val, i);
+  }
+  EXPECT_FALSE(q.try_pop().has_value());
+}
+
+TEST(MSQueue, MoveOnlyType) {
+  MSQueue<std::unique_ptr<std::string>> q;
+  q.push(std::make_unique<std::string>("first"));
+  q.push(std::make_unique<std::string>("second"));
+
+  auto first = q.try_pop();
+  auto second = q.try_pop();
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(**first, "first");
+  EXPECT_EQ(**second, "second");
+}
+
+TEST(MSQueue, DestructorReleasesValues) {
+  auto counter = std::make_shared<int>(0);
+  {
+    MSQueue<std::shared_ptr<int>> q;
+    for (int i = 0; i < 10; ++i) {
+      q.push(counter);
+    }
+    ASSERT_TRUE(q.try_pop().has_value());
+    EXPECT_EQ(counter.use_count(), 10);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MSQueue, ConcurrentPush) {
+  MSQueue<int> q;
+  const int num_threads = 4;
+  const int pushes_per_thread = 1000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&q, pushes_per_thread]() {
+      for (int j = 0; j < pushes_per_thread; ++j) {
+        q.push(j);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  int count = 0;
+  while (q.try_pop().has_value()) {
+    count++;
+  }
+  EXPECT_EQ(count, num_threads * pushes_per_thread);
+}
+
+TEST(MSQueue, PerProducerOrderIsKept) {
+  MSQueue<std::pair<int, int>> q;
+  const int num_producers = 4;
+  const int items_per_producer = 2000;
+  const int total = num_producers * items_per_producer;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; ++p) {
+    threads.emplace_back([&q, p, items_per_producer]() {
+      for (int i = 0; i < items_per_producer; ++i) {
+        q.push({p, i});
+      }
+    });
+  }
+
+  std::atomic<int> consumed{0};
+  std::atomic<bool> out_of_order{false};
+  std::atomic<long> sum{0};
+  for (int c = 0; c < 2; ++c) {
+    threads.emplace_back([&]() {
+      // a single consumer sees every producer's items in push order
+      std::vector<int> last_seen(num_producers, -1);
+      while (consumed.load() < total) {
+        auto val = q.try_pop();
+        if (!val) {
+          std::this_thread::yield();
+          continue;
+        }
+        if (val->second <= last_seen[val->first]) {
+          out_of_order = true;
+        }
+        last_seen[val->first] = val->second;
+        sum.fetch_add(val->second);
+        consumed.fetch_add(1);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_FALSE(out_of_order.load());
+  EXPECT_EQ(sum.load(), static_cast<long>(num_producers) * items_per_producer *
+                            (items_per_producer - 1) / 2);
+  EXPECT_FALSE(q.try_pop().has_value());
+}
+
+TEST(MSQueue, StressTest) {
+  MSQueue<int> q;
+  const int num_threads = 8;
+  const int ops_per_thread = 5000;
+
+  std::atomic<long> pushed{0};
+  std::atomic<long> popped{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < ops_per_thread; ++i) {
+        int value = t * ops_per_thread + i;
+        q.push(value);
+        pushed.fetch_add(value);
+        if (auto val = q.try_pop()) {
+          popped.fetch_add(*val);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  while (auto val = q.try_pop()) {
+    popped.fetch_add(*val);
+  }
+  EXPECT_EQ(pushed.load(), popped.load());
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,548 @@
+#ifndef SHARDED_LRU_CACHE_H_
+#define SHARDED_LRU_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "../../../Data Structures/HashTable/XXHash.h"
+#include "../utils/EpochReclaimer/EpochReclaimer.h"
+
+/**
+ * Thread-safe least recently used cache split into independently locked
+ * shards, each with its own slice of the capacity and its own recency list.
+ *
+ * An LRUCache behind a mutex turns every lookup into a write, because a hit
+ * moves the entry to the back of the list. Here lookups take no lock at all.
+ * A shard indexes its entries in a fixed array of bucket chains which
+ * readers walk with acquire loads inside an epoch critical section, while
+ * writers hold the shard mutex, publish new nodes, unlink old ones and hand
+ * them to an EpochReclaimer. An entry is never changed in place, put
+ * replaces the whole node, so a reader never sees a torn value.
+ *
+ * A hit does not touch the recency list straight away. As with the read
+ * buffers in Caffeine, it is appended to a small lossy ring picked by the
+ * reading thread, and the rings are replayed in one batch by whoever holds
+ * the shard mutex: every writer before it writes, and a reader that fills a
+ * ring if it can take the mutex without waiting. A full ring drops hits
+ * rather than block, so under heavy contention recency is approximate,
+ * which costs hit rate but never correctness.
+ *
+ * Values are copied out of lookups, a reference could outlive its node.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class ShardedLRUCache {
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+
+  static constexpr size_type DEFAULT_SHARDS = 16;
+  // hits one read buffer holds before it asks to be drained, a power of two
+  static constexpr uint32_t READ_BUFFER_SIZE = 32;
+  // read buffers per shard, a thread always records into the same one
+  static constexpr size_type READ_BUFFERS = 4;
+
+  /**
+   * Constructs an empty cache
+   *
+   * ARGS:
+   * capacity: total number of entries, split as evenly as possible across
+   *           the shards
+   * num_shards: number of independently locked shards, rounded up to a
+   *             power of two
+   * hash: hashes keys, the high bits pick the shard and the low bits the
+   *       bucket within it
+   * equal: compares keys
+   *
+   * THROWS:
+   * std::invalid_argument if num_shards is 0 or capacity is smaller than the
+   * number of shards
+   */
+  explicit ShardedLRUCache(size_type capacity,
+                           size_type num_shards = DEFAULT_SHARDS,
+                           const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual());
+
+  ~ShardedLRUCache();
+
+  ShardedLRUCache(const ShardedLRUCache&) = delete;
+  ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+  // -- CAPACITY -- //
+
+  /**
+   * Number of cached entries. Shards are counted one at a time, so under
+   * concurrent writes this is only a snapshot
+   */
+  size_type size() const;
+
+  bool empty() const { return size() == 0; }
+
+  size_type capacity() const { return capacity_; }
+
+  /**
+   * Number of shards the keys are spread across
+   */
+  size_type shard_count() const { return shard_mask_ + 1; }
+
+  // -- MODIFIERS -- //
+
+  /**
+   * Adds the key-value pair as the most recently used entry of its shard,
+   * replacing the value if the key already exists. A new key evicts the
+   * least recently used entry of its shard if the shard is full.
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   *
+   * RETURNS:
+   * true if the key was inserted, false if an existing value was replaced
+   */
+  bool put(const key_type& key, const value_type& value);
+
+  /**
+   * Removes the entry with the specified key
+   *
+   * ARGS:
+   * key: the key of the entry to remove
+   *
+   * RETURNS:
+   * true if an entry was removed
+   */
+  bool erase(const key_type& key);
+
+  // -- LOOKUP -- //
+
+  /**
+   * Looks up the value of key without locking and records the hit for the
+   * next drain of its shard's read buffers
+   *
+   * ARGS:
+   * key: the key to search for
+   *
+   * RETURNS:
+   * a copy of the value, or std::nullopt if the key is not cached
+   */
+  std::optional<value_type> find(const key_type& key);
+
+  /**
+   * Unlike find() this does not count as a use of the entry
+   *
+   * RETURNS:
+   * true if key is cached, else false
+   */
+  bool contains(const key_type& key) const;
+
+ private:
+  static constexpr size_type RECLAIM_THREADS = 8;
+
+  // recency list links, the shard's head_ is the sentinel
+  struct Links {
+    Links* prev;
+    Links* next;
+  };
+
+  // readers only touch key, value, hash and chain, which never change after
+  // the node is published, and queued
+  struct Node : Links {
+    Node(const key_type& key, const value_type& value, size_type hash)
+        : key(key), value(value), hash(hash) {}
+
+    const key_type key;
+    const value_type value;
+    const size_type hash;
+    std::atomic<Node*> chain{nullptr};
+    // set while a hit on the node waits in a read buffer, so a hot key takes
+    // one slot per drain instead of one per hit
+    std::atomic<bool> queued{false};
+  };
+
+  struct ReadSlot {
+    std::atomic<Node*> node{nullptr};
+    std::atomic<size_type> hash{0};
+  };
+
+  struct alignas(std::hardware_constructive_interference_size) ReadBuffer {
+    std::atomic<uint32_t> tail{0};  // next slot a reader claims
+    std::atomic<uint32_t> head{0};  // next slot the drain replays
+    ReadSlot slots[READ_BUFFER_SIZE];
+  };
+
+  struct alignas(std::hardware_constructive_interference_size) Shard {
+    // read by lookups, written once by the constructor
+    std::unique_ptr<std::atomic<Node*>[]> buckets;
+    size_type bucket_mask = 0;
+    // everything below is guarded by mtx
+    alignas(std::hardware_constructive_interference_size) mutable std::mutex
+        mtx;
+    size_type capacity = 0;
+    size_type size = 0;
+    Links head;  // head.next is the least recently used node, head.prev the
+                 // most recently used
+    ReadBuffer reads[READ_BUFFERS];
+  };
+
+  /**
+   * Helper function that picks the shard of a hash from the high half of a
+   * Fibonacci hash, the low bits of the raw hash pick the bucket
+   */
+  Shard& shard_for(size_type hash) const {
+    uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return shards_[(mixed >> 32) & shard_mask_];
+  }
+
+  static size_type round_up_pow2(size_type n) {
+    if (n == 0) {
+      throw std::invalid_argument("ShardedLRUCache needs at least one shard");
+    }
+    size_type pow2 = 1;
+    while (pow2 < n) {
+      pow2 <<= 1;
+    }
+    return pow2;
+  }
+
+  /**
+   * Helper function that walks the bucket chain of hash, safe without the
+   * shard mutex inside an epoch critical section
+   *
+   * RETURNS:
+   * the node holding key, or nullptr if there is none
+   */
+  Node* lookup(const Shard& shard, size_type hash, const key_type& key) const;
+
+  /**
+   * Helper function that walks the bucket chain of hash. The link is only
+   * stable while shard.mtx is held, a reader has to use lookup()
+   *
+   * RETURNS:
+   * the link that points at the node holding key, or the null link at the
+   * end of the chain
+   */
+  std::atomic<Node*>* find_link(const Shard& shard, size_type hash,
+                                const key_type& key) const;
+
+  /**
+   * Helper function that checks whether node is still in the chain of hash,
+   * comparing addresses only, so node may already have been freed
+   *
+   * REQUIRES:
+   * shard.mtx is held
+   */
+  static bool is_indexed(const Shard& shard, const Node* node,
+                         size_type hash);
+
+  /**
+   * Helper function that appends a hit on node to the calling thread's read
+   * buffer, unless a hit on node is already waiting to be replayed, or drops
+   * it if the buffer is full or contended
+   *
+   * RETURNS:
+   * true if the buffer is full and should be drained
+   */
+  static bool record_read(Shard& shard, Node* node);
+
+  /**
+   * Helper function that replays every recorded hit of the shard in order,
+   * skipping nodes that have been unlinked since
+   *
+   * REQUIRES:
+   * shard.mtx is held
+   */
+  static void drain_reads(Shard& shard);
+
+  /**
+   * Helper function that unlinks node from its bucket chain and the recency
+   * list and retires it
+   *
+   * REQUIRES:
+   * shard.mtx is held
+   */
+  void remove(Shard& shard, std::atomic<Node*>* link, Node* node);
+
+  static void unlink(Links* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+  }
+
+  static void link_back(Shard& shard, Links* node) {
+    node->prev = shard.head.prev;
+    node->next = &shard.head;
+    shard.head.prev->next = node;
+    shard.head.prev = node;
+  }
+
+  // spreads threads round robin over the read buffers of every shard
+  static size_type read_buffer_index() {
+    static std::atomic<size_type> next_thread{0};
+    thread_local size_type index =
+        next_thread.fetch_add(1, std::memory_order_relaxed) % READ_BUFFERS;
+    return index;
+  }
+
+  size_type capacity_;
+  size_type shard_mask_;
+  Hash hasher_;
+  KeyEqual key_equal_;
+  // declared before shards_ so it outlives them and frees retired nodes last
+  mutable EpochReclaimer<Node> reclaim_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+ShardedLRUCache<K, V, Hash, KeyEqual>::ShardedLRUCache(size_type capacity,
+                                                       size_type num_shards,
+                                                       const Hash& hash,
+                                                       const KeyEqual& equal)
+    : capacity_(capacity),
+      shard_mask_(round_up_pow2(num_shards) - 1),
+      hasher_(hash),
+      key_equal_(equal),
+      reclaim_(RECLAIM_THREADS) {
+  size_type num = shard_count();
+  if (capacity < num) {
+    throw std::invalid_argument(
+        "ShardedLRUCache needs a capacity of at least one entry per shard");
+  }
+  shards_.reset(new Shard[num]);
+  for (size_type i = 0; i < num; ++i) {
+    Shard& shard = shards_[i];
+    shard.capacity = capacity / num + (i < capacity % num ? 1 : 0);
+    // the chains average at most one node, a shard never holds more than
+    // its capacity
+    size_type num_buckets = round_up_pow2(shard.capacity);
+    shard.buckets.reset(new std::atomic<Node*>[num_buckets]);
+    for (size_type b = 0; b < num_buckets; ++b) {
+      shard.buckets[b].store(nullptr, std::memory_order_relaxed);
+    }
+    shard.bucket_mask = num_buckets - 1;
+    shard.head.prev = &shard.head;
+    shard.head.next = &shard.head;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+ShardedLRUCache<K, V, Hash, KeyEqual>::~ShardedLRUCache() {
+  // read buffers may still point at retired nodes, only the recency lists
+  // hold the live ones
+  for (size_type i = 0; i < shard_count(); ++i) {
+    Links& head = shards_[i].head;
+    for (Links* curr = head.next; curr != &head;) {
+      Links* next = curr->next;
+      delete static_cast<Node*>(curr);
+      curr = next;
+    }
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename ShardedLRUCache<K, V, Hash, KeyEqual>::size_type
+ShardedLRUCache<K, V, Hash, KeyEqual>::size() const {
+  size_type total = 0;
+  for (size_type i = 0; i < shard_count(); ++i) {
+    std::lock_guard lock(shards_[i].mtx);
+    total += shards_[i].size;
+  }
+  return total;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLRUCache<K, V, Hash, KeyEqual>::put(const key_type& key,
+                                                const value_type& value) {
+  size_type hash = hasher_(key);
+  Shard& shard = shard_for(hash);
+  // built before taking the lock, so copying the value does not hold up the
+  // shard
+  Node* fresh = new Node(key, value, hash);
+  std::lock_guard lock(shard.mtx);
+  drain_reads(shard);
+
+  std::atomic<Node*>* link = find_link(shard, hash, key);
+  Node* old = link->load(std::memory_order_relaxed);
+  if (old != nullptr) {
+    fresh->chain.store(old->chain.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    link->store(fresh, std::memory_order_release);
+    unlink(old);
+    link_back(shard, fresh);
+    reclaim_.retire(old);
+    return false;
+  }
+
+  if (shard.size == shard.capacity) {
+    Node* victim = static_cast<Node*>(shard.head.next);
+    remove(shard, find_link(shard, victim->hash, victim->key), victim);
+  }
+  std::atomic<Node*>& bucket = shard.buckets[hash & shard.bucket_mask];
+  fresh->chain.store(bucket.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+  bucket.store(fresh, std::memory_order_release);
+  link_back(shard, fresh);
+  ++shard.size;
+  return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLRUCache<K, V, Hash, KeyEqual>::erase(const key_type& key) {
+  size_type hash = hasher_(key);
+  Shard& shard = shard_for(hash);
+  std::lock_guard lock(shard.mtx);
+  drain_reads(shard);
+  std::atomic<Node*>* link = find_link(shard, hash, key);
+  Node* node = link->load(std::memory_order_relaxed);
+  if (node == nullptr) {
+    return false;
+  }
+  remove(shard, link, node);
+  return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::optional<V> ShardedLRUCache<K, V, Hash, KeyEqual>::find(
+    const key_type& key) {
+  size_type hash = hasher_(key);
+  Shard& shard = shard_for(hash);
+  auto guard = reclaim_.enter();
+  Node* node = lookup(shard, hash, key);
+  if (node == nullptr) {
+    return std::nullopt;
+  }
+  std::optional<value_type> value(node->value);
+  if (record_read(shard, node)) {
+    std::unique_lock lock(shard.mtx, std::try_to_lock);
+    if (lock.owns_lock()) {
+      drain_reads(shard);
+    }
+  }
+  return value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLRUCache<K, V, Hash, KeyEqual>::contains(
+    const key_type& key) const {
+  size_type hash = hasher_(key);
+  const Shard& shard = shard_for(hash);
+  auto guard = reclaim_.enter();
+  return lookup(shard, hash, key) != nullptr;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename ShardedLRUCache<K, V, Hash, KeyEqual>::Node*
+ShardedLRUCache<K, V, Hash, KeyEqual>::lookup(const Shard& shard,
+                                              size_type hash,
+                                              const key_type& key) const {
+  Node* node =
+      shard.buckets[hash & shard.bucket_mask].load(std::memory_order_acquire);
+  while (node != nullptr &&
+         !(node->hash == hash && key_equal_(node->key, key))) {
+    node = node->chain.load(std::memory_order_acquire);
+  }
+  return node;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+std::atomic<typename ShardedLRUCache<K, V, Hash, KeyEqual>::Node*>*
+ShardedLRUCache<K, V, Hash, KeyEqual>::find_link(const Shard& shard,
+                                                 size_type hash,
+                                                 const key_type& key) const {
+  std::atomic<Node*>* link = &shard.buckets[hash & shard.bucket_mask];
+  for (Node* node = link->load(std::memory_order_acquire); node != nullptr;
+       node = link->load(std::memory_order_acquire)) {
+    if (node->hash == hash && key_equal_(node->key, key)) {
+      break;
+    }
+    link = &node->chain;
+  }
+  return link;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLRUCache<K, V, Hash, KeyEqual>::is_indexed(const Shard& shard,
+                                                       const Node* node,
+                                                       size_type hash) {
+  for (Node* curr = shard.buckets[hash & shard.bucket_mask].load(
+           std::memory_order_relaxed);
+       curr != nullptr; curr = curr->chain.load(std::memory_order_relaxed)) {
+    if (curr == node) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool ShardedLRUCache<K, V, Hash, KeyEqual>::record_read(Shard& shard,
+                                                        Node* node) {
+  if (node->queued.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  ReadBuffer& buffer = shard.reads[read_buffer_index()];
+  uint32_t tail = buffer.tail.load(std::memory_order_relaxed);
+  // acquire so the drain is done with the slot before it is reused
+  uint32_t pending = tail - buffer.head.load(std::memory_order_acquire);
+  if (pending >= READ_BUFFER_SIZE) {
+    return true;
+  }
+  // another reader took the slot, losing a hit is cheaper than retrying
+  if (!buffer.tail.compare_exchange_strong(tail, tail + 1,
+                                           std::memory_order_relaxed)) {
+    return false;
+  }
+  node->queued.store(true, std::memory_order_relaxed);
+  ReadSlot& slot = buffer.slots[tail & (READ_BUFFER_SIZE - 1)];
+  slot.hash.store(node->hash, std::memory_order_relaxed);
+  slot.node.store(node, std::memory_order_release);
+  return pending + 1 >= READ_BUFFER_SIZE;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void ShardedLRUCache<K, V, Hash, KeyEqual>::drain_reads(Shard& shard) {
+  for (ReadBuffer& buffer : shard.reads) {
+    uint32_t head = buffer.head.load(std::memory_order_relaxed);
+    uint32_t tail = buffer.tail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      ReadSlot& slot = buffer.slots[head & (READ_BUFFER_SIZE - 1)];
+      Node* node = slot.node.load(std::memory_order_acquire);
+      if (node == nullptr) {
+        // claimed but not written yet, the next drain picks it up
+        break;
+      }
+      // only the drain clears slots, and a reader does not write the slot
+      // again before it sees head move past it
+      slot.node.store(nullptr, std::memory_order_relaxed);
+      // the hit may be on a node that was replaced or evicted since, and
+      // which may even have been freed, so it is only promoted if it is
+      // still in its chain
+      if (is_indexed(shard, node, slot.hash.load(std::memory_order_relaxed))) {
+        node->queued.store(false, std::memory_order_relaxed);
+        unlink(node);
+        link_back(shard, node);
+      }
+    }
+    buffer.head.store(head, std::memory_order_release);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void ShardedLRUCache<K, V, Hash, KeyEqual>::remove(Shard& shard,
+                                                   std::atomic<Node*>* link,
+                                                   Node* node) {
+  // readers standing on node can still follow its chain to the rest
+  link->store(node->chain.load(std::memory_order_relaxed),
+              std::memory_order_release);
+  unlink(node);
+  --shard.size;
+  reclaim_.retire(node);
+}
+
+#endif  // SHARDED_LRU_CACHE_H_
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "../../../Data Structures/LRUCache/LRUCache.h"
+#include "ShardedLRUCache.h"
+
+// Sharded cache against one LRUCache behind a single mutex, on a get/put mix
+// (90% find, 10% put) whose keys follow a Zipfian distribution, so a few hot
+// keys take most of the hits the way real cache traffic does.
+
+class SingleLockLRU {
+ public:
+  explicit SingleLockLRU(size_t capacity) : cache_(capacity) {}
+
+  std::optional<int> find(int key) {
+    std::lock_guard lock(mtx_);
+    int* value = cache_.find(key);
+    return value ? std::optional<int>(*value) : std::nullopt;
+  }
+
+  void put(int key, int value) {
+    std::lock_guard lock(mtx_);
+    cache_.put(key, value);
+  }
+
+ private:
+  std::mutex mtx_;
+  LRUCache<int, int> cache_;
+};
+
+// Zipfian ranks 0..n-1 with P(k) proportional to 1 / (k + 1)^THETA, drawn
+// from a precomputed CDF with a binary search
+class Zipfian {
+ public:
+  static constexpr double THETA = 0.99;
+
+  explicit Zipfian(int n) : cdf_(n) {
+    double sum = 0;
+    for (int k = 0; k < n; ++k) {
+      sum += 1.0 / std::pow(k + 1, THETA);
+      cdf_[k] = sum;
+    }
+    for (double& p : cdf_) {
+      p /= sum;
+    }
+  }
+
+  // uniform: 24 random bits
+  int operator()(uint32_t uniform) const {
+    double u = uniform / static_cast<double>(1 << 24);
+    int lo = 0;
+    int hi = static_cast<int>(cdf_.size()) - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cdf_[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+ private:
+  std::vector<double> cdf_;
+};
+
+constexpr int NUM_KEYS = 1 << 16;
+constexpr size_t CAPACITY = NUM_KEYS / 8;
+// keys each thread draws before timing starts, so the binary search of the
+// sampler stays out of the measurement
+constexpr size_t TRACE_LENGTH = 1 << 16;
+
+template <typename Cache>
+static void BM_ZipfianMix(benchmark::State& state) {
+  static Cache* cache = nullptr;
+  static const Zipfian zipf(NUM_KEYS);
+  if (state.thread_index() == 0) {
+    cache = new Cache(CAPACITY);
+    for (int key = 0; key < static_cast<int>(CAPACITY); ++key) {
+      cache->put(key, key);
+    }
+  }
+  uint32_t rng = state.thread_index() * 7919 + 1;
+  std::vector<int> trace(TRACE_LENGTH);
+  for (int& key : trace) {
+    rng = rng * 1664525u + 1013904223u;
+    key = zipf(rng >> 8);
+  }
+  int64_t hits = 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    int key = trace[i++ & (TRACE_LENGTH - 1)];
+    if (i % 10 == 0) {
+      cache->put(key, key);
+    } else {
+      auto value = cache->find(key);
+      hits += value.has_value();
+      benchmark::DoNotOptimize(value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["hit_rate"] = benchmark::Counter(
+      static_cast<double>(hits) / state.iterations(),
+      benchmark::Counter::kAvgThreads);
+  if (state.thread_index() == 0) {
+    delete cache;
+    cache = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_ZipfianMix, SingleLockLRU)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ZipfianMix, ShardedLRUCache<int, int>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
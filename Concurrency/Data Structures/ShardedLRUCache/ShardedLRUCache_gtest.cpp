@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ShardedLRUCache.h"
+
+// Basic operations
+TEST(ShardedLRUCache, PutFind) {
+  ShardedLRUCache<int, std::string> cache(64);
+  EXPECT_TRUE(cache.empty());
+  EXPECT_TRUE(cache.put(1, "one"));
+  EXPECT_FALSE(cache.put(1, "uno"));
+  EXPECT_EQ(cache.find(1), "uno");
+  EXPECT_EQ(cache.find(2), std::nullopt);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(ShardedLRUCache, Erase) {
+  ShardedLRUCache<int, int> cache(64);
+  cache.put(5, 50);
+  EXPECT_TRUE(cache.erase(5));
+  EXPECT_FALSE(cache.erase(5));
+  EXPECT_FALSE(cache.contains(5));
+  EXPECT_TRUE(cache.empty());
+}
+
+TEST(ShardedLRUCache, Constructor) {
+  using Cache = ShardedLRUCache<int, int>;
+  EXPECT_EQ(Cache(8, 5).shard_count(), 8u);
+  EXPECT_EQ(Cache(64).shard_count(), Cache::DEFAULT_SHARDS);
+  EXPECT_EQ(Cache(100, 8).capacity(), 100u);
+  EXPECT_THROW(Cache(8, 0), std::invalid_argument);
+  // every shard needs room for at least one entry
+  EXPECT_THROW(Cache(7, 8), std::invalid_argument);
+}
+
+// With one shard the cache behaves like LRUCache
+TEST(ShardedLRUCache, EvictsLeastRecentlyUsed) {
+  ShardedLRUCache<int, int> cache(3, 1);
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  cache.put(4, 40);
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(cache.size(), 3u);
+
+  // replacing a value makes it the most recently used
+  cache.put(2, 21);
+  cache.put(5, 50);
+  EXPECT_FALSE(cache.contains(3));
+  EXPECT_EQ(cache.find(2), 21);
+}
+
+// Hits are buffered, the next put replays them before it evicts
+TEST(ShardedLRUCache, FindPromotes) {
+  ShardedLRUCache<int, int> cache(3, 1);
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  EXPECT_EQ(cache.find(1), 10);
+  cache.put(4, 40);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+
+  // contains is not a use
+  EXPECT_TRUE(cache.contains(3));
+  cache.put(5, 50);
+  EXPECT_FALSE(cache.contains(3));
+}
+
+// More hits than a read buffer holds before the next write
+TEST(ShardedLRUCache, ManyHitsBetweenWrites) {
+  using Cache = ShardedLRUCache<int, int>;
+  Cache cache(4, 1);
+  for (int key = 0; key < 4; ++key) {
+    cache.put(key, key);
+  }
+  for (uint32_t i = 0; i < 3 * Cache::READ_BUFFER_SIZE; ++i) {
+    ASSERT_EQ(cache.find(0), 0);
+  }
+  ASSERT_EQ(cache.find(1), 1);
+  cache.put(4, 4);
+  cache.put(5, 5);
+  EXPECT_TRUE(cache.contains(0));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_FALSE(cache.contains(3));
+}
+
+// Each shard evicts within its own slice
+TEST(ShardedLRUCache, NeverExceedsCapacity) {
+  ShardedLRUCache<int, int> cache(100, 8);
+  for (int i = 0; i < 10000; ++i) {
+    cache.put(i, i * 2);
+  }
+  EXPECT_EQ(cache.size(), 100u);
+  for (int i = 9900; i < 10000; ++i) {
+    auto value = cache.find(i);
+    if (value) {
+      EXPECT_EQ(*value, i * 2);
+    }
+  }
+}
+
+// Readers race writers that keep replacing and evicting the same keys. A
+// value is always key * 2 + a version, so a torn or freed node shows up
+TEST(ShardedLRUCache, ConcurrentReadersAndWriters) {
+  constexpr int NUM_THREADS = 8;
+  constexpr int OPS = 20000;
+  constexpr int NUM_KEYS = 512;
+  ShardedLRUCache<int, std::string> cache(128, 4);
+  std::atomic<int> bad{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      uint32_t rng = t * 7919 + 1;
+      for (int i = 0; i < OPS; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        int key = static_cast<int>((rng >> 8) % NUM_KEYS);
+        if ((rng & 0xF) < 4) {
+          cache.put(key, std::to_string(key * 2) + "/" + std::to_string(i));
+        } else if ((rng & 0xF) == 4) {
+          cache.erase(key);
+        } else {
+          auto value = cache.find(key);
+          if (value && value->substr(0, value->find('/')) !=
+                           std::to_string(key * 2)) {
+            bad.fetch_add(1);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(bad.load(), 0);
+  EXPECT_LE(cache.size(), 128u);
+}
@@ -0,0 +1,401 @@
+#ifndef SHMQUEUE_H_
+#define SHMQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "ShmRegion.h"
+
+// The layout has to be identical in every process that maps the region, so
+// a fixed line size is used instead of hardware_constructive_interference_size
+// (which may differ between compiler flags).
+inline constexpr size_t SHM_CACHE_LINE_SIZE = 64;
+
+inline constexpr uint64_t SHM_QUEUE_MAGIC = 0x4144414d51554555ULL;  // ADAMQUEU
+inline constexpr uint32_t SHM_QUEUE_VERSION = 1;
+
+enum class ShmQueueKind : uint32_t { kSPSC = 1, kMPMC = 2 };
+
+/**
+ * Versioned header at offset 0 of every shared queue region. The creator
+ * fills it in and publishes it by storing ready = 1, an attaching process
+ * refuses any region whose header does not match what it was compiled with.
+ */
+struct alignas(SHM_CACHE_LINE_SIZE) ShmQueueHeader {
+  uint64_t magic;
+  uint32_t version;
+  ShmQueueKind kind;
+  uint64_t capacity;
+  uint64_t element_size;
+  uint64_t element_align;
+  std::atomic<uint32_t> ready;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared memory atomics must be lock free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory atomics must be lock free");
+
+// rounds capacity up to a power of two so indices can be masked
+inline uint64_t shm_queue_round_capacity(size_t capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("ShmQueue: capacity must be > 0");
+  }
+  uint64_t rounded = 1;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  return rounded;
+}
+
+template <typename T>
+void shm_queue_init_header(ShmQueueHeader* header, ShmQueueKind kind,
+                           uint64_t capacity) {
+  header->magic = SHM_QUEUE_MAGIC;
+  header->version = SHM_QUEUE_VERSION;
+  header->kind = kind;
+  header->capacity = capacity;
+  header->element_size = sizeof(T);
+  header->element_align = alignof(T);
+}
+
+template <typename T>
+uint64_t shm_queue_check_header(const ShmQueueHeader* header,
+                                ShmQueueKind kind) {
+  if (header->ready.load(std::memory_order_acquire) != 1) {
+    throw std::runtime_error("ShmQueue::attach: region is not initialized");
+  }
+  if (header->magic != SHM_QUEUE_MAGIC) {
+    throw std::runtime_error("ShmQueue::attach: bad magic");
+  }
+  if (header->version != SHM_QUEUE_VERSION) {
+    throw std::runtime_error("ShmQueue::attach: version mismatch");
+  }
+  if (header->kind != kind) {
+    throw std::runtime_error("ShmQueue::attach: queue kind mismatch");
+  }
+  if (header->element_size != sizeof(T) ||
+      header->element_align != alignof(T)) {
+    throw std::runtime_error("ShmQueue::attach: element type mismatch");
+  }
+  return header->capacity;
+}
+
+/**
+ * Single producer single consumer ring that lives entirely inside a
+ * ShmRegion, so the producer and consumer can be different processes.
+ *
+ * Unlike SPSCQueue the elements are stored by value in the mapping (a
+ * shared_ptr is meaningless in another address space), which is why T has to
+ * be trivially copyable. Head and tail are free running counters, so all
+ * `capacity` slots are usable. Each side keeps a process local copy of the
+ * other side's index and only rereads the shared one when it looks full or
+ * empty, which keeps the two cache lines from bouncing on every operation.
+ */
+template <typename T>
+class ShmSPSCQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ShmSPSCQueue elements cross process boundaries by memcpy");
+
+ public:
+  /**
+   * Returns the number of bytes a region needs to hold a queue of the given
+   * capacity (after rounding up to a power of two)
+   */
+  static size_t bytes_required(size_t capacity) {
+    return sizeof(Control) + shm_queue_round_capacity(capacity) * sizeof(T);
+  }
+
+  /**
+   * Lays out a fresh queue over the region and publishes the header
+   *
+   * ARGS:
+   * region: mapping of at least bytes_required(capacity) bytes
+   * capacity: minimum number of elements, rounded up to a power of two
+   *
+   * THROWS:
+   * std::invalid_argument if the region is too small
+   */
+  static ShmSPSCQueue create(ShmRegion region, size_t capacity) {
+    uint64_t rounded = shm_queue_round_capacity(capacity);
+    if (region.size() < bytes_required(rounded)) {
+      throw std::invalid_argument("ShmSPSCQueue::create: region too small");
+    }
+    Control* ctrl = new (region.data()) Control();
+    shm_queue_init_header<T>(&ctrl->header, ShmQueueKind::kSPSC, rounded);
+    ctrl->header.ready.store(1, std::memory_order_release);
+    return ShmSPSCQueue(std::move(region), rounded);
+  }
+
+  /**
+   * Attaches to a queue another process created in the region
+   *
+   * THROWS:
+   * std::runtime_error if the header is missing or does not match T
+   */
+  static ShmSPSCQueue attach(ShmRegion region) {
+    const auto* ctrl = static_cast<const Control*>(region.data());
+    if (region.size() < sizeof(Control)) {
+      throw std::runtime_error("ShmSPSCQueue::attach: region too small");
+    }
+    uint64_t capacity =
+        shm_queue_check_header<T>(&ctrl->header, ShmQueueKind::kSPSC);
+    if (region.size() < bytes_required(capacity)) {
+      throw std::runtime_error("ShmSPSCQueue::attach: region too small");
+    }
+    return ShmSPSCQueue(std::move(region), capacity);
+  }
+
+  ShmSPSCQueue(const ShmSPSCQueue& other) = delete;
+  ShmSPSCQueue& operator=(const ShmSPSCQueue& other) = delete;
+  ShmSPSCQueue(ShmSPSCQueue&& other) = default;
+  ShmSPSCQueue& operator=(ShmSPSCQueue&& other) = default;
+  ~ShmSPSCQueue() = default;
+
+  /**
+   * Copies element into the ring. Producer side only.
+   *
+   * RETURNS:
+   * false if the ring is full
+   */
+  bool push(const T& element) {
+    uint64_t tail = ctrl_->tail.value.load(std::memory_order_relaxed);
+    if (tail - cached_head_ >= capacity_) {
+      cached_head_ = ctrl_->head.value.load(std::memory_order_acquire);
+      if (tail - cached_head_ >= capacity_) {
+        return false;
+      }
+    }
+    std::memcpy(&slots_[tail & mask_], &element, sizeof(T));
+    ctrl_->tail.value.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Copies the oldest element out of the ring. Consumer side only.
+   *
+   * RETURNS:
+   * the element, or std::nullopt if the ring is empty
+   */
+  std::optional<T> try_pop() {
+    uint64_t head = ctrl_->head.value.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = ctrl_->tail.value.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return std::nullopt;
+      }
+    }
+    T result;
+    std::memcpy(&result, &slots_[head & mask_], sizeof(T));
+    ctrl_->head.value.store(head + 1, std::memory_order_release);
+    return result;
+  }
+
+  bool empty() const {
+    return ctrl_->head.value.load(std::memory_order_relaxed) ==
+           ctrl_->tail.value.load(std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Control {
+    ShmQueueHeader header;
+    struct alignas(SHM_CACHE_LINE_SIZE) {
+      std::atomic<uint64_t> value{0};
+    } head;
+    struct alignas(SHM_CACHE_LINE_SIZE) {
+      std::atomic<uint64_t> value{0};
+    } tail;
+  };
+
+  ShmSPSCQueue(ShmRegion region, uint64_t capacity)
+      : region_(std::move(region)),
+        ctrl_(static_cast<Control*>(region_.data())),
+        slots_(reinterpret_cast<T*>(static_cast<char*>(region_.data()) +
+                                    sizeof(Control))),
+        capacity_(capacity),
+        mask_(capacity - 1),
+        cached_head_(ctrl_->head.value.load(std::memory_order_acquire)),
+        cached_tail_(ctrl_->tail.value.load(std::memory_order_acquire)) {}
+
+  ShmRegion region_;
+  Control* ctrl_;
+  T* slots_;
+  uint64_t capacity_;
+  uint64_t mask_;
+  // process local snapshots of the other side's index, seeded from the
+  // shared ones since an attaching process may find them well past zero
+  uint64_t cached_head_;
+  uint64_t cached_tail_;
+};
+
+/**
+ * Bounded multi producer multi consumer ring that lives inside a ShmRegion.
+ *
+ * MPMCQueue hands out heap pointers and reclaims them through hazard
+ * pointers, neither of which work across address spaces. This ring instead
+ * stores elements by value and gives every slot a sequence number
+ * (Vyukov's bounded queue): a producer owns slot i once its sequence equals
+ * the ticket it claimed, a consumer once it equals ticket + 1. No pointers
+ * ever live in the mapping, so it can be mapped at different addresses.
+ */
+template <typename T>
+class ShmMPMCQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ShmMPMCQueue elements cross process boundaries by memcpy");
+
+ public:
+  static size_t bytes_required(size_t capacity) {
+    return sizeof(Control) + shm_queue_round_capacity(capacity) * sizeof(Slot);
+  }
+
+  /**
+   * Lays out a fresh queue over the region and publishes the header
+   *
+   * THROWS:
+   * std::invalid_argument if the region is too small
+   */
+  static ShmMPMCQueue create(ShmRegion region, size_t capacity) {
+    uint64_t rounded = shm_queue_round_capacity(capacity);
+    if (region.size() < bytes_required(rounded)) {
+      throw std::invalid_argument("ShmMPMCQueue::create: region too small");
+    }
+    Control* ctrl = new (region.data()) Control();
+    Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(region.data()) +
+                                          sizeof(Control));
+    for (uint64_t i = 0; i < rounded; ++i) {
+      new (&slots[i]) Slot();
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    shm_queue_init_header<T>(&ctrl->header, ShmQueueKind::kMPMC, rounded);
+    ctrl->header.ready.store(1, std::memory_order_release);
+    return ShmMPMCQueue(std::move(region), rounded);
+  }
+
+  /**
+   * Attaches to a queue another process created in the region
+   *
+   * THROWS:
+   * std::runtime_error if the header is missing or does not match T
+   */
+  static ShmMPMCQueue attach(ShmRegion region) {
+    const auto* ctrl = static_cast<const Control*>(region.data());
+    if (region.size() < sizeof(Control)) {
+      throw std::runtime_error("ShmMPMCQueue::attach: region too small");
+    }
+    uint64_t capacity =
+        shm_queue_check_header<T>(&ctrl->header, ShmQueueKind::kMPMC);
+    if (region.size() < bytes_required(capacity)) {
+      throw std::runtime_error("ShmMPMCQueue::attach: region too small");
+    }
+    return ShmMPMCQueue(std::move(region), capacity);
+  }
+
+  ShmMPMCQueue(const ShmMPMCQueue& other) = delete;
+  ShmMPMCQueue& operator=(const ShmMPMCQueue& other) = delete;
+  ShmMPMCQueue(ShmMPMCQueue&& other) = default;
+  ShmMPMCQueue& operator=(ShmMPMCQueue&& other) = default;
+  ~ShmMPMCQueue() = default;
+
+  /**
+   * one attempt to claim a slot and copy element into it
+   *
+   * RETURNS:
+   * false if the ring is full
+   */
+  bool try_push(const T& element) {
+    uint64_t pos = ctrl_->enqueue.value.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(seq - pos);
+      if (diff == 0) {
+        if (ctrl_->enqueue.value.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          std::memcpy(&slot.value, &element, sizeof(T));
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = ctrl_->enqueue.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * copies the oldest element out of the ring
+   *
+   * RETURNS:
+   * the element, or std::nullopt if the ring is empty
+   */
+  std::optional<T> try_pop() {
+    uint64_t pos = ctrl_->dequeue.value.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (ctrl_->dequeue.value.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          T result;
+          std::memcpy(&result, &slot.value, sizeof(T));
+          slot.sequence.store(pos + capacity_, std::memory_order_release);
+          return result;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        pos = ctrl_->dequeue.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool empty() const {
+    return ctrl_->enqueue.value.load(std::memory_order_relaxed) ==
+           ctrl_->dequeue.value.load(std::memory_order_relaxed);
+  }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    T value;
+  };
+
+  struct Control {
+    ShmQueueHeader header;
+    struct alignas(SHM_CACHE_LINE_SIZE) {
+      std::atomic<uint64_t> value{0};
+    } enqueue;
+    struct alignas(SHM_CACHE_LINE_SIZE) {
+      std::atomic<uint64_t> value{0};
+    } dequeue;
+  };
+
+  ShmMPMCQueue(ShmRegion region, uint64_t capacity)
+      : region_(std::move(region)),
+        ctrl_(static_cast<Control*>(region_.data())),
+        slots_(reinterpret_cast<Slot*>(static_cast<char*>(region_.data()) +
+                                       sizeof(Control))),
+        capacity_(capacity),
+        mask_(capacity - 1) {}
+
+  ShmRegion region_;
+  Control* ctrl_;
+  Slot* slots_;
+  uint64_t capacity_;
+  uint64_t mask_;
+};
+
+#endif  // SHMQUEUE_H_
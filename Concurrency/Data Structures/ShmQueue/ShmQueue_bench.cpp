@@ -0,0 +1,216 @@
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+#include "ShmQueue.h"
+
+// Compares moving fixed size messages between two processes through a
+// shared memory ring against a unix domain socket pair.
+
+struct Message {
+  uint64_t sequence;
+  uint64_t payload;
+};
+
+static constexpr uint64_t STOP = std::numeric_limits<uint64_t>::max();
+static constexpr size_t RING_CAPACITY = 4096;
+
+template <typename Queue>
+static void push_spin(Queue& queue, const Message& msg) {
+  while (!queue.push(msg)) {
+    std::this_thread::yield();
+  }
+}
+
+template <typename Queue>
+static Message pop_spin(Queue& queue) {
+  while (true) {
+    if (auto msg = queue.try_pop()) {
+      return *msg;
+    }
+    std::this_thread::yield();
+  }
+}
+
+static void write_msg(int fd, const Message& msg) {
+  if (::write(fd, &msg, sizeof(msg)) != sizeof(msg)) {
+    ::_exit(1);
+  }
+}
+
+static Message read_msg(int fd) {
+  Message msg{};
+  if (::read(fd, &msg, sizeof(msg)) != sizeof(msg)) {
+    ::_exit(1);
+  }
+  return msg;
+}
+
+static void wait_child(pid_t pid) {
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+}
+
+// one way: producer streams messages, child drains them
+static void BM_ShmSPSC_Throughput(benchmark::State& state) {
+  using Queue = ShmSPSCQueue<Message>;
+  ShmRegion region =
+      ShmRegion::create_memfd("bench", Queue::bytes_required(RING_CAPACITY));
+  int child_fd = ::dup(region.fd());
+  Queue queue = Queue::create(std::move(region), RING_CAPACITY);
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    Queue child = Queue::attach(ShmRegion::from_fd(child_fd));
+    while (pop_spin(child).sequence != STOP) {
+    }
+    ::_exit(0);
+  }
+  ::close(child_fd);
+
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    push_spin(queue, Message{seq, seq});
+    ++seq;
+  }
+  push_spin(queue, Message{STOP, 0});
+  wait_child(pid);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShmSPSC_Throughput)->UseRealTime();
+
+static void BM_UnixSocket_Throughput(benchmark::State& state) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+    state.SkipWithError("socketpair failed");
+    return;
+  }
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    while (read_msg(fds[1]).sequence != STOP) {
+    }
+    ::_exit(0);
+  }
+  ::close(fds[1]);
+
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    write_msg(fds[0], Message{seq, seq});
+    ++seq;
+  }
+  write_msg(fds[0], Message{STOP, 0});
+  wait_child(pid);
+  ::close(fds[0]);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UnixSocket_Throughput)->UseRealTime();
+
+// round trip: child echoes every message back on a second channel
+static void BM_ShmSPSC_RoundTrip(benchmark::State& state) {
+  using Queue = ShmSPSCQueue<Message>;
+  ShmRegion req_region =
+      ShmRegion::create_memfd("req", Queue::bytes_required(RING_CAPACITY));
+  ShmRegion resp_region =
+      ShmRegion::create_memfd("resp", Queue::bytes_required(RING_CAPACITY));
+  int req_fd = ::dup(req_region.fd());
+  int resp_fd = ::dup(resp_region.fd());
+  Queue requests = Queue::create(std::move(req_region), RING_CAPACITY);
+  Queue responses = Queue::create(std::move(resp_region), RING_CAPACITY);
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    Queue in = Queue::attach(ShmRegion::from_fd(req_fd));
+    Queue out = Queue::attach(ShmRegion::from_fd(resp_fd));
+    while (true) {
+      Message msg = pop_spin(in);
+      if (msg.sequence == STOP) {
+        break;
+      }
+      push_spin(out, msg);
+    }
+    ::_exit(0);
+  }
+  ::close(req_fd);
+  ::close(resp_fd);
+
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    push_spin(requests, Message{seq++, 0});
+    benchmark::DoNotOptimize(pop_spin(responses));
+  }
+  push_spin(requests, Message{STOP, 0});
+  wait_child(pid);
+}
+BENCHMARK(BM_ShmSPSC_RoundTrip)->UseRealTime();
+
+static void BM_UnixSocket_RoundTrip(benchmark::State& state) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+    state.SkipWithError("socketpair failed");
+    return;
+  }
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    while (true) {
+      Message msg = read_msg(fds[1]);
+      if (msg.sequence == STOP) {
+        break;
+      }
+      write_msg(fds[1], msg);
+    }
+    ::_exit(0);
+  }
+  ::close(fds[1]);
+
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    write_msg(fds[0], Message{seq++, 0});
+    benchmark::DoNotOptimize(read_msg(fds[0]));
+  }
+  write_msg(fds[0], Message{STOP, 0});
+  wait_child(pid);
+  ::close(fds[0]);
+}
+BENCHMARK(BM_UnixSocket_RoundTrip)->UseRealTime();
+
+static void BM_ShmMPMC_Throughput(benchmark::State& state) {
+  using Queue = ShmMPMCQueue<Message>;
+  ShmRegion region =
+      ShmRegion::create_memfd("bench", Queue::bytes_required(RING_CAPACITY));
+  int child_fd = ::dup(region.fd());
+  Queue queue = Queue::create(std::move(region), RING_CAPACITY);
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    Queue child = Queue::attach(ShmRegion::from_fd(child_fd));
+    while (pop_spin(child).sequence != STOP) {
+    }
+    ::_exit(0);
+  }
+  ::close(child_fd);
+
+  uint64_t seq = 0;
+  for (auto _ : state) {
+    while (!queue.try_push(Message{seq, seq})) {
+      std::this_thread::yield();
+    }
+    ++seq;
+  }
+  while (!queue.try_push(Message{STOP, 0})) {
+    std::this_thread::yield();
+  }
+  wait_child(pid);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShmMPMC_Throughput)->UseRealTime();
+
+BENCHMARK_MAIN();
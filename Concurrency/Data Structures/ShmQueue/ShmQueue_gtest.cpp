@@ -0,0 +1,335 @@
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ShmQueue.h"
+
+struct Message {
+  uint64_t sequence;
+  uint32_t producer;
+  uint32_t checksum;
+};
+
+static uint32_t checksum_of(uint64_t sequence, uint32_t producer) {
+  return static_cast<uint32_t>(sequence * 2654435761u) ^ producer;
+}
+
+// maps the same memfd a second time, which is what another process does
+static ShmRegion second_mapping(const ShmRegion& region) {
+  return ShmRegion::from_fd(::dup(region.fd()));
+}
+
+static int wait_child(pid_t pid) {
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+TEST(ShmSPSCQueueTest, CapacityRoundsUpToPowerOfTwo) {
+  auto queue = ShmSPSCQueue<int>::create(
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(10)),
+      10);
+  EXPECT_EQ(queue.capacity(), 16u);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShmSPSCQueueTest, NonConFillToCapacity) {
+  auto queue = ShmSPSCQueue<int>::create(
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(8)),
+      8);
+
+  EXPECT_FALSE(queue.try_pop().has_value());
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(queue.push(i));
+  }
+  EXPECT_FALSE(queue.push(999));
+
+  for (int i = 0; i < 8; ++i) {
+    auto val = queue.try_pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(*val, i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShmSPSCQueueTest, NonConWrapAround) {
+  auto queue = ShmSPSCQueue<int>::create(
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(4)),
+      4);
+  for (int cycle = 0; cycle < 10; ++cycle) {
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(queue.push(cycle * 10 + i));
+    }
+    for (int i = 0; i < 3; ++i) {
+      auto val = queue.try_pop();
+      ASSERT_TRUE(val.has_value());
+      EXPECT_EQ(*val, cycle * 10 + i);
+    }
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShmSPSCQueueTest, AttachSeesCreatorsData) {
+  ShmRegion region =
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(8));
+  ShmRegion other = second_mapping(region);
+
+  auto producer = ShmSPSCQueue<int>::create(std::move(region), 8);
+  auto consumer = ShmSPSCQueue<int>::attach(std::move(other));
+
+  ASSERT_TRUE(producer.push(7));
+  auto val = consumer.try_pop();
+  ASSERT_TRUE(val.has_value());
+  EXPECT_EQ(*val, 7);
+  EXPECT_TRUE(producer.empty());
+}
+
+// a process attaching after the indices have run past the capacity must start
+// from the shared indices, not from zero
+TEST(ShmSPSCQueueTest, AttachAfterIndicesMoved) {
+  ShmRegion region =
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(4));
+  ShmRegion for_consumer = second_mapping(region);
+  ShmRegion for_producer = second_mapping(region);
+
+  {
+    auto queue = ShmSPSCQueue<int>::create(std::move(region), 4);
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(queue.push(i));
+      ASSERT_TRUE(queue.try_pop().has_value());
+    }
+  }
+
+  auto consumer = ShmSPSCQueue<int>::attach(std::move(for_consumer));
+  EXPECT_FALSE(consumer.try_pop().has_value());
+
+  auto producer = ShmSPSCQueue<int>::attach(std::move(for_producer));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(producer.push(i));
+  }
+  EXPECT_FALSE(producer.push(999));
+
+  for (int i = 0; i < 4; ++i) {
+    auto val = consumer.try_pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(*val, i);
+  }
+  EXPECT_FALSE(consumer.try_pop().has_value());
+}
+
+TEST(ShmSPSCQueueTest, AttachRejectsUninitializedRegion) {
+  ShmRegion region =
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(8));
+  EXPECT_THROW(ShmSPSCQueue<int>::attach(std::move(region)),
+               std::runtime_error);
+}
+
+TEST(ShmSPSCQueueTest, AttachRejectsMismatchedHeader) {
+  ShmRegion region =
+      ShmRegion::create_memfd("spsc", ShmSPSCQueue<int>::bytes_required(8));
+  ShmRegion as_other_type = second_mapping(region);
+  ShmRegion as_other_kind = second_mapping(region);
+  auto queue = ShmSPSCQueue<int>::create(std::move(region), 8);
+
+  EXPECT_THROW(ShmSPSCQueue<Message>::attach(std::move(as_other_type)),
+               std::runtime_error);
+  EXPECT_THROW(ShmMPMCQueue<int>::attach(std::move(as_other_kind)),
+               std::runtime_error);
+}
+
+TEST(ShmSPSCQueueTest, CreateRejectsSmallRegion) {
+  ShmRegion region = ShmRegion::create_memfd("spsc", 64);
+  EXPECT_THROW(ShmSPSCQueue<int>::create(std::move(region), 8),
+               std::invalid_argument);
+}
+
+TEST(ShmSPSCQueueTest, CrossProcessProducerConsumer) {
+  constexpr uint64_t NUM_ITEMS = 100000;
+  ShmRegion region = ShmRegion::create_memfd(
+      "spsc", ShmSPSCQueue<Message>::bytes_required(256));
+  int child_fd = ::dup(region.fd());
+  auto consumer = ShmSPSCQueue<Message>::create(std::move(region), 256);
+
+  pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto producer = ShmSPSCQueue<Message>::attach(ShmRegion::from_fd(child_fd));
+    for (uint64_t i = 0; i < NUM_ITEMS; ++i) {
+      Message msg{i, 1, checksum_of(i, 1)};
+      while (!producer.push(msg)) {
+        std::this_thread::yield();
+      }
+    }
+    ::_exit(0);
+  }
+  ::close(child_fd);
+
+  uint64_t expected = 0;
+  while (expected < NUM_ITEMS) {
+    auto msg = consumer.try_pop();
+    if (!msg) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(msg->sequence, expected);
+    ASSERT_EQ(msg->checksum, checksum_of(expected, 1));
+    ++expected;
+  }
+  EXPECT_EQ(wait_child(pid), 0);
+  EXPECT_TRUE(consumer.empty());
+}
+
+TEST(ShmSPSCQueueTest, NamedRegionAcrossProcesses) {
+  const std::string name = "/adam_shmq_test_" + std::to_string(::getpid());
+  ShmRegion region =
+      ShmRegion::create_named(name, ShmSPSCQueue<int>::bytes_required(16));
+  auto consumer = ShmSPSCQueue<int>::create(std::move(region), 16);
+
+  pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto producer = ShmSPSCQueue<int>::attach(ShmRegion::open_named(name));
+    for (int i = 0; i < 10; ++i) {
+      while (!producer.push(i)) {
+        std::this_thread::yield();
+      }
+    }
+    ::_exit(0);
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    std::optional<int> val;
+    while (!(val = consumer.try_pop())) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(*val, i);
+  }
+  EXPECT_EQ(wait_child(pid), 0);
+  ::shm_unlink(name.c_str());
+}
+
+TEST(ShmRegionTest, FailedCreateNamedUnlinks) {
+  const std::string name = "/adam_shmq_fail_" + std::to_string(::getpid());
+  // too large for off_t, so ftruncate fails after the object was created
+  EXPECT_THROW(ShmRegion::create_named(name, SIZE_MAX), std::system_error);
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  EXPECT_LT(fd, 0);
+  if (fd >= 0) {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+  }
+}
+
+TEST(ShmMPMCQueueTest, NonConFillToCapacity) {
+  auto queue = ShmMPMCQueue<int>::create(
+      ShmRegion::create_memfd("mpmc", ShmMPMCQueue<int>::bytes_required(8)),
+      8);
+
+  EXPECT_FALSE(queue.try_pop().has_value());
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(queue.try_push(i));
+  }
+  EXPECT_FALSE(queue.try_push(999));
+
+  for (int i = 0; i < 8; ++i) {
+    auto val = queue.try_pop();
+    ASSERT_TRUE(val.has_value());
+    EXPECT_EQ(*val, i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShmMPMCQueueTest, MultiThreadedProducersConsumers) {
+  constexpr int NUM_PRODUCERS = 4;
+  constexpr int NUM_CONSUMERS = 4;
+  constexpr uint64_t PER_PRODUCER = 20000;
+  auto queue = ShmMPMCQueue<uint64_t>::create(
+      ShmRegion::create_memfd("mpmc",
+                              ShmMPMCQueue<uint64_t>::bytes_required(64)),
+      64);
+
+  std::atomic<uint64_t> consumed{0};
+  std::atomic<uint64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < NUM_PRODUCERS; ++p) {
+    threads.emplace_back([&]() {
+      for (uint64_t i = 1; i <= PER_PRODUCER; ++i) {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < NUM_CONSUMERS; ++c) {
+    threads.emplace_back([&]() {
+      while (consumed.load() < NUM_PRODUCERS * PER_PRODUCER) {
+        if (auto val = queue.try_pop()) {
+          sum.fetch_add(*val);
+          consumed.fetch_add(1);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(consumed.load(), NUM_PRODUCERS * PER_PRODUCER);
+  EXPECT_EQ(sum.load(), NUM_PRODUCERS * PER_PRODUCER * (PER_PRODUCER + 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShmMPMCQueueTest, CrossProcessProducers) {
+  constexpr uint32_t NUM_CHILDREN = 3;
+  constexpr uint64_t PER_CHILD = 20000;
+  ShmRegion region = ShmRegion::create_memfd(
+      "mpmc", ShmMPMCQueue<Message>::bytes_required(128));
+  int child_fd = region.fd();
+  auto consumer = ShmMPMCQueue<Message>::create(std::move(region), 128);
+
+  std::vector<pid_t> children;
+  for (uint32_t c = 0; c < NUM_CHILDREN; ++c) {
+    pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      auto producer =
+          ShmMPMCQueue<Message>::attach(ShmRegion::from_fd(::dup(child_fd)));
+      for (uint64_t i = 0; i < PER_CHILD; ++i) {
+        Message msg{i, c, checksum_of(i, c)};
+        while (!producer.try_push(msg)) {
+          std::this_thread::yield();
+        }
+      }
+      ::_exit(0);
+    }
+    children.push_back(pid);
+  }
+
+  std::vector<uint64_t> next(NUM_CHILDREN, 0);
+  uint64_t received = 0;
+  while (received < NUM_CHILDREN * PER_CHILD) {
+    auto msg = consumer.try_pop();
+    if (!msg) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_LT(msg->producer, NUM_CHILDREN);
+    // per producer FIFO order is preserved
+    ASSERT_EQ(msg->sequence, next[msg->producer]);
+    ASSERT_EQ(msg->checksum, checksum_of(msg->sequence, msg->producer));
+    ++next[msg->producer];
+    ++received;
+  }
+  for (pid_t pid : children) {
+    EXPECT_EQ(wait_child(pid), 0);
+  }
+  EXPECT_TRUE(consumer.empty());
+}
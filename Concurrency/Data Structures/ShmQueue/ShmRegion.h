@@ -0,0 +1,185 @@
+#ifndef SHMREGION_H_
+#define SHMREGION_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+/**
+ * RAII owner of a shared memory mapping. The backing object is either an
+ * anonymous memfd (shared with a child through fork or fd passing) or a
+ * named POSIX shm object that unrelated processes can open by name.
+ *
+ * All setup goes through syscalls, but once the region is mapped the queues
+ * built on top of it only touch memory.
+ */
+class ShmRegion {
+ public:
+  ShmRegion() = default;
+
+  /**
+   * Creates an anonymous memfd of the given size and maps it shared
+   *
+   * ARGS:
+   * name: debug name shown in /proc/<pid>/fd
+   * bytes: size of the region
+   *
+   * THROWS:
+   * std::system_error if any of the syscalls fail
+   */
+  static ShmRegion create_memfd(const std::string& name, size_t bytes) {
+    int fd = ::memfd_create(name.c_str(), MFD_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "memfd_create");
+    }
+    return map_new(fd, bytes);
+  }
+
+  /**
+   * Creates (or truncates) a named POSIX shm object and maps it shared
+   *
+   * ARGS:
+   * name: shm name, must start with '/'
+   * bytes: size of the region
+   *
+   * THROWS:
+   * std::system_error if any of the syscalls fail
+   */
+  static ShmRegion create_named(const std::string& name, size_t bytes) {
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "shm_open");
+    }
+    ShmRegion region;
+    try {
+      region = map_new(fd, bytes);
+    } catch (...) {
+      // map_new closed fd, but the object would otherwise stay in /dev/shm
+      ::shm_unlink(name.c_str());
+      throw;
+    }
+    region.name_ = name;
+    return region;
+  }
+
+  /**
+   * Opens an existing named POSIX shm object and maps its full size
+   *
+   * THROWS:
+   * std::system_error if the object does not exist or cannot be mapped
+   */
+  static ShmRegion open_named(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "shm_open");
+    }
+    return map_existing(fd);
+  }
+
+  /**
+   * Maps an already open fd (e.g. a memfd received over a unix socket).
+   * Takes ownership of fd.
+   */
+  static ShmRegion from_fd(int fd) { return map_existing(fd); }
+
+  ShmRegion(const ShmRegion& other) = delete;
+  ShmRegion& operator=(const ShmRegion& other) = delete;
+
+  ShmRegion(ShmRegion&& other) noexcept
+      : fd_(std::exchange(other.fd_, -1)),
+        base_(std::exchange(other.base_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        name_(std::move(other.name_)) {}
+
+  ShmRegion& operator=(ShmRegion&& other) noexcept {
+    if (this != &other) {
+      reset();
+      fd_ = std::exchange(other.fd_, -1);
+      base_ = std::exchange(other.base_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      name_ = std::move(other.name_);
+    }
+    return *this;
+  }
+
+  /**
+   * Unmaps the region and closes the fd. Named objects are not unlinked so
+   * the peer process can still open them, call unlink() for that.
+   */
+  ~ShmRegion() { reset(); }
+
+  /**
+   * Removes the name of a named shm object, the memory lives on until every
+   * mapping is gone
+   */
+  void unlink() {
+    if (!name_.empty()) {
+      ::shm_unlink(name_.c_str());
+      name_.clear();
+    }
+  }
+
+  void* data() const { return base_; }
+  size_t size() const { return size_; }
+  int fd() const { return fd_; }
+
+ private:
+  ShmRegion(int fd, void* base, size_t size)
+      : fd_(fd), base_(base), size_(size) {}
+
+  static ShmRegion map_new(int fd, size_t bytes) {
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "ftruncate");
+    }
+    return map_fd(fd, bytes);
+  }
+
+  static ShmRegion map_existing(int fd) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "fstat");
+    }
+    return map_fd(fd, static_cast<size_t>(st.st_size));
+  }
+
+  static ShmRegion map_fd(int fd, size_t bytes) {
+    void* base =
+        ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "mmap");
+    }
+    return ShmRegion(fd, base, bytes);
+  }
+
+  void reset() {
+    if (base_ != nullptr) {
+      ::munmap(base_, size_);
+      base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    size_ = 0;
+  }
+
+  int fd_ = -1;
+  void* base_ = nullptr;
+  size_t size_ = 0;
+  std::string name_;
+};
+
+#endif  // SHMREGION_H_
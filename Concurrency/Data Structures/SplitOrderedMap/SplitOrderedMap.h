@@ -0,0 +1,446 @@
+#ifndef SPLIT_ORDERED_MAP_H_
+#define SPLIT_ORDERED_MAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "../../../Data Structures/HashTable/XXHash.h"
+#include "../utils/HazardPointer/HazardPointer.h"
+
+// Lock-free hash map on split-ordered lists (Shalev & Shavit).
+//
+// Every element lives in one lock-free sorted linked list (Michael's list
+// with marked next pointers), ordered by the bit reversal of its hash. In
+// that order the elements of bucket b, for any power-of-two bucket count, form
+// a contiguous run, so a bucket is just a pointer to a sentinel node where its
+// run starts. Doubling the bucket count never moves an element: new buckets
+// are initialized lazily, the first time they are used, by splicing their
+// sentinel into the list after the sentinel of their parent bucket.
+//
+// Bucket pointers live in segments that are allocated on demand, so the table
+// also grows without ever copying the bucket array.
+//
+// Sentinels are never removed. Data nodes are reclaimed through the process
+// wide HazardDomain, a traversal holds prev, curr and next in three slots.
+template <typename K, typename V>
+class SplitOrderedMap {
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+
+  // average elements per bucket before the bucket count doubles
+  static constexpr size_type MAX_LOAD = 2;
+
+  SplitOrderedMap();
+
+  /**
+   * Frees every node still linked, retired nodes belong to the hazard domain
+   *
+   * REQUIRES:
+   * no other thread is using the map
+   */
+  ~SplitOrderedMap();
+
+  SplitOrderedMap(const SplitOrderedMap&) = delete;
+  SplitOrderedMap& operator=(const SplitOrderedMap&) = delete;
+
+  /**
+   * Adds the key-value pair, if the key already exists nothing happens
+   *
+   * RETURNS:
+   * true if the pair was inserted
+   */
+  bool insert(const key_type& key, const value_type& value);
+
+  /**
+   * Removes the element with the specified key
+   *
+   * RETURNS:
+   * true if this call removed it
+   */
+  bool erase(const key_type& key);
+
+  /**
+   * Looks up key, never blocks
+   *
+   * RETURNS:
+   * a copy of the value, or std::nullopt if the key does not exist
+   */
+  std::optional<value_type> find(const key_type& key);
+
+  /**
+   * RETURNS:
+   * true if key is in the map, else false
+   */
+  bool contains(const key_type& key) { return find(key).has_value(); }
+
+  /**
+   * Number of elements, exact only while no operation is in flight
+   */
+  size_type size() const { return count_.load(std::memory_order_relaxed); }
+
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Current number of logical buckets
+   */
+  size_type bucket_count() const {
+    return bucket_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Node {
+    explicit Node(uint64_t so_key) : so_key(so_key) {}
+
+    // bit reversed hash, odd for data nodes and even for sentinels
+    const uint64_t so_key;
+    // low bit set once the node is logically deleted
+    std::atomic<Node*> next{nullptr};
+  };
+
+  struct DataNode : Node {
+    DataNode(uint64_t so_key, const key_type& key, const value_type& value)
+        : Node(so_key), key(key), value(value) {}
+
+    const key_type key;
+    // never written after the node is published, so readers copy it freely
+    const value_type value;
+  };
+
+  // the last traversal's position, curr is the first node not before the key
+  struct Position {
+    std::atomic<Node*>* prev;
+    Node* curr;
+    Node* next;
+  };
+
+  static constexpr size_t NEXT_SLOT = 0;
+  static constexpr size_t CURR_SLOT = 1;
+  static constexpr size_t PREV_SLOT = 2;
+
+  // segment 0 holds buckets [0, FIRST_SEGMENT_SIZE), segment s > 0 holds
+  // [FIRST_SEGMENT_SIZE << (s - 1), FIRST_SEGMENT_SIZE << s)
+  static constexpr size_t FIRST_SEGMENT_BITS = 4;
+  static constexpr size_t FIRST_SEGMENT_SIZE = size_t{1} << FIRST_SEGMENT_BITS;
+  static constexpr size_t MAX_SEGMENTS = 40;
+  static constexpr size_type MAX_BUCKETS = FIRST_SEGMENT_SIZE
+                                           << (MAX_SEGMENTS - 1);
+
+  static bool is_marked(Node* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) & 1;
+  }
+  static Node* marked(Node* ptr) {
+    return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(ptr) | 1);
+  }
+  static Node* unmarked(Node* ptr) {
+    return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(ptr) &
+                                   ~uintptr_t{1});
+  }
+
+  static uint64_t reverse_bits(uint64_t x);
+
+  // XXHash mixes every input bit into the low bits that pick a bucket
+  static uint64_t hash_of(const key_type& key) {
+    return static_cast<uint64_t>(XXHash<key_type>{}(key));
+  }
+
+  static uint64_t data_key(uint64_t hash) { return reverse_bits(hash) | 1; }
+  static uint64_t sentinel_key(size_type bucket) {
+    return reverse_bits(bucket);
+  }
+
+  /**
+   * Helper function that returns the bucket slot, allocating its segment if
+   * this is the first bucket used in it
+   */
+  std::atomic<Node*>& bucket_slot(size_type bucket);
+
+  /**
+   * Helper function that returns the sentinel of the bucket hash falls in,
+   * initializing the bucket first if needed
+   */
+  Node* bucket_head(uint64_t hash);
+
+  void initialize_bucket(size_type bucket);
+
+  /**
+   * Helper function that walks the list from head looking for so_key (and
+   * key for data nodes), unlinking and retiring marked nodes on the way.
+   * On return pos.curr and pos.next are protected by hazard slots and
+   * pos.prev lies in head or in a node protected by a third slot.
+   *
+   * ARGS:
+   * key: nullptr when looking for a sentinel
+   *
+   * RETURNS:
+   * true if pos.curr is the node being looked for
+   */
+  bool search(Node* head, uint64_t so_key, const key_type* key, Position& pos);
+
+  void release_all() {
+    domain_.release(NEXT_SLOT);
+    domain_.release(CURR_SLOT);
+    domain_.release(PREV_SLOT);
+  }
+
+  HazardDomain& domain_;
+  std::atomic<std::atomic<Node*>*> segments_[MAX_SEGMENTS] = {};
+  alignas(std::hardware_constructive_interference_size)
+      std::atomic<size_type> bucket_count_{FIRST_SEGMENT_SIZE};
+  alignas(std::hardware_constructive_interference_size)
+      std::atomic<size_type> count_{0};
+};
+
+template <typename K, typename V>
+SplitOrderedMap<K, V>::SplitOrderedMap() : domain_(HazardDomain::global()) {
+  bucket_slot(0).store(new Node(sentinel_key(0)), std::memory_order_release);
+}
+
+template <typename K, typename V>
+SplitOrderedMap<K, V>::~SplitOrderedMap() {
+  // every node, sentinel or not, is reachable from bucket 0
+  Node* curr = segments_[0].load(std::memory_order_relaxed)[0].load(
+      std::memory_order_relaxed);
+  while (curr != nullptr) {
+    Node* next = unmarked(curr->next.load(std::memory_order_relaxed));
+    if (curr->so_key & 1) {
+      delete static_cast<DataNode*>(curr);
+    } else {
+      delete curr;
+    }
+    curr = next;
+  }
+  for (auto& segment : segments_) {
+    delete[] segment.load(std::memory_order_relaxed);
+  }
+}
+
+template <typename K, typename V>
+uint64_t SplitOrderedMap<K, V>::reverse_bits(uint64_t x) {
+  x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+  x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+  x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+  x = ((x >> 8) & 0x00FF00FF00FF00FFull) | ((x & 0x00FF00FF00FF00FFull) << 8);
+  x = ((x >> 16) & 0x0000FFFF0000FFFFull) |
+      ((x & 0x0000FFFF0000FFFFull) << 16);
+  return (x >> 32) | (x << 32);
+}
+
+template <typename K, typename V>
+std::atomic<typename SplitOrderedMap<K, V>::Node*>&
+SplitOrderedMap<K, V>::bucket_slot(size_type bucket) {
+  size_t segment = 0;
+  size_t offset = bucket;
+  size_t segment_size = FIRST_SEGMENT_SIZE;
+  if (bucket >= FIRST_SEGMENT_SIZE) {
+    size_t high_bit = 63 - __builtin_clzll(bucket);
+    segment = high_bit - FIRST_SEGMENT_BITS + 1;
+    offset = bucket - (size_t{1} << high_bit);
+    segment_size = size_t{1} << high_bit;
+  }
+  std::atomic<Node*>* buckets =
+      segments_[segment].load(std::memory_order_acquire);
+  if (buckets == nullptr) {
+    auto* fresh = new std::atomic<Node*>[segment_size]();
+    if (segments_[segment].compare_exchange_strong(
+            buckets, fresh, std::memory_order_acq_rel,
+            std::memory_order_acquire)) {
+      buckets = fresh;
+    } else {
+      delete[] fresh;
+    }
+  }
+  return buckets[offset];
+}
+
+template <typename K, typename V>
+typename SplitOrderedMap<K, V>::Node* SplitOrderedMap<K, V>::bucket_head(
+    uint64_t hash) {
+  size_type bucket = hash & (bucket_count_.load(std::memory_order_acquire) - 1);
+  std::atomic<Node*>& slot = bucket_slot(bucket);
+  Node* head = slot.load(std::memory_order_acquire);
+  if (head == nullptr) {
+    initialize_bucket(bucket);
+    head = slot.load(std::memory_order_acquire);
+  }
+  return head;
+}
+
+template <typename K, typename V>
+void SplitOrderedMap<K, V>::initialize_bucket(size_type bucket) {
+  // the parent is the bucket this one split from, clear its top bit
+  size_type parent =
+      bucket & ~(size_type{1} << (63 - __builtin_clzll(bucket)));
+  std::atomic<Node*>& parent_slot = bucket_slot(parent);
+  if (parent_slot.load(std::memory_order_acquire) == nullptr) {
+    initialize_bucket(parent);
+  }
+  Node* parent_head = parent_slot.load(std::memory_order_acquire);
+
+  uint64_t so_key = sentinel_key(bucket);
+  Node* sentinel = new Node(so_key);
+  Position pos;
+  while (true) {
+    if (search(parent_head, so_key, nullptr, pos)) {
+      // another thread spliced it in first
+      delete sentinel;
+      sentinel = pos.curr;
+      break;
+    }
+    sentinel->next.store(pos.curr, std::memory_order_relaxed);
+    if (pos.prev->compare_exchange_strong(pos.curr, sentinel,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  release_all();
+  bucket_slot(bucket).store(sentinel, std::memory_order_release);
+}
+
+template <typename K, typename V>
+bool SplitOrderedMap<K, V>::search(Node* head, uint64_t so_key,
+                                   const key_type* key, Position& pos) {
+try_again:
+  // the three slots rotate as the window moves, so every step publishes one
+  // hazard pointer instead of re-publishing the whole window
+  size_t prev_slot = PREV_SLOT;
+  size_t curr_slot = CURR_SLOT;
+  size_t next_slot = NEXT_SLOT;
+  pos.prev = &head->next;
+  pos.curr = pos.prev->load(std::memory_order_acquire);
+  domain_.protect(pos.curr, curr_slot);
+  if (pos.prev->load(std::memory_order_acquire) != pos.curr) {
+    goto try_again;
+  }
+  while (true) {
+    if (pos.curr == nullptr) {
+      return false;
+    }
+    Node* next = pos.curr->next.load(std::memory_order_acquire);
+    domain_.protect(unmarked(next), next_slot);
+    if (pos.curr->next.load(std::memory_order_acquire) != next) {
+      goto try_again;
+    }
+    // curr is still linked after next was published, so next was reachable
+    // while protected
+    if (pos.prev->load(std::memory_order_acquire) != pos.curr) {
+      goto try_again;
+    }
+    pos.next = unmarked(next);
+    if (is_marked(next)) {
+      // logically deleted, help unlink it
+      Node* expected = pos.curr;
+      if (!pos.prev->compare_exchange_strong(expected, pos.next,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+        goto try_again;
+      }
+      domain_.retire(static_cast<DataNode*>(pos.curr));
+      std::swap(curr_slot, next_slot);
+    } else {
+      uint64_t curr_key = pos.curr->so_key;
+      if (curr_key > so_key) {
+        return false;
+      }
+      if (curr_key == so_key &&
+          (key == nullptr || static_cast<DataNode*>(pos.curr)->key == *key)) {
+        return true;
+      }
+      // curr becomes the owner of prev and stays protected by its slot
+      pos.prev = &pos.curr->next;
+      size_t free_slot = prev_slot;
+      prev_slot = curr_slot;
+      curr_slot = next_slot;
+      next_slot = free_slot;
+    }
+    pos.curr = pos.next;
+  }
+}
+
+template <typename K, typename V>
+bool SplitOrderedMap<K, V>::insert(const key_type& key,
+                                   const value_type& value) {
+  uint64_t hash = hash_of(key);
+  Node* head = bucket_head(hash);
+  auto* node = new DataNode(data_key(hash), key, value);
+  Position pos;
+  while (true) {
+    if (search(head, node->so_key, &key, pos)) {
+      release_all();
+      delete node;
+      return false;
+    }
+    node->next.store(pos.curr, std::memory_order_relaxed);
+    if (pos.prev->compare_exchange_strong(pos.curr, node,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  release_all();
+
+  size_type count = count_.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_type buckets = bucket_count_.load(std::memory_order_relaxed);
+  if (count > buckets * MAX_LOAD && buckets < MAX_BUCKETS) {
+    // losing this CAS means someone else already doubled it
+    bucket_count_.compare_exchange_strong(buckets, buckets * 2,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed);
+  }
+  return true;
+}
+
+template <typename K, typename V>
+bool SplitOrderedMap<K, V>::erase(const key_type& key) {
+  uint64_t hash = hash_of(key);
+  Node* head = bucket_head(hash);
+  uint64_t so_key = data_key(hash);
+  Position pos;
+  while (true) {
+    if (!search(head, so_key, &key, pos)) {
+      release_all();
+      return false;
+    }
+    // the mark is the linearization point, whoever sets it owns the erase
+    Node* next = pos.next;
+    if (!pos.curr->next.compare_exchange_strong(next, marked(next),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+      continue;
+    }
+    Node* expected = pos.curr;
+    if (pos.prev->compare_exchange_strong(expected, pos.next,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+      domain_.retire(static_cast<DataNode*>(pos.curr));
+    } else {
+      // let a search do the unlinking
+      search(head, so_key, &key, pos);
+    }
+    break;
+  }
+  release_all();
+  count_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename K, typename V>
+std::optional<V> SplitOrderedMap<K, V>::find(const key_type& key) {
+  uint64_t hash = hash_of(key);
+  Node* head = bucket_head(hash);
+  Position pos;
+  std::optional<value_type> res;
+  if (search(head, data_key(hash), &key, pos)) {
+    res.emplace(static_cast<DataNode*>(pos.curr)->value);
+  }
+  release_all();
+  return res;
+}
+
+#endif  // SPLIT_ORDERED_MAP_H_
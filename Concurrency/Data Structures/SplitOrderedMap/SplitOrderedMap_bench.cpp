@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <optional>
+
+#include "../../../Data Structures/HashTable/HashTable.h"
+#include "SplitOrderedMap.h"
+
+// Lock-free split-ordered map against a HashTable behind one mutex, on a
+// read-heavy mix (90% find, 5% insert, 5% erase) over a fixed key space.
+
+class MutexHashTable {
+ public:
+  std::optional<int> find(int key) {
+    std::lock_guard lock(mtx_);
+    auto* node = table_.find(key);
+    return node ? std::optional<int>(node->value) : std::nullopt;
+  }
+
+  bool insert(int key, int value) {
+    std::lock_guard lock(mtx_);
+    size_t before = table_.size();
+    table_.insert(key, value);
+    return table_.size() != before;
+  }
+
+  bool erase(int key) {
+    std::lock_guard lock(mtx_);
+    size_t before = table_.size();
+    table_.erase(key);
+    return table_.size() != before;
+  }
+
+ private:
+  std::mutex mtx_;
+  HashTable<int, int> table_;
+};
+
+constexpr int NUM_KEYS = 1 << 14;
+
+template <typename Map>
+static void BM_ReadHeavy(benchmark::State& state) {
+  static Map* map = nullptr;
+  if (state.thread_index() == 0) {
+    map = new Map();
+    for (int key = 0; key < NUM_KEYS; key += 2) {
+      map->insert(key, key);
+    }
+  }
+  uint32_t rng = state.thread_index() * 7919 + 1;
+  for (auto _ : state) {
+    rng = rng * 1664525u + 1013904223u;
+    int key = static_cast<int>((rng >> 8) % NUM_KEYS);
+    uint32_t op = (rng >> 2) % 20;
+    if (op == 0) {
+      benchmark::DoNotOptimize(map->insert(key, key));
+    } else if (op == 1) {
+      benchmark::DoNotOptimize(map->erase(key));
+    } else {
+      benchmark::DoNotOptimize(map->find(key));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete map;
+    map = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_ReadHeavy, MutexHashTable)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadHeavy, SplitOrderedMap<int, int>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SplitOrderedMap.h"
+
+// Basic operations
+TEST(SplitOrderedMap, InsertFind) {
+  SplitOrderedMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.insert(1, "one"));
+  EXPECT_FALSE(map.insert(1, "uno"));
+  EXPECT_EQ(map.find(1), "one");
+  EXPECT_EQ(map.find(2), std::nullopt);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(SplitOrderedMap, Erase) {
+  SplitOrderedMap<int, int> map;
+  map.insert(5, 50);
+  map.insert(6, 60);
+  EXPECT_TRUE(map.erase(5));
+  EXPECT_FALSE(map.erase(5));
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_EQ(map.find(6), 60);
+  EXPECT_EQ(map.size(), 1u);
+  // a key can come back after it was erased
+  EXPECT_TRUE(map.insert(5, 55));
+  EXPECT_EQ(map.find(5), 55);
+}
+
+TEST(SplitOrderedMap, StringKeys) {
+  SplitOrderedMap<std::string, int> map;
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(map.insert("key" + std::to_string(i), i));
+  }
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_EQ(map.find("key" + std::to_string(i)), i);
+  }
+  EXPECT_FALSE(map.contains("key200"));
+}
+
+// Buckets split as the map grows, elements never move
+TEST(SplitOrderedMap, GrowsWithoutLosingElements) {
+  SplitOrderedMap<int, int> map;
+  size_t initial_buckets = map.bucket_count();
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_TRUE(map.insert(i, -i));
+  }
+  EXPECT_GT(map.bucket_count(), initial_buckets * 64);
+  EXPECT_LE(map.size(), map.bucket_count() * decltype(map)::MAX_LOAD);
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_EQ(map.find(i), -i);
+  }
+  for (int i = 0; i < 20000; i += 2) {
+    ASSERT_TRUE(map.erase(i));
+  }
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_EQ(map.contains(i), i % 2 == 1);
+  }
+  EXPECT_EQ(map.size(), 10000u);
+}
+
+// Concurrency tests
+TEST(SplitOrderedMap, ConcurrentDisjointInserts) {
+  SplitOrderedMap<int, int> map;
+  const int num_threads = 4;
+  const int per_thread = 3000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, t, per_thread]() {
+      for (int i = 0; i < per_thread; ++i) {
+        int key = t * per_thread + i;
+        map.insert(key, key);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(map.size(), static_cast<size_t>(num_threads * per_thread));
+  for (int key = 0; key < num_threads * per_thread; ++key) {
+    ASSERT_EQ(map.find(key), key);
+  }
+}
+
+TEST(SplitOrderedMap, ConcurrentInsertEraseSameKeys) {
+  SplitOrderedMap<int, int> map;
+  const int num_threads = 4;
+  const int num_keys = 64;
+  const int rounds = 2000;
+  std::atomic<int> inserted{0};
+  std::atomic<int> erased{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < rounds; ++i) {
+        int key = (i * 7 + t) % num_keys;
+        if (map.insert(key, key)) {
+          ++inserted;
+        }
+        if (auto val = map.find(key)) {
+          EXPECT_EQ(*val, key);
+        }
+        if (map.erase((key + 1) % num_keys)) {
+          ++erased;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // every key was inserted and erased alternately, the rest is still there
+  size_t remaining = 0;
+  for (int key = 0; key < num_keys; ++key) {
+    remaining += map.contains(key);
+  }
+  EXPECT_EQ(static_cast<size_t>(inserted - erased), remaining);
+  EXPECT_EQ(map.size(), remaining);
+}
+
+TEST(SplitOrderedMap, ReadersDuringGrowth) {
+  SplitOrderedMap<int, int> map;
+  const int stable_keys = 256;
+  for (int key = 0; key < stable_keys; ++key) {
+    map.insert(key, key);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<bool> missing{false};
+
+  std::thread writer([&]() {
+    for (int key = stable_keys; key < stable_keys + 20000; ++key) {
+      map.insert(key, key);
+      if (key % 3 == 0) {
+        map.erase(key);
+      }
+    }
+    done = true;
+  });
+  std::thread reader([&]() {
+    while (!done) {
+      for (int key = 0; key < stable_keys; ++key) {
+        if (map.find(key) != key) {
+          missing = true;
+        }
+      }
+    }
+  });
+  writer.join();
+  reader.join();
+
+  EXPECT_FALSE(missing);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,412 @@
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Epoch based reclamation domain for nodes of type T (Fraser's EBR).
+ *
+ * Readers pin the current global epoch for the duration of a critical
+ * section (enter() returns a Guard) and can then dereference any node they
+ * reach with plain loads, unlike hazard pointers which need a publish and a
+ * re-validate per pointer.
+ *
+ * retire() tags a node with the global epoch at the time it was unlinked and
+ * parks it in one of the calling thread's three limbo lists. The global epoch
+ * only moves from e to e + 1 once every thread inside a critical section has
+ * announced e, so when it reaches tag + 2 no reader can still hold the node
+ * and the list is freed.
+ *
+ * The price is that one stalled reader holds back reclamation for everyone.
+ *
+ * Like HazardPointer, a thread's record is cached in thread local storage
+ * after its first enter() and handed back when the thread exits. Limbo lists
+ * stay with the record, so whatever a departing thread could not free yet is
+ * inherited by the next thread to take the record, or freed with the domain.
+ */
+template <typename T>
+class EpochReclaimer {
+ private:
+  struct Record;
+
+ public:
+  class Guard;
+
+  /**
+   * ARGS:
+   * max_threads: number of thread records allocated up front, more are added
+   *              if needed
+   */
+  explicit EpochReclaimer(size_t max_threads);
+
+  /**
+   * Frees every node still in limbo.
+   *
+   * REQUIRES:
+   * no thread is inside a critical section of this domain
+   */
+  ~EpochReclaimer();
+
+  EpochReclaimer(const EpochReclaimer&) = delete;
+  EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+  /**
+   * Enters a critical section, nodes reached before the guard is destroyed
+   * stay valid. Nested guards on the same thread are allowed.
+   */
+  Guard enter();
+
+  /**
+   * Hands an already unlinked node over for deferred deletion
+   */
+  void retire(T* ptr);
+
+  /**
+   * Current global epoch
+   */
+  uint64_t epoch() const {
+    return registry_->global_epoch.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Number of nodes the calling thread has waiting in limbo for this domain
+   */
+  size_t get_retired_count();
+
+  /**
+   * RAII critical section, see enter()
+   */
+  class Guard {
+   public:
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    Guard(Guard&& other) noexcept
+        : record_(std::exchange(other.record_, nullptr)) {}
+
+    Guard& operator=(Guard&& other) noexcept {
+      if (this != &other) {
+        reset();
+        record_ = std::exchange(other.record_, nullptr);
+      }
+      return *this;
+    }
+
+    ~Guard() { reset(); }
+
+    /**
+     * Leaves the critical section early
+     */
+    void reset() {
+      if (record_ != nullptr) {
+        exit_critical(record_);
+        record_ = nullptr;
+      }
+    }
+
+   private:
+    friend class EpochReclaimer;
+
+    explicit Guard(Record* record) : record_(record) {}
+
+    Record* record_;
+  };
+
+ private:
+  static constexpr size_t LIMBO_LISTS = 3;
+  static constexpr uint64_t ACTIVE = 1;
+
+  struct alignas(std::hardware_constructive_interference_size) Record {
+    std::atomic<bool> in_use{false};
+    // (epoch << 1) | ACTIVE while inside a critical section
+    std::atomic<uint64_t> state{0};
+    // everything below is only touched by the owning thread
+    size_t nesting = 0;
+    std::vector<T*> limbo[LIMBO_LISTS];
+    uint64_t limbo_epoch[LIMBO_LISTS] = {};
+    size_t retired_since_advance = 0;
+
+    void free_limbo(size_t idx) {
+      for (T* ptr : limbo[idx]) {
+        delete ptr;
+      }
+      limbo[idx].clear();
+    }
+  };
+
+  struct RecordBlock {
+    explicit RecordBlock(size_t num_records)
+        : size(num_records), records(new Record[num_records]) {}
+
+    size_t size;
+    std::unique_ptr<Record[]> records;
+    std::atomic<RecordBlock*> next{nullptr};
+  };
+
+  struct Registry {
+    explicit Registry(size_t block_size)
+        : block_size(block_size), total_records(block_size), head(block_size) {}
+
+    ~Registry() {
+      for (RecordBlock* block = &head; block != nullptr;) {
+        for (size_t i = 0; i < block->size; ++i) {
+          for (size_t l = 0; l < LIMBO_LISTS; ++l) {
+            block->records[i].free_limbo(l);
+          }
+        }
+        RecordBlock* next = block->next.load();
+        if (block != &head) {
+          delete block;
+        }
+        block = next;
+      }
+    }
+
+    Record* acquire();
+
+    const size_t block_size;
+    std::atomic<size_t> total_records;
+    alignas(std::hardware_constructive_interference_size)
+        std::atomic<uint64_t> global_epoch{LIMBO_LISTS};
+    RecordBlock head;
+  };
+
+  struct CachedRecord {
+    std::shared_ptr<Registry> registry;
+    Record* record;
+  };
+
+  struct ThreadLocalData {
+    std::vector<CachedRecord> records;
+    const Registry* last_registry = nullptr;
+    Record* last_record = nullptr;
+
+    ~ThreadLocalData() {
+      for (CachedRecord& cached : records) {
+        cached.record->nesting = 0;
+        cached.record->state.store(0, std::memory_order_release);
+        cached.record->in_use.store(false, std::memory_order_release);
+      }
+    }
+  };
+  static thread_local ThreadLocalData thread_data_;
+
+  std::shared_ptr<Registry> registry_;
+
+  Record* local_record();
+  Record* register_thread();
+  static void exit_critical(Record* record);
+  bool try_advance();
+  void free_expired(Record* record);
+};
+
+template <typename T>
+thread_local typename EpochReclaimer<T>::ThreadLocalData
+    EpochReclaimer<T>::thread_data_;
+
+template <typename T>
+EpochReclaimer<T>::EpochReclaimer(size_t max_threads) {
+  if (max_threads == 0) {
+    throw std::invalid_argument("EpochReclaimer needs at least one thread");
+  }
+  registry_ = std::make_shared<Registry>(max_threads);
+}
+
+template <typename T>
+EpochReclaimer<T>::~EpochReclaimer() {
+  // threads may keep the registry alive past this point, but nothing will
+  // ever be retired into it again
+  for (RecordBlock* block = &registry_->head; block != nullptr;
+       block = block->next.load()) {
+    for (size_t i = 0; i < block->size; ++i) {
+      for (size_t l = 0; l < LIMBO_LISTS; ++l) {
+        block->records[i].free_limbo(l);
+      }
+    }
+  }
+}
+
+template <typename T>
+typename EpochReclaimer<T>::Record* EpochReclaimer<T>::Registry::acquire() {
+  RecordBlock* block = &head;
+  while (true) {
+    for (size_t i = 0; i < block->size; ++i) {
+      Record& record = block->records[i];
+      bool expected = false;
+      if (!record.in_use.load(std::memory_order_relaxed) &&
+          record.in_use.compare_exchange_strong(expected, true,
+                                                std::memory_order_acquire)) {
+        return &record;
+      }
+    }
+    RecordBlock* next = block->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      auto* fresh = new RecordBlock(block_size);
+      if (block->next.compare_exchange_strong(next, fresh,
+                                              std::memory_order_acq_rel)) {
+        total_records.fetch_add(block_size, std::memory_order_relaxed);
+        next = fresh;
+      } else {
+        delete fresh;
+      }
+    }
+    block = next;
+  }
+}
+
+template <typename T>
+typename EpochReclaimer<T>::Record* EpochReclaimer<T>::local_record() {
+  ThreadLocalData& data = thread_data_;
+  if (data.last_registry == registry_.get()) {
+    return data.last_record;
+  }
+  for (CachedRecord& cached : data.records) {
+    if (cached.registry == registry_) {
+      data.last_registry = cached.registry.get();
+      data.last_record = cached.record;
+      return cached.record;
+    }
+  }
+  return register_thread();
+}
+
+template <typename T>
+typename EpochReclaimer<T>::Record* EpochReclaimer<T>::register_thread() {
+  ThreadLocalData& data = thread_data_;
+  auto dead = std::remove_if(
+      data.records.begin(), data.records.end(), [](CachedRecord& cached) {
+        if (cached.registry.use_count() == 1) {
+          cached.record->in_use.store(false, std::memory_order_release);
+          return true;
+        }
+        return false;
+      });
+  data.records.erase(dead, data.records.end());
+
+  Record* record = registry_->acquire();
+  data.records.push_back(CachedRecord{registry_, record});
+  data.last_registry = registry_.get();
+  data.last_record = record;
+  return record;
+}
+
+template <typename T>
+typename EpochReclaimer<T>::Guard EpochReclaimer<T>::enter() {
+  Record* record = local_record();
+  if (record->nesting++ == 0) {
+    uint64_t epoch = registry_->global_epoch.load(std::memory_order_relaxed);
+    // seq_cst so the announcement is visible before any pointer we load
+    record->state.store((epoch << 1) | ACTIVE, std::memory_order_seq_cst);
+  }
+  return Guard(record);
+}
+
+template <typename T>
+void EpochReclaimer<T>::exit_critical(Record* record) {
+  if (--record->nesting == 0) {
+    uint64_t state = record->state.load(std::memory_order_relaxed);
+    record->state.store(state & ~ACTIVE, std::memory_order_release);
+  }
+}
+
+template <typename T>
+void EpochReclaimer<T>::retire(T* ptr) {
+  Record* record = local_record();
+  uint64_t epoch = registry_->global_epoch.load(std::memory_order_seq_cst);
+  size_t idx = epoch % LIMBO_LISTS;
+  if (record->limbo_epoch[idx] != epoch) {
+    // the list was filled at least three epochs ago
+    record->free_limbo(idx);
+    record->limbo_epoch[idx] = epoch;
+  }
+  record->limbo[idx].push_back(ptr);
+
+  // try to move the epoch along about once per record in the domain
+  if (++record->retired_since_advance >=
+      registry_->total_records.load(std::memory_order_relaxed)) {
+    record->retired_since_advance = 0;
+    try_advance();
+    free_expired(record);
+  }
+}
+
+template <typename T>
+bool EpochReclaimer<T>::try_advance() {
+  uint64_t epoch = registry_->global_epoch.load(std::memory_order_seq_cst);
+  for (RecordBlock* block = &registry_->head; block != nullptr;
+       block = block->next.load(std::memory_order_acquire)) {
+    for (size_t i = 0; i < block->size; ++i) {
+      uint64_t state = block->records[i].state.load(std::memory_order_seq_cst);
+      if ((state & ACTIVE) && (state >> 1) != epoch) {
+        return false;
+      }
+    }
+  }
+  return registry_->global_epoch.compare_exchange_strong(
+      epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+template <typename T>
+void EpochReclaimer<T>::free_expired(Record* record) {
+  uint64_t epoch = registry_->global_epoch.load(std::memory_order_acquire);
+  for (size_t idx = 0; idx < LIMBO_LISTS; ++idx) {
+    if (!record->limbo[idx].empty() && record->limbo_epoch[idx] + 2 <= epoch) {
+      record->free_limbo(idx);
+    }
+  }
+}
+
+template <typename T>
+size_t EpochReclaimer<T>::get_retired_count() {
+  Record* record = local_record();
+  size_t count = 0;
+  for (size_t idx = 0; idx < LIMBO_LISTS; ++idx) {
+    count += record->limbo[idx].size();
+  }
+  return count;
+}
+
+/**
+ * Reclamation policy that plugs EpochReclaimer into LFStack and MPMCQueue,
+ * see HazardPointerReclamation in HazardPointer.h for the interface. A guard
+ * is one critical section and protect() is a plain acquire load.
+ */
+struct EpochReclamation {
+  template <typename Node>
+  class Domain {
+   public:
+    class Guard {
+     public:
+      Node* protect(const std::atomic<Node*>& src) {
+        return src.load(std::memory_order_acquire);
+      }
+
+      void reset() { guard_.reset(); }
+
+     private:
+      friend class Domain;
+      explicit Guard(typename EpochReclaimer<Node>::Guard guard)
+          : guard_(std::move(guard)) {}
+
+      typename EpochReclaimer<Node>::Guard guard_;
+    };
+
+    explicit Domain(size_t max_threads) : ebr_(max_threads) {}
+
+    Guard guard() { return Guard(ebr_.enter()); }
+
+    void retire(Node* node) { ebr_.retire(node); }
+
+   private:
+    EpochReclaimer<Node> ebr_;
+  };
+};
+
+#endif  // EPOCH_RECLAIMER_H
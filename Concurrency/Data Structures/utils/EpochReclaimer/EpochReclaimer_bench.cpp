@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+
+#include "../HazardPointer/HazardPointer.h"
+#include "EpochReclaimer.h"
+
+// Read path of the two reclamation policies. Every iteration opens a guard,
+// protects a shared pointer and reads through it, which is what a lookup in a
+// read-mostly structure does. Hazard pointers pay a seq_cst store and a
+// reload per protect, epochs pay one announcement per guard.
+//
+// BM_ReadMostly adds a writer (thread 0) that swaps and retires the node, so
+// reclamation runs while the readers are measured.
+
+struct BenchNode {
+  long value;
+};
+
+template <typename Reclaim>
+static void BM_Read(benchmark::State& state) {
+  static typename Reclaim::template Domain<BenchNode>* domain = nullptr;
+  static std::atomic<BenchNode*> shared{nullptr};
+  if (state.thread_index() == 0) {
+    domain = new typename Reclaim::template Domain<BenchNode>(8);
+    shared.store(new BenchNode{1});
+  }
+  for (auto _ : state) {
+    auto guard = domain->guard();
+    BenchNode* node = guard.protect(shared);
+    benchmark::DoNotOptimize(node->value);
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete shared.exchange(nullptr);
+    delete domain;
+    domain = nullptr;
+  }
+}
+
+// several reads per guard, the pattern of a traversal
+template <typename Reclaim>
+static void BM_ReadBatch(benchmark::State& state) {
+  static typename Reclaim::template Domain<BenchNode>* domain = nullptr;
+  static std::atomic<BenchNode*> shared{nullptr};
+  if (state.thread_index() == 0) {
+    domain = new typename Reclaim::template Domain<BenchNode>(8);
+    shared.store(new BenchNode{1});
+  }
+  const int reads = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto guard = domain->guard();
+    for (int i = 0; i < reads; ++i) {
+      BenchNode* node = guard.protect(shared);
+      benchmark::DoNotOptimize(node->value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * reads);
+  if (state.thread_index() == 0) {
+    delete shared.exchange(nullptr);
+    delete domain;
+    domain = nullptr;
+  }
+}
+
+template <typename Reclaim>
+static void BM_ReadMostly(benchmark::State& state) {
+  static typename Reclaim::template Domain<BenchNode>* domain = nullptr;
+  static std::atomic<BenchNode*> shared{nullptr};
+  if (state.thread_index() == 0) {
+    domain = new typename Reclaim::template Domain<BenchNode>(8);
+    shared.store(new BenchNode{1});
+  }
+  long writes = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      domain->retire(shared.exchange(new BenchNode{++writes}));
+    } else {
+      auto guard = domain->guard();
+      BenchNode* node = guard.protect(shared);
+      benchmark::DoNotOptimize(node->value);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete shared.exchange(nullptr);
+    delete domain;
+    domain = nullptr;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_Read, HazardPointerReclamation)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Read, EpochReclamation)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadBatch, HazardPointerReclamation)->Arg(16);
+BENCHMARK_TEMPLATE(BM_ReadBatch, EpochReclamation)->Arg(16);
+BENCHMARK_TEMPLATE(BM_ReadMostly, HazardPointerReclamation)
+    ->ThreadRange(2, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadMostly, EpochReclamation)
+    ->ThreadRange(2, 8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "EpochReclaimer.h"
+
+struct CountedNode {
+  int value;
+  CountedNode* next = nullptr;
+  static std::atomic<int> destroyed;
+  explicit CountedNode(int v) : value(v) {}
+  ~CountedNode() { destroyed.fetch_add(1, std::memory_order_relaxed); }
+};
+
+std::atomic<int> CountedNode::destroyed{0};
+
+template class EpochReclaimer<CountedNode>;
+
+TEST(EpochReclaimerTest, RejectsZeroThreads) {
+  EXPECT_THROW(EpochReclaimer<CountedNode>(0), std::invalid_argument);
+}
+
+TEST(EpochReclaimerTest, EnterExit) {
+  EpochReclaimer<CountedNode> ebr(1);
+  {
+    auto guard = ebr.enter();
+    auto nested = ebr.enter();
+  }
+  auto guard = ebr.enter();
+  guard.reset();
+  guard.reset();
+}
+
+TEST(EpochReclaimerTest, RetiredNodesFreedOnceEpochMoves) {
+  CountedNode::destroyed = 0;
+  EpochReclaimer<CountedNode> ebr(1);
+  uint64_t start = ebr.epoch();
+
+  // with one record an advance is attempted on every retire
+  for (int i = 0; i < 10; ++i) {
+    ebr.retire(new CountedNode(i));
+  }
+  EXPECT_GT(ebr.epoch(), start);
+  EXPECT_GT(CountedNode::destroyed.load(), 0);
+  EXPECT_LT(ebr.get_retired_count(), 10u);
+}
+
+TEST(EpochReclaimerTest, ActiveReaderHoldsBackReclamation) {
+  CountedNode::destroyed = 0;
+  EpochReclaimer<CountedNode> ebr(2);
+
+  std::atomic<CountedNode*> shared{new CountedNode(7)};
+  std::atomic<bool> pinned{false};
+  std::atomic<bool> unpin{false};
+  std::atomic<int> seen{0};
+
+  std::thread reader([&]() {
+    auto guard = ebr.enter();
+    CountedNode* node = shared.load();
+    pinned = true;
+    while (!unpin.load()) {
+      std::this_thread::yield();
+    }
+    seen = node->value;
+  });
+  while (!pinned.load()) {
+    std::this_thread::yield();
+  }
+
+  ebr.retire(shared.exchange(nullptr));
+  for (int i = 0; i < 100; ++i) {
+    ebr.retire(new CountedNode(i));
+  }
+  // the epoch can move at most once past the reader
+  EXPECT_EQ(CountedNode::destroyed.load(), 0);
+
+  unpin = true;
+  reader.join();
+  EXPECT_EQ(seen.load(), 7);
+
+  for (int i = 0; i < 10; ++i) {
+    ebr.retire(new CountedNode(i));
+  }
+  EXPECT_GT(CountedNode::destroyed.load(), 0);
+}
+
+TEST(EpochReclaimerTest, DestructorFreesLimbo) {
+  CountedNode::destroyed = 0;
+  {
+    EpochReclaimer<CountedNode> ebr(4);
+    auto guard = ebr.enter();
+    for (int i = 0; i < 3; ++i) {
+      ebr.retire(new CountedNode(i));
+    }
+    guard.reset();
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 3);
+}
+
+TEST(EpochReclaimerTest, ExitedThreadLeavesLimboToDomain) {
+  CountedNode::destroyed = 0;
+  {
+    EpochReclaimer<CountedNode> ebr(4);
+    std::thread worker([&]() {
+      for (int i = 0; i < 3; ++i) {
+        ebr.retire(new CountedNode(i));
+      }
+    });
+    worker.join();
+    EXPECT_EQ(CountedNode::destroyed.load(), 0);
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 3);
+}
+
+TEST(EpochReclaimerTest, GrowsPastMaxThreads) {
+  EpochReclaimer<CountedNode> ebr(1);
+  std::atomic<int> inside{0};
+  std::atomic<bool> release{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      auto guard = ebr.enter();
+      inside.fetch_add(1);
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  while (inside.load() < 4) {
+    std::this_thread::yield();
+  }
+  release = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(EpochReclaimerTest, ConcurrentReadersAndRetirers) {
+  CountedNode::destroyed = 0;
+  constexpr int NUM_READERS = 3;
+  constexpr int NUM_WRITERS = 2;
+  constexpr int SWAPS_PER_WRITER = 5000;
+  {
+    EpochReclaimer<CountedNode> ebr(NUM_READERS + NUM_WRITERS);
+    std::atomic<CountedNode*> shared{new CountedNode(0)};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> corrupted{false};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < NUM_READERS; ++r) {
+      readers.emplace_back([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+          auto guard = ebr.enter();
+          CountedNode* node = shared.load(std::memory_order_acquire);
+          if (node->value < 0) {
+            corrupted = true;
+          }
+        }
+      });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < NUM_WRITERS; ++w) {
+      writers.emplace_back([&]() {
+        for (int i = 1; i <= SWAPS_PER_WRITER; ++i) {
+          CountedNode* old = shared.exchange(new CountedNode(i));
+          ebr.retire(old);
+        }
+      });
+    }
+    for (auto& thread : writers) {
+      thread.join();
+    }
+    stop = true;
+    for (auto& thread : readers) {
+      thread.join();
+    }
+    delete shared.load();
+    EXPECT_FALSE(corrupted.load());
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(),
+            NUM_WRITERS * SWAPS_PER_WRITER + 1);
+}
+
+TEST(EpochReclamationPolicyTest, GuardProtectsAndRetires) {
+  CountedNode::destroyed = 0;
+  {
+    EpochReclamation::Domain<CountedNode> domain(1);
+    std::atomic<CountedNode*> src{new CountedNode(5)};
+    auto guard = domain.guard();
+    CountedNode* node = guard.protect(src);
+    ASSERT_EQ(node, src.load());
+    EXPECT_EQ(node->value, 5);
+    guard.reset();
+    domain.retire(src.exchange(nullptr));
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 1);
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -3,155 +3,546 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <thread>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
-static const auto MAX_THREADS = std::thread::hardware_concurrency();
-
-template <typename T>
-class HazardPointer {
+/**
+ * Type erased hazard pointer domain.
+ *
+ * A thread registers with a domain the first time it touches it and is given
+ * a record of slots_per_thread hazard slots plus a private retire list. The
+ * record is cached in thread local storage, so protect/release after that are
+ * a single store into the thread's own slot. Slots hold void*, and every
+ * retired node carries its own deleter, so any number of structures with
+ * different node types can share one domain (see global()).
+ *
+ * Records live in blocks of max_threads. If more threads than that are alive
+ * at once a new block is appended instead of failing.
+ *
+ * Retired nodes are reclaimed in batches: once a thread's retire list reaches
+ * twice the number of hazard slots in the domain, it snapshots every slot into
+ * a sorted array, frees whatever is not in it and compacts the survivors in
+ * place. At most one node per slot can survive, so every scan frees at least
+ * half the list and the cost per retire stays constant apart from the
+ * O(log slots) probe.
+ *
+ * When a thread exits it scans one last time and pushes whatever is still
+ * protected onto the domain's orphan list. The next scan by any thread adopts
+ * the whole orphan list into its own retire list, so thread churn does not
+ * leak. Orphans are taken with a single exchange, never popped one by one, so
+ * the list has no ABA problem.
+ */
+class HazardDomain {
  public:
-  explicit HazardPointer(size_t max_threads);
-  ~HazardPointer();
+  using Deleter = void (*)(void*);
 
-  HazardPointer(const HazardPointer&) = delete;
-  HazardPointer& operator=(const HazardPointer&) = delete;
+  /**
+   * ARGS:
+   * max_threads: number of thread records allocated up front
+   * slots_per_thread: hazard slots each thread gets, traversals that hold
+   *                   prev/curr/next at once need more than one
+   *
+   * THROWS:
+   * std::invalid_argument if either is 0
+   */
+  explicit HazardDomain(size_t max_threads, size_t slots_per_thread = 1);
+
+  /**
+   * Frees the calling thread's retire list and the orphan list right away.
+   * Lists of other threads that are still alive are freed when they exit.
+   *
+   * REQUIRES:
+   * no thread still protects or retires through this domain
+   */
+  ~HazardDomain();
+
+  HazardDomain(const HazardDomain&) = delete;
+  HazardDomain& operator=(const HazardDomain&) = delete;
+
+  /**
+   * Process wide domain with GLOBAL_SLOTS_PER_THREAD slots per thread. It is
+   * never destroyed, so threads may keep using it during static destruction.
+   */
+  static HazardDomain& global();
+
+  static constexpr size_t GLOBAL_INITIAL_THREADS = 64;
+  static constexpr size_t GLOBAL_SLOTS_PER_THREAD = 4;
+
+  /**
+   * Publishes ptr in the calling thread's slot, the caller still has to
+   * re-validate that ptr is reachable afterwards
+   *
+   * REQUIRES:
+   * slot < slots_per_thread
+   */
+  void protect(const void* ptr, size_t slot = 0);
+
+  /**
+   * Clears the calling thread's slot
+   */
+  void release(size_t slot = 0);
+
+  /**
+   * Defers deleter(ptr) until no thread protects ptr
+   */
+  void retire(void* ptr, Deleter deleter);
+
+  template <typename T>
+  void retire(T* ptr) {
+    retire(static_cast<void*>(ptr), &delete_as<T>);
+  }
 
-  void protect(T* ptr);
-  void release();
-  void retire(T* ptr);
+  /**
+   * Number of nodes waiting in the calling thread's retire list
+   */
+  size_t get_retired_count();
 
-  size_t get_retired_count() const { return thread_data_.retire_list.size(); }
+  /**
+   * Number of nodes left behind by exited threads that nobody adopted yet
+   */
+  size_t get_orphan_count() const;
+
+  size_t slots_per_thread() const { return registry_->slots_per_thread; }
 
  private:
-  struct HPRecord {
-    std::atomic<T*> ptr{nullptr};
-    std::atomic<std::thread::id> owner{};
+  struct Retired {
+    void* ptr;
+    Deleter deleter;
   };
 
-  // Use unique_ptr array since atomics aren't movable
-  std::unique_ptr<HPRecord[]> hazard_pointers_;
+  template <typename T>
+  static void delete_as(void* ptr) {
+    delete static_cast<T*>(ptr);
+  }
+
+  static void free_all(std::vector<Retired>& list) {
+    for (const Retired& node : list) {
+      node.deleter(node.ptr);
+    }
+    list.clear();
+  }
+
+  struct alignas(std::hardware_constructive_interference_size) HPRecord {
+    std::atomic<bool> active{false};
+    std::atomic<const void*>* hazards = nullptr;  // slots_per_thread entries
+    // only touched by the thread that holds the record
+    std::vector<Retired> retire_list;
+  };
+
+  struct RecordBlock {
+    RecordBlock(size_t num_records, size_t slots_per_thread)
+        : size(num_records),
+          records(new HPRecord[num_records]),
+          hazards(new std::atomic<const void*>[num_records *
+                                               slots_per_thread]()) {
+      for (size_t i = 0; i < num_records; ++i) {
+        records[i].hazards = &hazards[i * slots_per_thread];
+      }
+    }
+
+    size_t size;
+    std::unique_ptr<HPRecord[]> records;
+    std::unique_ptr<std::atomic<const void*>[]> hazards;
+    std::atomic<RecordBlock*> next{nullptr};
+  };
+
+  // retire list of an exited thread, waiting to be adopted
+  struct OrphanBatch {
+    std::vector<Retired> nodes;
+    OrphanBatch* next = nullptr;
+  };
+
+  // Owns every record of one domain. Shared with the threads that hold a
+  // record, so a thread that outlives the domain can still hand its record
+  // back on exit, and whatever it leaves behind is freed with the last
+  // reference.
+  struct Registry {
+    Registry(size_t block_size, size_t slots_per_thread)
+        : slots_per_thread(slots_per_thread),
+          block_size(block_size),
+          total_records(block_size),
+          head(block_size, slots_per_thread) {}
+
+    ~Registry() {
+      free_orphans();
+      for (RecordBlock* block = &head; block != nullptr;) {
+        for (size_t i = 0; i < block->size; ++i) {
+          free_all(block->records[i].retire_list);
+        }
+        RecordBlock* next = block->next.load();
+        if (block != &head) {
+          delete block;
+        }
+        block = next;
+      }
+    }
+
+    HPRecord* acquire();
+    void push_orphans(std::vector<Retired>&& nodes);
+    OrphanBatch* take_orphans();
+    void free_orphans();
+
+    const size_t slots_per_thread;
+    const size_t block_size;
+    std::atomic<size_t> total_records;
+    std::atomic<OrphanBatch*> orphans{nullptr};
+    RecordBlock head;
+  };
+
+  // one per (thread, domain) pair
+  struct CachedRecord {
+    std::shared_ptr<Registry> registry;
+    HPRecord* record;
+  };
 
   struct ThreadLocalData {
-    std::vector<T*> retire_list;
+    // reused by every scan so reclamation never allocates in steady state
+    std::vector<const void*> protected_snapshot;
+    std::vector<CachedRecord> records;
+    // last domain this thread touched, the common case is a thread working
+    // on a single structure
+    const Registry* last_registry = nullptr;
+    HPRecord* last_record = nullptr;
+
+    ~ThreadLocalData() {
+      for (CachedRecord& cached : records) {
+        release_record(cached.registry.get(), cached.record);
+      }
+    }
   };
   static thread_local ThreadLocalData thread_data_;
 
-  size_t max_threads_;
-  size_t retire_threshold_;
+  std::shared_ptr<Registry> registry_;
 
-  size_t acquire_slot();
-  std::unordered_set<T*> get_protected_pointers();
-  void scan_and_free();
+  HPRecord* local_record();
+  HPRecord* register_thread();
+  static void release_record(Registry* registry, HPRecord* record);
+  static void scan_and_free(Registry* registry, HPRecord* record);
 };
 
-template <typename T>
-thread_local
-    typename HazardPointer<T>::ThreadLocalData HazardPointer<T>::thread_data_;
+inline thread_local HazardDomain::ThreadLocalData HazardDomain::thread_data_;
 
-template <typename T>
-HazardPointer<T>::HazardPointer(size_t num_threads) {
-  if (MAX_THREADS == 0 || num_threads < MAX_THREADS) {
-    max_threads_ = num_threads;
-  } else {
-    max_threads_ = MAX_THREADS;
+inline HazardDomain::HazardDomain(size_t max_threads,
+                                  size_t slots_per_thread) {
+  if (max_threads == 0 || slots_per_thread == 0) {
+    throw std::invalid_argument(
+        "HazardPointer needs at least one thread and one slot");
   }
-  retire_threshold_ = 2 * max_threads_;
-
-  // Allocate array directly - no resize needed
-  hazard_pointers_ = std::make_unique<HPRecord[]>(max_threads_);
+  registry_ = std::make_shared<Registry>(max_threads, slots_per_thread);
 }
 
-template <typename T>
-HazardPointer<T>::~HazardPointer() {
-  // Clean up any remaining retired pointers in this thread's list
-  for (auto* ptr : thread_data_.retire_list) {
-    delete ptr;
+inline HazardDomain::~HazardDomain() {
+  for (CachedRecord& cached : thread_data_.records) {
+    if (cached.registry == registry_) {
+      free_all(cached.record->retire_list);
+    }
   }
-  thread_data_.retire_list.clear();
+  registry_->free_orphans();
 }
 
-template <typename T>
-size_t HazardPointer<T>::acquire_slot() {
-  auto this_id = std::this_thread::get_id();
+inline HazardDomain& HazardDomain::global() {
+  static HazardDomain* domain =
+      new HazardDomain(GLOBAL_INITIAL_THREADS, GLOBAL_SLOTS_PER_THREAD);
+  return *domain;
+}
 
-  // First pass: check if we already own a slot
-  for (size_t i = 0; i < max_threads_; ++i) {
-    if (hazard_pointers_[i].owner.load(std::memory_order_relaxed) == this_id) {
-      return i;
+inline HazardDomain::HPRecord* HazardDomain::Registry::acquire() {
+  RecordBlock* block = &head;
+  while (true) {
+    for (size_t i = 0; i < block->size; ++i) {
+      HPRecord& record = block->records[i];
+      bool expected = false;
+      if (!record.active.load(std::memory_order_relaxed) &&
+          record.active.compare_exchange_strong(expected, true,
+                                                std::memory_order_acquire)) {
+        return &record;
+      }
     }
+    RecordBlock* next = block->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      // every record is taken, append a new block
+      auto* fresh = new RecordBlock(block_size, slots_per_thread);
+      if (block->next.compare_exchange_strong(next, fresh,
+                                              std::memory_order_acq_rel)) {
+        total_records.fetch_add(block_size, std::memory_order_relaxed);
+        next = fresh;
+      } else {
+        delete fresh;
+      }
+    }
+    block = next;
   }
+}
 
-  // Second pass: try to acquire an empty slot
-  for (size_t i = 0; i < max_threads_; ++i) {
-    std::thread::id expected{};
-    if (hazard_pointers_[i].owner.compare_exchange_strong(
-            expected, this_id, std::memory_order_acq_rel)) {
-      return i;
+inline void HazardDomain::Registry::push_orphans(std::vector<Retired>&& nodes) {
+  auto* batch = new OrphanBatch{std::move(nodes), nullptr};
+  batch->next = orphans.load(std::memory_order_relaxed);
+  while (!orphans.compare_exchange_weak(batch->next, batch,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+inline HazardDomain::OrphanBatch* HazardDomain::Registry::take_orphans() {
+  if (orphans.load(std::memory_order_relaxed) == nullptr) {
+    return nullptr;
+  }
+  return orphans.exchange(nullptr, std::memory_order_acquire);
+}
+
+inline void HazardDomain::Registry::free_orphans() {
+  OrphanBatch* batch = take_orphans();
+  while (batch != nullptr) {
+    OrphanBatch* next = batch->next;
+    free_all(batch->nodes);
+    delete batch;
+    batch = next;
+  }
+}
+
+inline HazardDomain::HPRecord* HazardDomain::local_record() {
+  ThreadLocalData& data = thread_data_;
+  if (data.last_registry == registry_.get()) {
+    return data.last_record;
+  }
+  for (CachedRecord& cached : data.records) {
+    if (cached.registry == registry_) {
+      data.last_registry = cached.registry.get();
+      data.last_record = cached.record;
+      return cached.record;
     }
   }
+  return register_thread();
+}
 
-  // No slots available
-  throw std::runtime_error("No hazard pointer slots available");
+inline HazardDomain::HPRecord* HazardDomain::register_thread() {
+  ThreadLocalData& data = thread_data_;
+  // drop records of domains that were destroyed while we held on to them
+  auto dead = std::remove_if(
+      data.records.begin(), data.records.end(), [](CachedRecord& cached) {
+        if (cached.registry.use_count() == 1) {
+          release_record(cached.registry.get(), cached.record);
+          return true;
+        }
+        return false;
+      });
+  data.records.erase(dead, data.records.end());
+
+  HPRecord* record = registry_->acquire();
+  data.records.push_back(CachedRecord{registry_, record});
+  data.last_registry = registry_.get();
+  data.last_record = record;
+  return record;
 }
 
-template <typename T>
-void HazardPointer<T>::protect(T* ptr) {
-  size_t idx = acquire_slot();
-  hazard_pointers_[idx].ptr.store(ptr, std::memory_order_release);
+inline void HazardDomain::release_record(Registry* registry,
+                                         HPRecord* record) {
+  for (size_t i = 0; i < registry->slots_per_thread; ++i) {
+    record->hazards[i].store(nullptr, std::memory_order_release);
+  }
+  if (!record->retire_list.empty()) {
+    scan_and_free(registry, record);
+  }
+  if (!record->retire_list.empty()) {
+    registry->push_orphans(std::move(record->retire_list));
+    record->retire_list = std::vector<Retired>();
+  }
+  record->active.store(false, std::memory_order_release);
 }
 
-template <typename T>
-void HazardPointer<T>::release() {
-  auto this_id = std::this_thread::get_id();
+inline void HazardDomain::protect(const void* ptr, size_t slot) {
+  assert(slot < registry_->slots_per_thread);
+  // seq_cst so the store is visible before the caller re-reads the source
+  local_record()->hazards[slot].store(ptr, std::memory_order_seq_cst);
+}
 
-  for (size_t i = 0; i < max_threads_; ++i) {
-    if (hazard_pointers_[i].owner.load(std::memory_order_relaxed) == this_id) {
-      hazard_pointers_[i].ptr.store(nullptr, std::memory_order_release);
-      return;
-    }
+inline void HazardDomain::release(size_t slot) {
+  assert(slot < registry_->slots_per_thread);
+  local_record()->hazards[slot].store(nullptr, std::memory_order_release);
+}
+
+inline void HazardDomain::retire(void* ptr, Deleter deleter) {
+  HPRecord* record = local_record();
+  record->retire_list.push_back(Retired{ptr, deleter});
+
+  // grows with the domain as records are added
+  size_t threshold = 2 *
+                     registry_->total_records.load(std::memory_order_relaxed) *
+                     registry_->slots_per_thread;
+  if (record->retire_list.size() >= threshold) {
+    scan_and_free(registry_.get(), record);
   }
 }
 
-template <typename T>
-void HazardPointer<T>::retire(T* ptr) {
-  thread_data_.retire_list.push_back(ptr);
+inline size_t HazardDomain::get_retired_count() {
+  return local_record()->retire_list.size();
+}
 
-  if (thread_data_.retire_list.size() >= retire_threshold_) {
-    scan_and_free();
+inline size_t HazardDomain::get_orphan_count() const {
+  // only meant for tests and diagnostics, walks the list without taking it
+  size_t count = 0;
+  for (const OrphanBatch* batch =
+           registry_->orphans.load(std::memory_order_acquire);
+       batch != nullptr; batch = batch->next) {
+    count += batch->nodes.size();
   }
+  return count;
 }
 
-template <typename T>
-std::unordered_set<T*> HazardPointer<T>::get_protected_pointers() {
-  std::unordered_set<T*> protected_set;
+inline void HazardDomain::scan_and_free(Registry* registry, HPRecord* record) {
+  std::vector<Retired>& my_list = record->retire_list;
+  for (OrphanBatch* batch = registry->take_orphans(); batch != nullptr;) {
+    my_list.insert(my_list.end(), batch->nodes.begin(), batch->nodes.end());
+    OrphanBatch* next = batch->next;
+    delete batch;
+    batch = next;
+  }
 
-  for (size_t i = 0; i < max_threads_; ++i) {
-    T* ptr = hazard_pointers_[i].ptr.load(std::memory_order_acquire);
-    if (ptr != nullptr) {
-      protected_set.insert(ptr);
+  std::vector<const void*>& snapshot = thread_data_.protected_snapshot;
+  snapshot.clear();
+  const size_t slots = registry->slots_per_thread;
+  for (const RecordBlock* block = &registry->head; block != nullptr;
+       block = block->next.load(std::memory_order_acquire)) {
+    for (size_t i = 0; i < block->size * slots; ++i) {
+      const void* ptr = block->hazards[i].load(std::memory_order_seq_cst);
+      if (ptr != nullptr) {
+        snapshot.push_back(ptr);
+      }
     }
   }
-  return protected_set;
-}
+  std::sort(snapshot.begin(), snapshot.end(), std::less<const void*>());
 
-template <typename T>
-void HazardPointer<T>::scan_and_free() {
-  std::unordered_set<T*> protected_ptrs = get_protected_pointers();
-
-  auto& my_list = thread_data_.retire_list;
-  auto it = my_list.begin();
-  while (it != my_list.end()) {
-    if (protected_ptrs.find(*it) == protected_ptrs.end()) {
-      delete *it;
-      it = my_list.erase(it);
+  // keep protected nodes at the front, free the rest
+  size_t kept = 0;
+  for (size_t i = 0; i < my_list.size(); ++i) {
+    Retired node = my_list[i];
+    if (std::binary_search(snapshot.begin(), snapshot.end(), node.ptr,
+                           std::less<const void*>())) {
+      my_list[kept++] = node;
     } else {
-      ++it;
+      node.deleter(node.ptr);
     }
   }
+  my_list.resize(kept);
 }
 
+/**
+ * Typed view of a HazardDomain for nodes of type T.
+ *
+ * Constructed with a size it owns a private domain, constructed with a
+ * domain (usually HazardDomain::global()) it shares that domain's records
+ * with every other structure using it.
+ */
+template <typename T>
+class HazardPointer {
+ public:
+  /**
+   * Private domain, see HazardDomain
+   */
+  explicit HazardPointer(size_t max_threads, size_t slots_per_thread = 1)
+      : owned_(std::make_unique<HazardDomain>(max_threads, slots_per_thread)),
+        domain_(owned_.get()) {}
+
+  /**
+   * Shared domain, which must outlive this object
+   */
+  explicit HazardPointer(HazardDomain& domain) : domain_(&domain) {}
+
+  HazardPointer(const HazardPointer&) = delete;
+  HazardPointer& operator=(const HazardPointer&) = delete;
+
+  void protect(T* ptr, size_t slot = 0) { domain_->protect(ptr, slot); }
+
+  void release(size_t slot = 0) { domain_->release(slot); }
+
+  void retire(T* ptr) { domain_->retire(ptr); }
+
+  size_t get_retired_count() const { return domain_->get_retired_count(); }
+
+  size_t slots_per_thread() const { return domain_->slots_per_thread(); }
+
+  HazardDomain& domain() const { return *domain_; }
+
+ private:
+  std::unique_ptr<HazardDomain> owned_;
+  HazardDomain* domain_;
+};
+
+// Reclamation policies for LFStack and MPMCQueue. A policy provides a nested
+// Domain<Node> with
+//   Domain(size_t max_threads)
+//   Guard guard()           opens a protected region for the calling thread
+//   void retire(Node*)      defers deletion of an unlinked node
+// and Domain::Guard with
+//   Node* protect(const std::atomic<Node*>& src)
+//                           loads src so the node stays valid while the
+//                           guard is alive
+//   void reset()            drops the protection early
+// EpochReclamation lives in utils/EpochReclaimer/EpochReclaimer.h.
+
+/**
+ * Hazard pointers behind the reclamation policy interface. protect() is the
+ * usual publish and re-validate loop on slot 0, so a guard covers one node at
+ * a time. Every structure using this policy shares HazardDomain::global(),
+ * which grows on demand, so max_threads is not needed.
+ */
+struct HazardPointerReclamation {
+  template <typename Node>
+  class Domain {
+   public:
+    class Guard {
+     public:
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+
+      Guard(Guard&& other) noexcept
+          : hp_(std::exchange(other.hp_, nullptr)) {}
+
+      ~Guard() { reset(); }
+
+      Node* protect(const std::atomic<Node*>& src) {
+        Node* ptr = src.load(std::memory_order_acquire);
+        while (true) {
+          hp_->protect(ptr);
+          Node* again = src.load(std::memory_order_acquire);
+          if (again == ptr) {
+            return ptr;
+          }
+          ptr = again;
+        }
+      }
+
+      void reset() {
+        if (hp_ != nullptr) {
+          hp_->release();
+          hp_ = nullptr;
+        }
+      }
+
+     private:
+      friend class Domain;
+      explicit Guard(HazardPointer<Node>* hp) : hp_(hp) {}
+
+      HazardPointer<Node>* hp_;
+    };
+
+    explicit Domain(size_t /* max_threads */)
+        : hp_(HazardDomain::global()) {}
+
+    Guard guard() { return Guard(&hp_); }
+
+    void retire(Node* node) { hp_.retire(node); }
+
+   private:
+    HazardPointer<Node> hp_;
+  };
+};
+
 #endif  // HAZARD_POINTER_H
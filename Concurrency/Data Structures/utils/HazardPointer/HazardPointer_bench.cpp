@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "HazardPointer.h"
+
+// Retire throughput: every iteration protects a node, releases it and retires
+// it, so the cost of scan_and_free is spread across the retires that
+// triggered it. Args are (initial thread records, slots per thread).
+
+struct BenchNode {
+  long value;
+};
+
+static void BM_ProtectRetire(benchmark::State& state) {
+  static HazardPointer<BenchNode>* hp = nullptr;
+  if (state.thread_index() == 0) {
+    hp = new HazardPointer<BenchNode>(static_cast<size_t>(state.range(0)),
+                                      static_cast<size_t>(state.range(1)));
+  }
+  for (auto _ : state) {
+    auto* node = new BenchNode{state.thread_index()};
+    hp->protect(node);
+    benchmark::DoNotOptimize(node->value);
+    hp->release();
+    hp->retire(node);
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    delete hp;
+    hp = nullptr;
+  }
+}
+BENCHMARK(BM_ProtectRetire)
+    ->Args({8, 1})
+    ->Args({64, 1})
+    ->Args({64, 2})
+    ->Args({256, 2})
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// retire alone while one node stays pinned, so every scan keeps a survivor
+static void BM_RetireWithLiveHazards(benchmark::State& state) {
+  HazardPointer<BenchNode> hp(static_cast<size_t>(state.range(0)));
+  BenchNode pinned{0};
+  hp.protect(&pinned);
+  for (auto _ : state) {
+    hp.retire(new BenchNode{1});
+  }
+  hp.release();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RetireWithLiveHazards)->Arg(8)->Arg(64)->Arg(512);
+
+BENCHMARK_MAIN();
@@ -330,6 +330,300 @@ TEST(HazardPointerTest, ProtectionAcrossMultipleInstances) {
   EXPECT_EQ(hp1_retires.load() + hp2_retires.load(), num_threads * 100);
 }
 
+struct CountedNode {
+  static std::atomic<int> destroyed;
+  int value;
+  explicit CountedNode(int v) : value(v) {}
+  ~CountedNode() { destroyed.fetch_add(1, std::memory_order_relaxed); }
+};
+std::atomic<int> CountedNode::destroyed{0};
+
+TEST(HazardPointerTest, SlotsAreReusedAfterThreadExit) {
+  // far more short lived threads than records, each one must hand its record
+  // back on exit
+  HazardPointer<TestNode> hp(2);
+  TestNode node(1);
+
+  for (int i = 0; i < 50; ++i) {
+    std::thread worker([&]() {
+      hp.protect(&node);
+      hp.release();
+    });
+    worker.join();
+  }
+  SUCCEED();
+}
+
+TEST(HazardPointerTest, GrowsBeyondInitialThreadCount) {
+  const size_t num_threads = 16;
+  HazardPointer<TestNode> hp(2);
+  TestNode node(1);
+  std::atomic<size_t> holding{0};
+  std::atomic<bool> release{false};
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&]() {
+      hp.protect(&node);
+      holding.fetch_add(1);
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+      hp.release();
+    });
+  }
+  while (holding.load() < num_threads) {
+    std::this_thread::yield();
+  }
+  release.store(true);
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(holding.load(), num_threads);
+}
+
+TEST(HazardPointerTest, MultipleSlotsPerThread) {
+  CountedNode::destroyed = 0;
+  HazardPointer<CountedNode> hp(1, 3);
+  ASSERT_EQ(hp.slots_per_thread(), 3u);
+
+  auto* first = new CountedNode(1);
+  auto* second = new CountedNode(2);
+
+  std::atomic<bool> protected_both{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    hp.protect(first, 0);
+    hp.protect(second, 2);
+    protected_both.store(true);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    hp.release(0);
+    hp.release(2);
+  });
+  while (!protected_both.load()) {
+    std::this_thread::yield();
+  }
+
+  hp.retire(first);
+  hp.retire(second);
+  // the threshold is 2 * threads * slots, push enough to force scans
+  for (int i = 0; i < 20; ++i) {
+    hp.retire(new CountedNode(100 + i));
+  }
+  EXPECT_EQ(first->value, 1);
+  EXPECT_EQ(second->value, 2);
+  EXPECT_EQ(CountedNode::destroyed.load() + hp.get_retired_count(), 22);
+  EXPECT_GE(hp.get_retired_count(), 2u);
+
+  done.store(true);
+  reader.join();
+}
+
+TEST(HazardPointerTest, ExitingThreadDropsItsProtection) {
+  CountedNode::destroyed = 0;
+  HazardPointer<CountedNode> hp(1);
+  auto* node = new CountedNode(1);
+
+  std::thread reader([&]() { hp.protect(node); });
+  reader.join();
+
+  hp.retire(node);
+  for (int i = 0; i < 10; ++i) {
+    hp.retire(new CountedNode(i));
+  }
+  // every retired node, including the one the dead thread had protected,
+  // has been reclaimed
+  EXPECT_EQ(hp.get_retired_count(), 1u);
+  EXPECT_EQ(CountedNode::destroyed.load(), 10);
+}
+
+TEST(HazardPointerTest, DomainDestroyedBeforeThreadExits) {
+  std::atomic<bool> destroyed{false};
+  std::atomic<bool> registered{false};
+  auto* hp = new HazardPointer<TestNode>(1);
+  TestNode node(1);
+
+  std::thread worker([&]() {
+    hp->protect(&node);
+    hp->release();
+    registered.store(true);
+    while (!destroyed.load()) {
+      std::this_thread::yield();
+    }
+    // record cleanup on exit must not touch freed memory
+  });
+  while (!registered.load()) {
+    std::this_thread::yield();
+  }
+  delete hp;
+  destroyed.store(true);
+  worker.join();
+  SUCCEED();
+}
+
+TEST(HazardPointerTest, RetireListStaysBounded) {
+  // threshold is 2 * records * slots = 16, with nothing protected each scan
+  // empties the list
+  CountedNode::destroyed = 0;
+  HazardPointer<CountedNode> hp(4, 2);
+  for (int i = 0; i < 10000; ++i) {
+    hp.retire(new CountedNode(i));
+    ASSERT_LT(hp.get_retired_count(), 16u);
+  }
+  EXPECT_EQ(CountedNode::destroyed.load() + hp.get_retired_count(), 10000u);
+}
+
+TEST(HazardPointerTest, ScanKeepsOnlyProtectedNodes) {
+  CountedNode::destroyed = 0;
+  HazardPointer<CountedNode> hp(1, 2);
+  std::vector<CountedNode*> nodes;
+  for (int i = 0; i < 4; ++i) {
+    nodes.push_back(new CountedNode(i));
+  }
+  hp.protect(nodes[1], 0);
+  hp.protect(nodes[3], 1);
+
+  // threshold is 4, so the fourth retire triggers a scan
+  for (CountedNode* node : nodes) {
+    hp.retire(node);
+  }
+  EXPECT_EQ(hp.get_retired_count(), 2u);
+  EXPECT_EQ(CountedNode::destroyed.load(), 2);
+  EXPECT_EQ(nodes[1]->value, 1);
+  EXPECT_EQ(nodes[3]->value, 3);
+
+  hp.release(0);
+  hp.release(1);
+  for (int i = 0; i < 2; ++i) {
+    hp.retire(new CountedNode(10 + i));
+  }
+  EXPECT_EQ(hp.get_retired_count(), 0u);
+  EXPECT_EQ(CountedNode::destroyed.load(), 6);
+}
+
+TEST(HazardDomainTest, RetireAcceptsAnyTypeAndDeleter) {
+  CountedNode::destroyed = 0;
+  static std::atomic<int> custom_deleted{0};
+  custom_deleted = 0;
+  {
+    HazardDomain domain(1);
+    domain.retire(new CountedNode(1));
+    domain.retire(new TestNode(2));
+    int* raw = new int[4];
+    domain.retire(raw, [](void* ptr) {
+      delete[] static_cast<int*>(ptr);
+      custom_deleted.fetch_add(1);
+    });
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 1);
+  EXPECT_EQ(custom_deleted.load(), 1);
+}
+
+TEST(HazardDomainTest, ExitingThreadHandsProtectedNodesToOrphanList) {
+  CountedNode::destroyed = 0;
+  HazardDomain domain(2);
+  auto* pinned = new CountedNode(1);
+  std::atomic<bool> protecting{false};
+  std::atomic<bool> done{false};
+
+  std::thread reader([&]() {
+    domain.protect(pinned);
+    protecting = true;
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    domain.release();
+  });
+  while (!protecting.load()) {
+    std::this_thread::yield();
+  }
+
+  std::thread retirer([&]() {
+    domain.retire(pinned);
+    domain.retire(new CountedNode(2));
+  });
+  retirer.join();
+  // the exit scan freed what it could, the protected node was handed over
+  EXPECT_EQ(CountedNode::destroyed.load(), 1);
+  EXPECT_EQ(domain.get_orphan_count(), 1u);
+
+  done = true;
+  reader.join();
+
+  // the next scan on any thread adopts and frees it (threshold is 4)
+  for (int i = 0; i < 4; ++i) {
+    domain.retire(new CountedNode(10 + i));
+  }
+  EXPECT_EQ(domain.get_orphan_count(), 0u);
+  EXPECT_EQ(CountedNode::destroyed.load(), 6);
+  EXPECT_EQ(domain.get_retired_count(), 0u);
+}
+
+TEST(HazardDomainTest, ThreadChurnDoesNotLeak) {
+  CountedNode::destroyed = 0;
+  constexpr int NUM_THREADS = 20;
+  constexpr int RETIRES_PER_THREAD = 7;
+  {
+    HazardDomain domain(4);
+    for (int t = 0; t < NUM_THREADS; ++t) {
+      std::thread worker([&]() {
+        for (int i = 0; i < RETIRES_PER_THREAD; ++i) {
+          domain.retire(new CountedNode(i));
+        }
+      });
+      worker.join();
+    }
+    // nothing was protected, so every exit scan freed its whole list
+    EXPECT_EQ(CountedNode::destroyed.load(), NUM_THREADS * RETIRES_PER_THREAD);
+  }
+}
+
+TEST(HazardDomainTest, OrphansFreedWithDomain) {
+  CountedNode::destroyed = 0;
+  {
+    HazardDomain domain(2);
+    auto* pinned = new CountedNode(1);
+    domain.protect(pinned);
+    std::thread retirer([&]() { domain.retire(pinned); });
+    retirer.join();
+    EXPECT_EQ(domain.get_orphan_count(), 1u);
+    domain.release();
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 1);
+}
+
+TEST(HazardDomainTest, ViewsShareOneDomain) {
+  CountedNode::destroyed = 0;
+  HazardDomain domain(1, 2);
+  HazardPointer<CountedNode> counted(domain);
+  HazardPointer<TestNode> plain(domain);
+  EXPECT_EQ(counted.slots_per_thread(), 2u);
+
+  auto* node = new CountedNode(1);
+  // a protection published through one view holds for retires from the other
+  plain.protect(reinterpret_cast<TestNode*>(node), 1);
+  // threshold is 2 * 1 record * 2 slots, the fourth retire scans
+  counted.retire(node);
+  for (int i = 0; i < 3; ++i) {
+    counted.retire(new CountedNode(i));
+  }
+  EXPECT_EQ(counted.get_retired_count(), 1u);
+  EXPECT_EQ(plain.get_retired_count(), 1u);
+  plain.release(1);
+  for (int i = 0; i < 3; ++i) {
+    counted.retire(new CountedNode(i));
+  }
+  EXPECT_EQ(CountedNode::destroyed.load(), 7);
+}
+
+TEST(HazardDomainTest, GlobalDomainIsShared) {
+  HazardDomain& domain = HazardDomain::global();
+  EXPECT_EQ(&domain, &HazardDomain::global());
+  EXPECT_EQ(domain.slots_per_thread(), HazardDomain::GLOBAL_SLOTS_PER_THREAD);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
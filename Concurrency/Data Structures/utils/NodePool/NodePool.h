@@ -0,0 +1,169 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+/**
+ * Recycling allocator for fixed size nodes of lock-free structures.
+ *
+ * Every thread keeps a private free list, so allocate/deallocate are a couple
+ * of pointer moves with no atomics. When a thread's list grows past
+ * 2 * CACHE_LIMIT it hands CACHE_LIMIT nodes to a shared global list in one
+ * CAS, and a thread whose list is empty takes the entire global list with one
+ * exchange. Taking everything (instead of popping one node) means the global
+ * list never needs a CAS-pop and so cannot suffer from ABA.
+ *
+ * Nodes opt in with class specific operator new/delete:
+ *
+ *   static void* operator new(size_t) { return NodePool<Node>::allocate(); }
+ *   static void operator delete(void* p) { NodePool<Node>::deallocate(p); }
+ *
+ * Memory only goes back to the system when the process exits.
+ */
+template <typename Node>
+class NodePool {
+ public:
+  static constexpr size_t CACHE_LIMIT = 64;
+
+  static void* allocate() {
+    ThreadCache& cache = cache_;
+    if (cache.head == nullptr && !cache.closed) {
+      register_flusher(cache);
+      cache.adopt(global_.head.exchange(nullptr, std::memory_order_acquire));
+    }
+    if (cache.head != nullptr) {
+      FreeNode* node = cache.head;
+      cache.head = node->next;
+      --cache.count;
+      return node;
+    }
+    return ::operator new(BLOCK_SIZE, std::align_val_t(BLOCK_ALIGN));
+  }
+
+  static void deallocate(void* ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+    ThreadCache& cache = cache_;
+    if (cache.closed) {
+      // thread is exiting (e.g. a hazard pointer domain freeing its retire
+      // list), hand the node straight to the other threads
+      auto* node = ::new (ptr) FreeNode{nullptr};
+      push_global(node, node);
+      return;
+    }
+    register_flusher(cache);
+    cache.head = ::new (ptr) FreeNode{cache.head};
+    if (++cache.count >= 2 * CACHE_LIMIT) {
+      cache.spill(CACHE_LIMIT);
+    }
+  }
+
+  /**
+   * Number of nodes sitting in the calling thread's cache
+   */
+  static size_t cached_count() { return cache_.count; }
+
+ private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  static constexpr size_t BLOCK_SIZE =
+      sizeof(Node) > sizeof(FreeNode) ? sizeof(Node) : sizeof(FreeNode);
+  static constexpr size_t BLOCK_ALIGN =
+      alignof(Node) > alignof(FreeNode) ? alignof(Node) : alignof(FreeNode);
+
+  static void free_chain(FreeNode* node) {
+    while (node != nullptr) {
+      FreeNode* next = node->next;
+      ::operator delete(node, std::align_val_t(BLOCK_ALIGN));
+      node = next;
+    }
+  }
+
+  // pushes an already linked chain [first, last] with a single CAS
+  static void push_global(FreeNode* first, FreeNode* last) {
+    last->next = global_.head.load(std::memory_order_relaxed);
+    while (!global_.head.compare_exchange_weak(last->next, first,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+  }
+
+  struct GlobalList {
+    std::atomic<FreeNode*> head{nullptr};
+    ~GlobalList() { free_chain(head.exchange(nullptr)); }
+  };
+
+  // Trivially destructible so its storage stays valid for the whole life of
+  // the thread, including the destructors of other thread locals that free
+  // nodes. Flushing is done by CacheFlusher instead, after which the cache
+  // is closed and bypassed.
+  struct ThreadCache {
+    FreeNode* head = nullptr;
+    size_t count = 0;
+    bool registered = false;
+    bool closed = false;
+
+    void adopt(FreeNode* chain) {
+      head = chain;
+      for (FreeNode* curr = chain; curr != nullptr; curr = curr->next) {
+        ++count;
+      }
+    }
+
+    void spill(size_t n) {
+      FreeNode* first = head;
+      FreeNode* last = head;
+      for (size_t i = 1; i < n; ++i) {
+        last = last->next;
+      }
+      head = last->next;
+      count -= n;
+      push_global(first, last);
+    }
+
+  };
+
+  // a departing thread hands its nodes to the threads that remain
+  struct CacheFlusher {
+    ~CacheFlusher() {
+      ThreadCache& cache = cache_;
+      cache.closed = true;
+      if (cache.head == nullptr) {
+        return;
+      }
+      FreeNode* last = cache.head;
+      while (last->next != nullptr) {
+        last = last->next;
+      }
+      push_global(cache.head, last);
+      cache.head = nullptr;
+      cache.count = 0;
+    }
+  };
+
+  // the flusher is only constructed, and so only destroyed at thread exit,
+  // once the thread has actually used its cache
+  static void register_flusher(ThreadCache& cache) {
+    if (!cache.registered) {
+      cache.registered = true;
+      static_cast<void>(&flusher_);
+    }
+  }
+
+  static inline GlobalList global_;
+  static thread_local ThreadCache cache_;
+  static thread_local CacheFlusher flusher_;
+};
+
+template <typename Node>
+thread_local typename NodePool<Node>::ThreadCache NodePool<Node>::cache_;
+
+template <typename Node>
+thread_local typename NodePool<Node>::CacheFlusher NodePool<Node>::flusher_;
+
+#endif  // NODE_POOL_H
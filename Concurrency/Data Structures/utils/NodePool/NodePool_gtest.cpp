@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "NodePool.h"
+
+struct PoolNode {
+  long value;
+  PoolNode* next;
+};
+
+struct OtherNode {
+  char payload[48];
+};
+
+struct alignas(64) AlignedNode {
+  int value;
+};
+
+TEST(NodePoolTest, ReusesFreedBlock) {
+  void* first = NodePool<PoolNode>::allocate();
+  NodePool<PoolNode>::deallocate(first);
+  void* second = NodePool<PoolNode>::allocate();
+  EXPECT_EQ(first, second);
+  NodePool<PoolNode>::deallocate(second);
+}
+
+TEST(NodePoolTest, PoolsAreSeparatePerNodeType) {
+  void* node = NodePool<PoolNode>::allocate();
+  NodePool<PoolNode>::deallocate(node);
+  void* other = NodePool<OtherNode>::allocate();
+  EXPECT_NE(node, other);
+  NodePool<OtherNode>::deallocate(other);
+}
+
+TEST(NodePoolTest, RespectsAlignment) {
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i) {
+    blocks.push_back(NodePool<AlignedNode>::allocate());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(blocks.back()) % 64, 0u);
+  }
+  for (void* block : blocks) {
+    NodePool<AlignedNode>::deallocate(block);
+  }
+}
+
+TEST(NodePoolTest, ThreadCacheIsBounded) {
+  const size_t limit = NodePool<PoolNode>::CACHE_LIMIT;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < 4 * limit; ++i) {
+    blocks.push_back(NodePool<PoolNode>::allocate());
+  }
+  for (void* block : blocks) {
+    NodePool<PoolNode>::deallocate(block);
+  }
+  EXPECT_LT(NodePool<PoolNode>::cached_count(), 2 * limit);
+}
+
+TEST(NodePoolTest, ExitingThreadHandsNodesToOthers) {
+  std::set<void*> freed_by_worker;
+  std::thread worker([&]() {
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10; ++i) {
+      blocks.push_back(NodePool<OtherNode>::allocate());
+    }
+    for (void* block : blocks) {
+      freed_by_worker.insert(block);
+      NodePool<OtherNode>::deallocate(block);
+    }
+  });
+  worker.join();
+
+  // drain whatever this thread had cached so the next allocation has to go to
+  // the global list
+  std::vector<void*> local;
+  while (NodePool<OtherNode>::cached_count() > 0) {
+    local.push_back(NodePool<OtherNode>::allocate());
+  }
+  void* adopted = NodePool<OtherNode>::allocate();
+  EXPECT_EQ(freed_by_worker.count(adopted), 1u);
+
+  NodePool<OtherNode>::deallocate(adopted);
+  for (void* block : local) {
+    NodePool<OtherNode>::deallocate(block);
+  }
+}
+
+// stands in for a hazard pointer retire list that is freed by a thread local
+// destructor running after the pool's own cache was flushed
+struct LateFreer {
+  std::vector<void*> blocks;
+  ~LateFreer() {
+    for (void* block : blocks) {
+      NodePool<PoolNode>::deallocate(block);
+    }
+  }
+};
+
+TEST(NodePoolTest, DeallocateDuringThreadExitAfterFlush) {
+  std::set<void*> late_blocks;
+  std::thread worker([&]() {
+    // constructed before the pool is touched, so destroyed after it flushed
+    thread_local LateFreer late;
+    for (int i = 0; i < 200; ++i) {
+      late.blocks.push_back(NodePool<PoolNode>::allocate());
+    }
+    for (int i = 0; i < 100; ++i) {
+      NodePool<PoolNode>::deallocate(late.blocks.back());
+      late.blocks.pop_back();
+    }
+    late_blocks.insert(late.blocks.begin(), late.blocks.end());
+  });
+  worker.join();
+
+  // every block must come back exactly once
+  std::vector<void*> local;
+  std::set<void*> seen;
+  size_t found = 0;
+  for (int i = 0; i < 1000; ++i) {
+    void* block = NodePool<PoolNode>::allocate();
+    ASSERT_TRUE(seen.insert(block).second);
+    found += late_blocks.count(block);
+    local.push_back(block);
+  }
+  EXPECT_EQ(found, late_blocks.size());
+  for (void* block : local) {
+    NodePool<PoolNode>::deallocate(block);
+  }
+}
+
+TEST(NodePoolTest, ConcurrentAllocateDeallocate) {
+  const int num_threads = 8;
+  const int ops_per_thread = 20000;
+  std::atomic<int> overlaps{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<PoolNode*> held;
+      for (int i = 0; i < ops_per_thread; ++i) {
+        auto* node = static_cast<PoolNode*>(NodePool<PoolNode>::allocate());
+        node->value = t;
+        held.push_back(node);
+        if (held.size() == 100) {
+          for (PoolNode* n : held) {
+            if (n->value != t) {
+              overlaps.fetch_add(1);
+            }
+            NodePool<PoolNode>::deallocate(n);
+          }
+          held.clear();
+        }
+      }
+      for (PoolNode* n : held) {
+        NodePool<PoolNode>::deallocate(n);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(overlaps.load(), 0);
+}
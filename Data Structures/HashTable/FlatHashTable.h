@@ -0,0 +1,764 @@
+#ifndef FLATHASHTABLE_H_
+#define FLATHASHTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "SlotArray.h"
+#include "XXHash.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Maximum load factor before growing, linear probing still stays within a
+// couple of 16 slot groups at this load
+inline constexpr double FLAT_MAX_LOAD_FACTOR = 0.875;
+
+/**
+ * Open addressing hash table (Swiss table style) that can stand in for
+ * HashTable wherever code sticks to insert, insert_or_assign, try_emplace,
+ * emplace, erase, at, operator[], find, contains, clear, reserve and the
+ * iterators. Heterogeneous lookup, incremental rehashing and stats() exist
+ * only on HashTable.
+ *
+ * Entries sit in one flat array next to a control array with one byte per
+ * slot: EMPTY, or the low 7 bits of the entry's hash (h2) when the slot is
+ * full. A lookup starts at the slot picked by the remaining bits (h1) and
+ * compares 16 control bytes against h2 at once with SSE2 or NEON (a scalar
+ * loop elsewhere), so it only touches an entry when its h2 matches, and it
+ * stops at the first group that contains an EMPTY.
+ *
+ * Probing is linear from h1, one slot at a time in groups of 16, which lets
+ * erase() backward-shift the rest of the run into the hole instead of
+ * leaving a tombstone. The table never fills up with deleted slots, so it
+ * never has to rehash just to clean them out.
+ *
+ * The first GROUP_SIZE - 1 control bytes are mirrored after the last one so
+ * a group read near the end wraps around without a bounds check. The slots
+ * and control bytes live in a SlotArray, the storage RobinHoodTable uses too.
+ *
+ * Hash and KeyEqual work as in HashTable. Both h1 and h2 come from the hash,
+ * so Hash must spread its entropy over every bit; the default XXHash does,
+ * a plain std::hash, which is the identity for integers, does not.
+ *
+ * Unlike HashTable, inserting or erasing may move other entries, which
+ * invalidates pointers returned by find() and all iterators.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class FlatHashTable {
+ private:
+  struct Entry;
+
+  static constexpr uint8_t EMPTY = 0x80;
+  static constexpr std::size_t GROUP_SIZE = 16;
+
+  using Slots = SlotArray<Entry, EMPTY, GROUP_SIZE - 1>;
+
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using iterator = typename Slots::iterator;
+  using const_iterator = typename Slots::const_iterator;
+
+  // -- CONSTRUCTOR AND DESTRUCTOR --//
+
+  /**
+   * Constructs an empty FlatHashTable
+   */
+  FlatHashTable() : FlatHashTable(Hash()) {}
+
+  /**
+   * Constructs an empty FlatHashTable with the given hash and key equality
+   * functions
+   *
+   * ARGS:
+   * hash: hashes keys, h1 and h2 both come from its result
+   * equal: compares keys
+   */
+  explicit FlatHashTable(const Hash& hash, const KeyEqual& equal = KeyEqual());
+
+  /**
+   * Copy constructor that constructs this table with another table
+   *
+   * ARGS:
+   * other: the table that will be copied
+   */
+  FlatHashTable(const FlatHashTable& other);
+
+  /**
+   * Move Constructor that takes over the other table's slots, other is left
+   * empty without any slots until its next insert
+   *
+   * ARGS:
+   * other: the table that will be stolen from
+   */
+  FlatHashTable(FlatHashTable&& other) noexcept;
+
+  /**
+   * Destroys this table
+   */
+  ~FlatHashTable() = default;
+
+  /**
+   * Copy assignment operator
+   *
+   * ARGS:
+   * other: the table that will be copied
+   */
+  FlatHashTable& operator=(const FlatHashTable& other);
+
+  /**
+   * Move assignment operator, other is left empty
+   *
+   * ARGS:
+   * other: the table that will be stolen from
+   */
+  FlatHashTable& operator=(FlatHashTable&& other) noexcept;
+
+  // -- CAPACITY -- //
+
+  /**
+   * RETURNS:
+   * true if the table contains no elements, else false
+   */
+  bool empty() const { return num_elements_ == 0; }
+
+  /**
+   * RETURNS:
+   * the number of key-value pairs in the table
+   */
+  size_type size() const { return num_elements_; }
+
+  // -- MODIFIERS -- //
+
+  /**
+   * Removes every element. The slots stay allocated, so refilling the table
+   * to the same size does not resize again
+   */
+  void clear() {
+    slots_.clear();
+    num_elements_ = 0;
+  }
+
+  /**
+   * Adds the key-value pair into the table, if the key already exists then
+   * nothing happens
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   */
+  void insert(const key_type& key, const value_type& value);
+  void insert(key_type&& key, value_type&& value);
+
+  /**
+   * Adds the key-value pair into the table, if the key already exists then
+   * it will replace the value of the existing key
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   */
+  void insert_or_assign(const key_type& key, const value_type& value);
+  void insert_or_assign(key_type&& key, value_type&& value);
+
+  /**
+   * Constructs the value in place from args if the key is not in the table
+   * yet, otherwise nothing happens and args are left untouched
+   *
+   * ARGS:
+   * key: the unique identifier of the value, moved from only on insertion
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the entry holding key, and true if it was just inserted
+   */
+  template <typename... Args>
+  std::pair<Entry*, bool> try_emplace(const key_type& key, Args&&... args) {
+    return emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<Entry*, bool> try_emplace(key_type&& key, Args&&... args) {
+    return emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Constructs the key from key_arg, then behaves as try_emplace, so the
+   * value is only built when the key turns out to be new
+   *
+   * ARGS:
+   * key_arg: forwarded to the key's constructor
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the entry holding the key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Entry*, bool> emplace(KeyArg&& key_arg, Args&&... args) {
+    return emplace_key(key_type(std::forward<KeyArg>(key_arg)),
+                       std::forward<Args>(args)...);
+  }
+
+  /**
+   * Removes the element with the specified key from the table, later
+   * entries of its probe run shift back into the hole
+   *
+   * ARGS:
+   * key: the key of the element to remove
+   */
+  void erase(const key_type& key);
+
+  // -- LOOKUP -- //
+
+  /**
+   * Accesses the value associated with the key.
+   *
+   * ARGS:
+   * key: the key to look up
+   *
+   * RETURNS:
+   * reference to the value associated with the key
+   *
+   * THROWS:
+   * std::out_of_range if key is not found
+   */
+  value_type& at(const key_type& key);
+  const value_type& at(const key_type& key) const;
+
+  /**
+   * Accesses or inserts element with the given key.
+   * If key doesn't exist, creates it with default value.
+   *
+   * ARGS:
+   * key: the key to look up or insert
+   *
+   * RETURNS:
+   * reference to the value associated with the key
+   */
+  value_type& operator[](const key_type& key);
+  const value_type& operator[](const key_type& key) const;
+
+  /**
+   * Finds the entry containing the specified key.
+   *
+   * ARGS:
+   * key: the key to search for
+   *
+   * RETURNS:
+   * pointer to the entry (with key and value members) if found, nullptr
+   * otherwise
+   */
+  Entry* find(const key_type& key);
+  const Entry* find(const key_type& key) const;
+
+  /**
+   * RETURNS:
+   * true if key is within the table, else false
+   */
+  bool contains(const key_type& key) const {
+    return find_index(key) != NOT_FOUND;
+  }
+
+  // -- HASH POLICY -- //
+
+  /**
+   * RETURNS:
+   * the load factor (elements / slots)
+   */
+  double load_factor() const {
+    return capacity() == 0 ? 0.0
+                           : static_cast<double>(num_elements_) /
+                                 static_cast<double>(capacity());
+  }
+
+  /**
+   * RETURNS:
+   * the max load factor (0.875)
+   */
+  double max_load_factor() const { return FLAT_MAX_LOAD_FACTOR; }
+
+  /**
+   * Number of slots, always a power of two (or 0 once moved from)
+   */
+  size_type capacity() const { return slots_.capacity(); }
+
+  /**
+   * Doubles the number of slots and reinserts every entry
+   */
+  void rehash() { resize(capacity() == 0 ? MIN_CAPACITY : capacity() * 2); }
+
+  /**
+   * Grows the table so that count elements stay under the max load
+   * factor. Inserting up to count elements afterwards never resizes. Never
+   * shrinks the table.
+   *
+   * ARGS:
+   * count: the number of elements the table should hold without growing
+   */
+  void reserve(size_type count);
+
+  /**
+   * RETURNS:
+   * the hash function
+   */
+  hasher hash_function() const { return hasher_; }
+
+  /**
+   * RETURNS:
+   * the key equality function
+   */
+  key_equal key_eq() const { return key_equal_; }
+
+  // -- ITERATORS -- //
+  // forward iterators over the full slots
+  iterator begin() { return slots_.begin(); }
+  const_iterator begin() const { return slots_.begin(); }
+  const_iterator cbegin() const { return begin(); }
+
+  iterator end() { return slots_.end(); }
+  const_iterator end() const { return slots_.end(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  struct Entry {
+    key_type key;
+    value_type value;
+
+    // the tag keeps this from standing in for the copy and move
+    // constructors
+    template <typename KeyArg, typename... Args>
+    Entry(std::in_place_t, KeyArg&& key, Args&&... args)
+        : key(std::forward<KeyArg>(key)), value(std::forward<Args>(args)...) {}
+  };
+
+  static constexpr size_type MIN_CAPACITY = GROUP_SIZE;
+  static constexpr size_type NOT_FOUND = static_cast<size_type>(-1);
+
+  /**
+   * Bits of a 16 byte control group that matched, iterated lowest first.
+   * NEON produces 4 bits per byte, so SHIFT maps a bit back to a slot.
+   */
+  class BitMask {
+   public:
+    explicit BitMask(uint64_t bits) : bits_(bits) {}
+
+    explicit operator bool() const { return bits_ != 0; }
+
+    size_type lowest() const {
+      return static_cast<size_type>(__builtin_ctzll(bits_)) >> SHIFT;
+    }
+
+    void clear_lowest() { bits_ &= bits_ - 1; }
+
+#if !defined(__SSE2__) && defined(__ARM_NEON)
+    static constexpr int SHIFT = 2;
+#else
+    static constexpr int SHIFT = 0;
+#endif
+
+   private:
+    uint64_t bits_;
+  };
+
+  /**
+   * 16 control bytes loaded at once
+   */
+  class Group {
+   public:
+    explicit Group(const uint8_t* ctrl) {
+#if defined(__SSE2__)
+      ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif defined(__ARM_NEON)
+      ctrl_ = vld1q_u8(ctrl);
+#else
+      std::memcpy(ctrl_, ctrl, GROUP_SIZE);
+#endif
+    }
+
+    // slots whose control byte is h2
+    BitMask match(uint8_t h2) const {
+#if defined(__SSE2__)
+      __m128i cmp =
+          _mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(static_cast<char>(h2)));
+      return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(cmp)));
+#elif defined(__ARM_NEON)
+      return from_neon(vceqq_u8(ctrl_, vdupq_n_u8(h2)));
+#else
+      uint64_t bits = 0;
+      for (size_type i = 0; i < GROUP_SIZE; ++i) {
+        bits |= static_cast<uint64_t>(ctrl_[i] == h2) << i;
+      }
+      return BitMask(bits);
+#endif
+    }
+
+    // EMPTY is the only control byte with the high bit set
+    BitMask match_empty() const {
+#if defined(__SSE2__)
+      return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_)));
+#elif defined(__ARM_NEON)
+      return from_neon(vtstq_u8(ctrl_, vdupq_n_u8(EMPTY)));
+#else
+      uint64_t bits = 0;
+      for (size_type i = 0; i < GROUP_SIZE; ++i) {
+        bits |= static_cast<uint64_t>(ctrl_[i] >> 7) << i;
+      }
+      return BitMask(bits);
+#endif
+    }
+
+   private:
+#if defined(__SSE2__)
+    __m128i ctrl_;
+#elif defined(__ARM_NEON)
+    // narrows each 0x00/0xFF byte to a nibble, keeps one bit per nibble
+    static BitMask from_neon(uint8x16_t cmp) {
+      uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+      uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+      return BitMask(bits & 0x8888888888888888ull);
+    }
+
+    uint8x16_t ctrl_;
+#else
+    uint8_t ctrl_[GROUP_SIZE];
+#endif
+  };
+
+  /**
+   * Helper function to compute hash
+   */
+  uint64_t hash(const key_type& key) const {
+    return static_cast<uint64_t>(hasher_(key));
+  }
+  static size_type h1(uint64_t hash) {
+    return static_cast<size_type>(hash >> 7);
+  }
+  static uint8_t h2(uint64_t hash) {
+    return static_cast<uint8_t>(hash & 0x7F);
+  }
+
+  /**
+   * Helper function that writes a control byte and its mirror
+   */
+  void set_ctrl(size_type index, uint8_t value) {
+    uint8_t* ctrl = slots_.meta();
+    ctrl[index] = value;
+    if (index < GROUP_SIZE - 1) {
+      ctrl[capacity() + index] = value;
+    }
+  }
+
+  /**
+   * RETURNS:
+   * slot index of key, NOT_FOUND if it is not in the table
+   */
+  size_type find_index(const key_type& key) const;
+
+  /**
+   * Helper function that constructs an entry in the first empty slot of the
+   * probe run of hash. IMPORTANT: the key must not be in the table and there
+   * must be room for it
+   */
+  template <typename... Args>
+  size_type place(uint64_t hash, Args&&... args);
+
+  /**
+   * Helper function that grows the table first if one more entry would push
+   * it past the max load factor
+   */
+  void reserve_one() {
+    if (static_cast<double>(num_elements_ + 1) >
+        static_cast<double>(capacity()) * FLAT_MAX_LOAD_FACTOR) {
+      rehash();
+    }
+  }
+
+  /**
+   * Helper function behind every insertion, the entry is only built, from
+   * key and args, if key is new
+   *
+   * RETURNS:
+   * the entry holding key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Entry*, bool> emplace_key(KeyArg&& key, Args&&... args);
+
+  void erase_at(size_type index);
+
+  void resize(size_type new_capacity);
+
+  // the control bytes are the slots' metadata, a moved from table has no
+  // slots at all
+  Slots slots_;
+  size_type num_elements_ = 0;
+  Hash hasher_;
+  KeyEqual key_equal_;
+};
+
+// ----------------------------------------------------------------------------
+// --- MEMBER FUNCTION DEFINITIONS
+// ----------------------------------------------------------------------------
+
+// -- CONSTRUCTOR AND DESTRUCTOR --//
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FlatHashTable<K, V, Hash, KeyEqual>::FlatHashTable(const Hash& hash,
+                                                   const KeyEqual& equal)
+    : slots_(MIN_CAPACITY), hasher_(hash), key_equal_(equal) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FlatHashTable<K, V, Hash, KeyEqual>::FlatHashTable(const FlatHashTable& other)
+    : slots_(other.slots_),
+      num_elements_(other.num_elements_),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FlatHashTable<K, V, Hash, KeyEqual>::FlatHashTable(
+    FlatHashTable&& other) noexcept
+    : slots_(std::move(other.slots_)),
+      num_elements_(std::exchange(other.num_elements_, 0)),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FlatHashTable<K, V, Hash, KeyEqual>&
+FlatHashTable<K, V, Hash, KeyEqual>::operator=(const FlatHashTable& other) {
+  if (this == &other) {
+    return *this;
+  }
+  slots_ = other.slots_;
+  num_elements_ = other.num_elements_;
+  hasher_ = other.hasher_;
+  key_equal_ = other.key_equal_;
+  return *this;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+FlatHashTable<K, V, Hash, KeyEqual>&
+FlatHashTable<K, V, Hash, KeyEqual>::operator=(FlatHashTable&& other) noexcept {
+  if (this != &other) {
+    slots_ = std::move(other.slots_);
+    num_elements_ = std::exchange(other.num_elements_, 0);
+    hasher_ = other.hasher_;
+    key_equal_ = other.key_equal_;
+  }
+  return *this;
+}
+
+// -- MODIFIERS -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::insert(const key_type& key,
+                                                 const value_type& value) {
+  emplace_key(key, value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::insert(key_type&& key,
+                                                 value_type&& value) {
+  emplace_key(std::move(key), std::move(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::insert_or_assign(
+    const key_type& key, const value_type& value) {
+  auto [entry, inserted] = emplace_key(key, value);
+  if (!inserted) {
+    entry->value = value;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::insert_or_assign(
+    key_type&& key, value_type&& value) {
+  // a key that is already there leaves value untouched, so it can still be
+  // moved from
+  auto [entry, inserted] = emplace_key(std::move(key), std::move(value));
+  if (!inserted) {
+    entry->value = std::move(value);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::erase(const key_type& key) {
+  size_type index = find_index(key);
+  if (index != NOT_FOUND) {
+    erase_at(index);
+  }
+}
+
+// -- LOOKUP -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename FlatHashTable<K, V, Hash, KeyEqual>::value_type&
+FlatHashTable<K, V, Hash, KeyEqual>::at(const key_type& key) {
+  size_type index = find_index(key);
+  if (index == NOT_FOUND) {
+    throw std::out_of_range("FlatHashTable::at: key not found");
+  }
+  return slots_[index].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename FlatHashTable<K, V, Hash, KeyEqual>::value_type&
+FlatHashTable<K, V, Hash, KeyEqual>::at(const key_type& key) const {
+  size_type index = find_index(key);
+  if (index == NOT_FOUND) {
+    throw std::out_of_range("FlatHashTable::at: key not found");
+  }
+  return slots_[index].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename FlatHashTable<K, V, Hash, KeyEqual>::value_type&
+FlatHashTable<K, V, Hash, KeyEqual>::operator[](const key_type& key) {
+  return emplace_key(key).first->value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename FlatHashTable<K, V, Hash, KeyEqual>::value_type&
+FlatHashTable<K, V, Hash, KeyEqual>::operator[](const key_type& key) const {
+  return at(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename FlatHashTable<K, V, Hash, KeyEqual>::Entry*
+FlatHashTable<K, V, Hash, KeyEqual>::find(const key_type& key) {
+  size_type index = find_index(key);
+  return index == NOT_FOUND ? nullptr : &slots_[index];
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename FlatHashTable<K, V, Hash, KeyEqual>::Entry*
+FlatHashTable<K, V, Hash, KeyEqual>::find(const key_type& key) const {
+  size_type index = find_index(key);
+  return index == NOT_FOUND ? nullptr : &slots_[index];
+}
+
+// -- HASH POLICY -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::reserve(size_type count) {
+  size_type new_capacity = capacity() == 0 ? MIN_CAPACITY : capacity();
+  while (static_cast<double>(count) >
+         static_cast<double>(new_capacity) * FLAT_MAX_LOAD_FACTOR) {
+    new_capacity *= 2;
+  }
+  if (new_capacity != capacity()) {
+    resize(new_capacity);
+  }
+}
+
+// -- Private Helpers -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename KeyArg, typename... Args>
+std::pair<typename FlatHashTable<K, V, Hash, KeyEqual>::Entry*, bool>
+FlatHashTable<K, V, Hash, KeyEqual>::emplace_key(KeyArg&& key,
+                                                 Args&&... args) {
+  size_type index = find_index(key);
+  if (index != NOT_FOUND) {
+    return {&slots_[index], false};
+  }
+  reserve_one();
+  uint64_t hashed = hash(key);
+  index = place(hashed, std::in_place, std::forward<KeyArg>(key),
+                std::forward<Args>(args)...);
+  return {&slots_[index], true};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename FlatHashTable<K, V, Hash, KeyEqual>::size_type
+FlatHashTable<K, V, Hash, KeyEqual>::find_index(const key_type& key) const {
+  if (capacity() == 0) {
+    // moved from, there are no slots to probe
+    return NOT_FOUND;
+  }
+  uint64_t hashed = hash(key);
+  const uint8_t* ctrl = slots_.meta();
+  const size_type mask = capacity() - 1;
+  const uint8_t tag = h2(hashed);
+  size_type pos = h1(hashed) & mask;
+  while (true) {
+    Group group(ctrl + pos);
+    for (BitMask match = group.match(tag); match; match.clear_lowest()) {
+      size_type index = (pos + match.lowest()) & mask;
+      if (key_equal_(slots_[index].key, key)) {
+        return index;
+      }
+    }
+    // a run never spans an empty slot, so the key is not further along
+    if (group.match_empty()) {
+      return NOT_FOUND;
+    }
+    pos = (pos + GROUP_SIZE) & mask;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename... Args>
+typename FlatHashTable<K, V, Hash, KeyEqual>::size_type
+FlatHashTable<K, V, Hash, KeyEqual>::place(uint64_t hash, Args&&... args) {
+  const size_type mask = capacity() - 1;
+  size_type pos = h1(hash) & mask;
+  while (true) {
+    BitMask empty = Group(slots_.meta() + pos).match_empty();
+    if (empty) {
+      size_type index = (pos + empty.lowest()) & mask;
+      slots_.construct(index, std::forward<Args>(args)...);
+      set_ctrl(index, h2(hash));
+      ++num_elements_;
+      return index;
+    }
+    pos = (pos + GROUP_SIZE) & mask;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::erase_at(size_type index) {
+  const uint8_t* ctrl = slots_.meta();
+  const size_type mask = capacity() - 1;
+  slots_.destroy(index);
+  set_ctrl(index, EMPTY);
+  --num_elements_;
+
+  // Knuth's algorithm R: walk the rest of the run and pull back every entry
+  // whose home slot is not between the hole and where it sits now
+  size_type hole = index;
+  for (size_type curr = (index + 1) & mask; ctrl[curr] != EMPTY;
+       curr = (curr + 1) & mask) {
+    size_type home = h1(hash(slots_[curr].key)) & mask;
+    if (((curr - home) & mask) >= ((curr - hole) & mask)) {
+      slots_.construct(hole, std::move(slots_[curr]));
+      set_ctrl(hole, ctrl[curr]);
+      slots_.destroy(curr);
+      set_ctrl(curr, EMPTY);
+      hole = curr;
+    }
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void FlatHashTable<K, V, Hash, KeyEqual>::resize(size_type new_capacity) {
+  // the old array destroys the moved from entries when it goes away
+  Slots old_slots(std::move(slots_));
+  slots_ = Slots(new_capacity);
+  num_elements_ = 0;
+  for (Entry& entry : old_slots) {
+    place(hash(entry.key), std::move(entry));
+  }
+}
+
+#endif  // FLATHASHTABLE_H_
@@ -0,0 +1,347 @@
+#include <random>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+#include "FlatHashTable.h"
+#include "gtest/gtest.h"
+
+TEST(FlatHashTableTest, default_constructor) {
+  FlatHashTable<int, int> ht;
+  ASSERT_EQ(ht.size(), 0);
+  ASSERT_TRUE(ht.empty());
+  ASSERT_EQ(ht.load_factor(), 0.0);
+  ASSERT_EQ(ht.max_load_factor(), 0.875);
+  ASSERT_EQ(ht.begin(), ht.end());
+}
+
+TEST(FlatHashTableTest, copy_constructor) {
+  FlatHashTable<int, std::string> ht;
+  for (int i = 0; i < 100; i++) {
+    ht.insert(i, std::to_string(i));
+  }
+  FlatHashTable<int, std::string> other = ht;
+  ASSERT_EQ(other.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(other.at(i), std::to_string(i));
+  }
+  // the copy is independent
+  other.erase(0);
+  ASSERT_TRUE(ht.contains(0));
+}
+
+TEST(FlatHashTableTest, move_constructor) {
+  FlatHashTable<int, int> ht;
+  for (int i = 0; i < 3; i++) {
+    ht.insert(i, i);
+  }
+  FlatHashTable<int, int> other = std::move(ht);
+  ASSERT_EQ(other.size(), 3);
+  ASSERT_EQ(other.at(2), 2);
+  ASSERT_TRUE(ht.empty());
+  // moving hands the slots over instead of allocating new ones
+  ASSERT_EQ(ht.capacity(), 0);
+  ASSERT_TRUE((std::is_nothrow_move_constructible_v<FlatHashTable<int, int>>));
+  // the moved from table is still usable
+  ASSERT_FALSE(ht.contains(2));
+  ASSERT_EQ(ht.find(2), nullptr);
+  ASSERT_THROW(ht.at(2), std::out_of_range);
+  ht.erase(2);
+  ASSERT_EQ(ht.begin(), ht.end());
+  FlatHashTable<int, int> copy = ht;
+  ASSERT_TRUE(copy.empty());
+  ht.insert(7, 7);
+  ASSERT_EQ(ht.at(7), 7);
+}
+
+TEST(FlatHashTableTest, copy_and_move_assignment) {
+  FlatHashTable<int, int> ht;
+  for (int i = 0; i < 50; i++) {
+    ht.insert(i, i);
+  }
+  FlatHashTable<int, int> ht2;
+  ht2.insert(-1, -1);
+  ht2 = ht;
+  ASSERT_EQ(ht2.size(), 50);
+  ASSERT_FALSE(ht2.contains(-1));
+  ASSERT_EQ(ht2[49], 49);
+
+  FlatHashTable<int, int> ht3;
+  ht3 = std::move(ht2);
+  ASSERT_EQ(ht3.size(), 50);
+  ASSERT_TRUE(ht2.empty());
+}
+
+TEST(FlatHashTableTest, insert) {
+  FlatHashTable<int, int> ht;
+  for (int i = 0; i < 3; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.size(), 3);
+  ht.insert(0, 100);
+  ASSERT_EQ(ht[0], 0);
+  ASSERT_EQ(ht.size(), 3);
+}
+
+TEST(FlatHashTableTest, insert_or_assign) {
+  FlatHashTable<int, int> ht;
+  for (int i = 0; i < 3; i++) {
+    ht.insert_or_assign(i, i);
+  }
+  ht.insert_or_assign(0, 100);
+  ASSERT_EQ(ht[0], 100);
+  ASSERT_EQ(ht.size(), 3);
+}
+
+TEST(FlatHashTableTest, erase) {
+  FlatHashTable<int, int> ht;
+  for (int i = 0; i < 3; i++) {
+    ht.insert(i, i);
+  }
+  ht.erase(0);
+  ht.erase(42);
+  ASSERT_EQ(ht.size(), 2);
+  ASSERT_FALSE(ht.contains(0));
+  ASSERT_EQ(ht.at(1), 1);
+}
+
+TEST(FlatHashTableTest, at_and_brackets) {
+  FlatHashTable<int, int> h;
+  for (int i = 0; i < 3; i++) {
+    h.insert(i, i);
+  }
+  h[100] = 100;
+  ASSERT_EQ(h.at(100), 100);
+  ASSERT_THROW(h.at(5), std::out_of_range);
+
+  const FlatHashTable<int, int> ht = h;
+  ASSERT_EQ(ht[2], 2);
+  ASSERT_THROW(ht[5], std::out_of_range);
+}
+
+TEST(FlatHashTableTest, find) {
+  FlatHashTable<std::string, int> ht;
+  ht.insert("a", 1);
+  auto pointer = ht.find("a");
+  ASSERT_NE(pointer, nullptr);
+  ASSERT_EQ(pointer->key, "a");
+  ASSERT_EQ(pointer->value, 1);
+  pointer->value = 2;
+  ASSERT_EQ(ht.at("a"), 2);
+  ASSERT_EQ(ht.find("b"), nullptr);
+
+  const FlatHashTable<std::string, int>& cht = ht;
+  ASSERT_NE(cht.find("a"), nullptr);
+}
+
+TEST(FlatHashTableTest, load_factor_and_growth) {
+  FlatHashTable<int, int> ht;
+  size_t capacity = ht.capacity();
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(i, i);
+    ASSERT_LE(ht.load_factor(), ht.max_load_factor());
+  }
+  ASSERT_GT(ht.capacity(), capacity);
+  ASSERT_EQ(ht.capacity() & (ht.capacity() - 1), 0u);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(ht.at(i), i);
+  }
+}
+
+TEST(FlatHashTableTest, iterators_visit_every_entry) {
+  FlatHashTable<int, int> ht;
+  long expected = 0;
+  for (int i = 0; i < 500; i++) {
+    ht.insert(i, i);
+    expected += i;
+  }
+  long sum = 0;
+  size_t count = 0;
+  for (auto it = ht.begin(); it != ht.end(); ++it) {
+    sum += it->value;
+    ++count;
+  }
+  ASSERT_EQ(count, ht.size());
+  ASSERT_EQ(sum, expected);
+
+  const FlatHashTable<int, int>& cht = ht;
+  count = 0;
+  for (auto it = cht.cbegin(); it != cht.cend(); it++) {
+    ++count;
+  }
+  ASSERT_EQ(count, ht.size());
+}
+
+// Runs that wrap around the end of the table and erases in the middle of a
+// run both have to leave every remaining key reachable
+TEST(FlatHashTableTest, backward_shift_keeps_runs_reachable) {
+  FlatHashTable<int, int> ht;
+  // stay just under the growth threshold so runs are long
+  const int n = static_cast<int>(ht.capacity() * ht.max_load_factor()) - 1;
+  for (int round = 0; round < 50; round++) {
+    for (int i = 0; i < n; i++) {
+      ht.insert(round * 1000 + i, i);
+    }
+    size_t capacity = ht.capacity();
+    for (int i = 0; i < n; i += 2) {
+      ht.erase(round * 1000 + i);
+    }
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(ht.contains(round * 1000 + i), i % 2 == 1);
+    }
+    for (int i = 1; i < n; i += 2) {
+      ht.erase(round * 1000 + i);
+    }
+    ASSERT_TRUE(ht.empty());
+    ASSERT_EQ(ht.capacity(), capacity);
+  }
+}
+
+// ASCII case-insensitive keys, both functions have to agree
+struct CaseInsensitiveHash {
+  size_t operator()(const std::string& key) const {
+    std::string lower = key;
+    for (char& c : lower) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return XXHash<std::string>{}(lower);
+  }
+};
+
+struct CaseInsensitiveEqual {
+  bool operator()(const std::string& a, const std::string& b) const {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+      if (std::tolower(static_cast<unsigned char>(a[i])) !=
+          std::tolower(static_cast<unsigned char>(b[i]))) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+using CaseInsensitiveTable = FlatHashTable<std::string, int,
+                                           CaseInsensitiveHash,
+                                           CaseInsensitiveEqual>;
+
+TEST(FlatHashTableTest, custom_hash_and_equal) {
+  CaseInsensitiveTable ht;
+  ht.insert("Hello", 1);
+  ht.insert("HELLO", 2);
+  ASSERT_EQ(ht.size(), 1);
+  ASSERT_EQ(ht.at("hello"), 1);
+  ht.insert_or_assign("hElLo", 3);
+  ASSERT_EQ(ht.at("Hello"), 3);
+  for (int i = 0; i < 100; i++) {
+    ht.insert("key" + std::to_string(i), i);
+  }
+  CaseInsensitiveTable copy = ht;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(copy.at("KEY" + std::to_string(i)), i);
+  }
+  copy.erase("HELLO");
+  ASSERT_FALSE(copy.contains("hello"));
+}
+
+TEST(FlatHashTableTest, try_emplace) {
+  FlatHashTable<std::string, std::unique_ptr<int>> ht;
+  auto [entry, inserted] = ht.try_emplace("a", new int(1));
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(*entry->value, 1);
+
+  // a duplicate key leaves the arguments alone
+  std::unique_ptr<int> value(new int(2));
+  std::tie(entry, inserted) = ht.try_emplace("a", std::move(value));
+  ASSERT_FALSE(inserted);
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(*entry->value, 1);
+
+  // default constructed value
+  std::tie(entry, inserted) = ht.try_emplace("b");
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(entry->value, nullptr);
+  ASSERT_EQ(ht.size(), 2);
+
+  // key built from a const char*, value from (count, char)
+  FlatHashTable<std::string, std::string> strings;
+  ASSERT_TRUE(strings.emplace("key", 3, 'x').second);
+  ASSERT_FALSE(strings.emplace("key", 1, 'y').second);
+  ASSERT_EQ(strings.at("key"), "xxx");
+}
+
+TEST(FlatHashTableTest, rvalue_insert) {
+  FlatHashTable<int, std::unique_ptr<int>> ht;
+  ht.insert(1, std::make_unique<int>(1));
+  ht.insert(1, std::make_unique<int>(100));
+  ASSERT_EQ(*ht.at(1), 1);
+  ht.insert_or_assign(1, std::make_unique<int>(2));
+  ASSERT_EQ(*ht.at(1), 2);
+  ht.insert_or_assign(2, std::make_unique<int>(3));
+  ASSERT_EQ(*ht.at(2), 3);
+  ASSERT_EQ(*ht[1], 2);
+  ASSERT_EQ(ht[3], nullptr);
+  ASSERT_EQ(ht.size(), 3);
+}
+
+TEST(FlatHashTableTest, reserve_and_clear) {
+  FlatHashTable<int, std::string> ht;
+  ht.reserve(1000);
+  size_t capacity = ht.capacity();
+  ASSERT_GE(capacity * ht.max_load_factor(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(i, std::to_string(i));
+  }
+  ASSERT_EQ(ht.capacity(), capacity);
+  ht.reserve(10);
+  ASSERT_EQ(ht.capacity(), capacity);
+
+  ht.clear();
+  ASSERT_TRUE(ht.empty());
+  ASSERT_EQ(ht.capacity(), capacity);
+  ASSERT_EQ(ht.begin(), ht.end());
+  ASSERT_FALSE(ht.contains(1));
+  ht.insert(1, "1");
+  ASSERT_EQ(ht.at(1), "1");
+
+  // a moved from table has no slots until reserve gives it some
+  FlatHashTable<int, std::string> moved(std::move(ht));
+  ht.clear();
+  ht.reserve(20);
+  ASSERT_GE(ht.capacity() * ht.max_load_factor(), 20);
+  ht.insert(2, "2");
+  ASSERT_EQ(ht.at(2), "2");
+}
+
+TEST(FlatHashTableTest, matches_unordered_map) {
+  FlatHashTable<int, int> ht;
+  std::unordered_map<int, int> reference;
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> key_dist(0, 2000);
+  for (int i = 0; i < 50000; i++) {
+    int key = key_dist(rng);
+    switch (rng() % 3) {
+      case 0:
+        ht.insert_or_assign(key, i);
+        reference[key] = i;
+        break;
+      case 1:
+        ht.erase(key);
+        reference.erase(key);
+        break;
+      default:
+        auto found = reference.find(key);
+        if (found == reference.end()) {
+          ASSERT_FALSE(ht.contains(key));
+        } else {
+          ASSERT_EQ(ht.at(key), found->second);
+        }
+    }
+    ASSERT_EQ(ht.size(), reference.size());
+  }
+}
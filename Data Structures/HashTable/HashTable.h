@@ -2,33 +2,148 @@
 #define HASHTABLE_H_
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 #include "../Vector/Vector.h"
+#include "NodeArena.h"
+#include "XXHash.h"
 
 // Maximum load factor before rehashing (keep between 0.7-1.0)
 inline constexpr double MAX_LOAD_FACTOR = 0.75;
 
-template <typename K, typename V>
+// Bucket count of a new table, bucket counts are always powers of two
+inline constexpr std::size_t INITIAL_BUCKETS = 16;
+
+// Old buckets moved into the new bucket array by each insert or erase while
+// an incremental rehash is in progress. Anything above 1 / MAX_LOAD_FACTOR
+// finishes the move before the new array itself needs to grow
+inline constexpr std::size_t REHASH_STEP_BUCKETS = 4;
+
+// Chains of STATS_MAX_CHAIN_LENGTH nodes or more share the last slot of
+// HashTableStats::chain_length_histogram
+inline constexpr std::size_t STATS_MAX_CHAIN_LENGTH = 8;
+
+// One lookup in this many, per thread, has its probes counted for stats()
+inline constexpr std::size_t STATS_SAMPLE_PERIOD = 64;
+
+/**
+ * What HashTable::stats() reports.
+ *
+ * A bad hash shows up as a long tail in the histogram and a longest chain
+ * far above the load factor, while the load factor itself looks normal. An
+ * overloaded table has every chain a little long instead.
+ */
+struct HashTableStats {
+  // chain_length_histogram[i] is the number of buckets holding i nodes
+  std::array<std::size_t, STATS_MAX_CHAIN_LENGTH + 1> chain_length_histogram{};
+  std::size_t longest_chain = 0;
+  double load_factor = 0.0;
+
+  // nodes compared per lookup, over the lookups sampled since the table was
+  // built or reset_stats() was last called
+  std::size_t sampled_hits = 0;
+  std::size_t sampled_misses = 0;
+  double average_probes_hit = 0.0;
+  double average_probes_miss = 0.0;
+
+  // rehashes started and the time spent in them, incremental steps included
+  std::size_t rehash_count = 0;
+  std::chrono::nanoseconds rehash_time{0};
+};
+
+// Base of a HashTable node that keeps the key's full hash when CacheHash is
+// set, it is empty and takes no space when it is not
+template <bool CacheHash>
+struct HashTableNodeHash {
+  explicit HashTableNodeHash(std::size_t hash) : hash(hash) {}
+  std::size_t hash;
+};
+
+template <>
+struct HashTableNodeHash<false> {
+  explicit HashTableNodeHash(std::size_t) {}
+};
+
+// true if T declares is_transparent, i.e. it accepts more than the key type
+template <typename T, typename = void>
+inline constexpr bool hash_table_is_transparent = false;
+
+template <typename T>
+inline constexpr bool
+    hash_table_is_transparent<T, std::void_t<typename T::is_transparent>> =
+        true;
+
+/**
+ * Separate chaining hash table.
+ *
+ * Buckets are picked by masking the hash with a power-of-two bucket count,
+ * so Hash must spread its entropy into the low bits. The default XXHash does;
+ * a plain std::hash, which is the identity for integers, does not.
+ *
+ * When both Hash and KeyEqual are transparent (declare is_transparent, like
+ * XXHash<std::string> and std::equal_to<>), find, contains, at and erase
+ * also accept anything they can hash and compare against a key, e.g. a
+ * std::string table can be searched by std::string_view or const char*
+ * without building a std::string.
+ *
+ * With CacheHash set every node keeps its key's full hash. Rehashing then
+ * never calls Hash, and a chain walk only calls KeyEqual on nodes whose hash
+ * matches. It costs one size_t per node.
+ *
+ * NodeAlloc supplies the nodes' storage. The default NodeHeap makes every
+ * node its own heap allocation; NodeArena carves them out of large slabs, so
+ * filling or copying a table takes a few allocations and clear() or the
+ * destructor gives everything back at once (see NodeArena.h).
+ *
+ * stats() reports how chains are distributed and how many nodes lookups
+ * compare. Defining HASHTABLE_NO_STATS before including this header removes
+ * stats() and all of its bookkeeping.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>, bool CacheHash = true,
+          template <typename> class NodeAlloc = NodeHeap>
 class HashTable {
  private:
   struct Node;
 
+  // heterogeneous lookup overloads only exist when both functions opt in,
+  // passing void_t<Key> defers the check to overload resolution
+  template <typename Key>
+  using enable_if_transparent = std::enable_if_t<
+      hash_table_is_transparent<Hash, std::void_t<Key>> &&
+      hash_table_is_transparent<KeyEqual, std::void_t<Key>>>;
+
  public:
   using key_type = K;
   using value_type = V;
   using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
 
   // -- CONSTRUCTOR AND DESTRUCTOR --//
 
   /**
    * Constructs an empty HashTable
    */
-  HashTable();
+  HashTable() : HashTable(Hash()) {}
+
+  /**
+   * Constructs an empty HashTable with the given hash and key equality
+   * functions
+   *
+   * ARGS:
+   * hash: hashes keys, its low bits pick the bucket
+   * equal: compares keys
+   */
+  explicit HashTable(const Hash& hash, const KeyEqual& equal = KeyEqual());
 
   /**
    * Copy constructor that constructs this hashtable with another hashtable
@@ -88,6 +203,12 @@ class HashTable {
 
   // -- MODIFIERS -- //
 
+  /**
+   * Removes every element. The bucket count stays as it is, so refilling the
+   * table to the same size does not rehash again
+   */
+  void clear();
+
   /**
    * Adds the key-value pair into the table, if the key already exists then
    * nothing happens
@@ -97,6 +218,7 @@ class HashTable {
    * value: the value of the key
    */
   void insert(const key_type& key, const value_type& value);
+  void insert(key_type&& key, value_type&& value);
 
   /**
    * Adds the key-value pair into the table, if the key already exists then
@@ -107,6 +229,44 @@ class HashTable {
    * value: the value of the key
    */
   void insert_or_assign(const key_type& key, const value_type& value);
+  void insert_or_assign(key_type&& key, value_type&& value);
+
+  /**
+   * Constructs the value in place from args if the key is not in the table
+   * yet, otherwise nothing happens and args are left untouched
+   *
+   * ARGS:
+   * key: the unique identifier of the value, moved from only on insertion
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the node holding key, and true if it was just inserted
+   */
+  template <typename... Args>
+  std::pair<Node*, bool> try_emplace(const key_type& key, Args&&... args) {
+    return emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<Node*, bool> try_emplace(key_type&& key, Args&&... args) {
+    return emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Constructs the key from key_arg, then behaves as try_emplace, so the
+   * value is only built when the key turns out to be new
+   *
+   * ARGS:
+   * key_arg: forwarded to the key's constructor
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the node holding the key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Node*, bool> emplace(KeyArg&& key_arg, Args&&... args) {
+    return emplace_key(key_type(std::forward<KeyArg>(key_arg)),
+                       std::forward<Args>(args)...);
+  }
 
   /**
    * Removes the element with the specified key from the table.
@@ -115,6 +275,10 @@ class HashTable {
    * key: the key of the element to remove
    */
   void erase(const key_type& key);
+  template <typename Key, typename = enable_if_transparent<Key>>
+  void erase(const Key& key) {
+    erase_key(key);
+  }
 
   // -- LOOKUP -- //
 
@@ -133,6 +297,14 @@ class HashTable {
    */
   value_type& at(const key_type& key);
   const value_type& at(const key_type& key) const;
+  template <typename Key, typename = enable_if_transparent<Key>>
+  value_type& at(const Key& key) {
+    return at_node(key)->value;
+  }
+  template <typename Key, typename = enable_if_transparent<Key>>
+  const value_type& at(const Key& key) const {
+    return at_node(key)->value;
+  }
 
   /**
    * Accesses or inserts element with the given key.
@@ -158,6 +330,14 @@ class HashTable {
    */
   Node* find(const key_type& key);
   const Node* find(const key_type& key) const;
+  template <typename Key, typename = enable_if_transparent<Key>>
+  Node* find(const Key& key) {
+    return find_node(key);
+  }
+  template <typename Key, typename = enable_if_transparent<Key>>
+  const Node* find(const Key& key) const {
+    return find_node(key);
+  }
 
   /**
    * Finds the node contains the specified key
@@ -169,6 +349,10 @@ class HashTable {
    * true if its within the table, else false
    */
   bool contains(const key_type& key) const;
+  template <typename Key, typename = enable_if_transparent<Key>>
+  bool contains(const Key& key) const {
+    return find_node(key) != nullptr;
+  }
 
   // -- HASH POLICY -- //
 
@@ -190,28 +374,109 @@ class HashTable {
 
   /**
    * Reorganizes the hash table by increasing bucket count
-   * and redistributing elements.
+   * and redistributing elements. Always moves every element before returning,
+   * finishing an incremental rehash first if one is in progress.
    */
   void rehash();
 
+  /**
+   * Prepares the table for count elements: grows the bucket array so that
+   * count elements stay under the max load factor, and with a NodeArena
+   * allocates room for the missing nodes in one slab. Inserting up to count
+   * elements afterwards never rehashes. Never shrinks the table.
+   *
+   * ARGS:
+   * count: the number of elements the table should hold without growing
+   */
+  void reserve(size_type count);
+
+  /**
+   * Chooses how the table grows when it crosses the max load factor.
+   *
+   * Off (the default), the insert that crosses it moves every element into
+   * the bigger bucket array. On, that insert only allocates the bigger array
+   * and keeps the old one around; every following insert or erase then moves
+   * REHASH_STEP_BUCKETS old buckets across, and lookups check whichever array
+   * currently owns the key's bucket. No single insert pays for the whole
+   * table, so insert latency stays flat while the table grows.
+   *
+   * Turning it off finishes any rehash in progress.
+   *
+   * ARGS:
+   * enabled: true to rehash incrementally
+   */
+  void set_incremental_rehash(bool enabled);
+
+  /**
+   * RETURNS:
+   * true if the table rehashes incrementally
+   */
+  bool incremental_rehash() const { return incremental_rehash_; }
+
+  /**
+   * RETURNS:
+   * true while an incremental rehash still has old buckets to move
+   */
+  bool rehashing() const { return old_num_buckets_ != 0; }
+
+  /**
+   * RETURNS:
+   * the number of buckets, always a power of two
+   */
+  size_type bucket_count() const { return num_buckets_; }
+
+  /**
+   * RETURNS:
+   * the hash function
+   */
+  hasher hash_function() const { return hasher_; }
+
+  /**
+   * RETURNS:
+   * the key equality function
+   */
+  key_equal key_eq() const { return key_equal_; }
+
+#ifndef HASHTABLE_NO_STATS
+  // -- STATS -- //
+
+  /**
+   * Walks every bucket for the chain length histogram, and reads the probe
+   * and rehash counters. The walk is O(buckets), the counters are kept up as
+   * the table is used: one lookup in STATS_SAMPLE_PERIOD on each thread has
+   * its probes counted, the others only bump a thread local tick.
+   *
+   * Safe to call alongside other const calls, like lookups are.
+   *
+   * RETURNS:
+   * the table's current stats
+   */
+  HashTableStats stats() const;
+
+  /**
+   * Clears the probe samples and the rehash counters, starting a new window
+   */
+  void reset_stats();
+#endif
+
   // Forward declaration for iterator
   class iterator;
   class const_iterator;
 
   // -- ITERATORS -- //
   iterator begin() {
-    for (size_type i = 0; i < num_buckets_; ++i) {
-      if (table_[i] != nullptr) {
-        return iterator(this, i, table_[i]);
+    for (size_type i = 0; i < total_buckets(); ++i) {
+      if (bucket_at(i) != nullptr) {
+        return iterator(this, i, bucket_at(i));
       }
     }
     return end();
   }
 
   const_iterator begin() const {
-    for (size_type i = 0; i < num_buckets_; ++i) {
-      if (table_[i] != nullptr) {
-        return const_iterator(this, i, table_[i]);
+    for (size_type i = 0; i < total_buckets(); ++i) {
+      if (bucket_at(i) != nullptr) {
+        return const_iterator(this, i, bucket_at(i));
       }
     }
     return end();
@@ -219,9 +484,9 @@ class HashTable {
 
   const_iterator cbegin() const { return begin(); }
 
-  iterator end() { return iterator(this, num_buckets_, nullptr); }
+  iterator end() { return iterator(this, total_buckets(), nullptr); }
   const_iterator end() const {
-    return const_iterator(this, num_buckets_, nullptr);
+    return const_iterator(this, total_buckets(), nullptr);
   }
 
   const_iterator cend() const { return end(); }
@@ -370,404 +635,849 @@ class HashTable {
   };
 
  private:
-  struct Node {
+  struct Node : HashTableNodeHash<CacheHash> {
     const key_type key;
     value_type value;
     Node* next = nullptr;
 
-    Node() = default;
-
-    Node(const key_type& key, const value_type& value)
-        : key(key), value(value), next(nullptr) {}
+    template <typename KeyArg, typename... Args>
+    Node(size_type hash, KeyArg&& key, Args&&... args)
+        : HashTableNodeHash<CacheHash>(hash),
+          key(std::forward<KeyArg>(key)),
+          value(std::forward<Args>(args)...),
+          next(nullptr) {}
+
+    // copies the entry but not its place in a chain
+    Node(const Node& other)
+        : HashTableNodeHash<CacheHash>(other),
+          key(other.key),
+          value(other.value),
+          next(nullptr) {}
   };
 
   Vector<Node*> table_;  // Array of pointers (separate chaining)
   size_type num_elements_;
   size_type num_buckets_;
 
+  // While rehashing(), the bucket array being drained into table_. Buckets
+  // below migrate_index_ have been moved already and are empty
+  Vector<Node*> old_table_;
+  size_type old_num_buckets_ = 0;
+  size_type migrate_index_ = 0;
+  bool incremental_rehash_ = false;
+
+  Hash hasher_;
+  KeyEqual key_equal_;
+  NodeAlloc<Node> nodes_;
+
+#ifndef HASHTABLE_NO_STATS
+  // Written by concurrent const lookups, so atomic, and kept on their own
+  // cache line so a sampled lookup does not evict the fields every other
+  // lookup reads. Copies and moves start with fresh stats
+  struct alignas(64) ProbeSamples {
+    std::atomic<size_type> hits{0};
+    std::atomic<size_type> hit_probes{0};
+    std::atomic<size_type> misses{0};
+    std::atomic<size_type> miss_probes{0};
+  };
+  mutable ProbeSamples probe_samples_;
+  size_type rehash_count_ = 0;
+  std::chrono::nanoseconds rehash_time_{0};
+#endif
+
   /**
-   * Helper function to compute hash
+   * Helper function that counts the probes of one lookup in
+   * STATS_SAMPLE_PERIOD. A hit compares every node up to and including found,
+   * a miss the whole chain
    */
-  size_type hash(const key_type& key) const;
-};
+  void sample_lookup([[maybe_unused]] const Node* head,
+                     [[maybe_unused]] const Node* found) const {
+#ifndef HASHTABLE_NO_STATS
+    static thread_local size_type tick = 0;
+    if (++tick % STATS_SAMPLE_PERIOD != 0) {
+      return;
+    }
+    size_type probes = found != nullptr ? 1 : 0;
+    for (const Node* curr = head; curr != found; curr = curr->next) {
+      probes++;
+    }
+    if (found != nullptr) {
+      probe_samples_.hits.fetch_add(1, std::memory_order_relaxed);
+      probe_samples_.hit_probes.fetch_add(probes, std::memory_order_relaxed);
+    } else {
+      probe_samples_.misses.fetch_add(1, std::memory_order_relaxed);
+      probe_samples_.miss_probes.fetch_add(probes, std::memory_order_relaxed);
+    }
+#endif
+  }
 
-// ----------------------------------------------------------------------------
-// --- MEMBER FUNCTION DEFINITIONS
-// ----------------------------------------------------------------------------
+  /**
+   * Helper functions that time rehash work for stats()
+   */
+  std::chrono::steady_clock::time_point rehash_timer_start() const {
+#ifndef HASHTABLE_NO_STATS
+    return std::chrono::steady_clock::now();
+#else
+    return {};
+#endif
+  }
 
-// -- CONSTRUCTOR AND DESTRUCTOR --//
+  void rehash_timer_stop(
+      [[maybe_unused]] std::chrono::steady_clock::time_point start) {
+#ifndef HASHTABLE_NO_STATS
+    rehash_time_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+#endif
+  }
 
-template <typename K, typename V>
-HashTable<K, V>::HashTable() : num_elements_(0), num_buckets_(10) {
-  // Initialize table_ with nullptrs
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    table_.push_back(nullptr);
+  /**
+   * Helper function that builds a node in storage from nodes_
+   */
+  template <typename... Args>
+  Node* create_node(Args&&... args) {
+    void* memory = nodes_.allocate();
+    try {
+      return ::new (memory) Node(std::forward<Args>(args)...);
+    } catch (...) {
+      nodes_.deallocate(memory);
+      throw;
+    }
   }
-}
 
-template <typename K, typename V>
-HashTable<K, V>::HashTable(const HashTable& other)
-    : num_elements_(other.num_elements_), num_buckets_(other.num_buckets_) {
-  // Initialize table_ with nullptrs
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    table_.push_back(nullptr);
+  /**
+   * Helper function that destroys a node and hands its storage back
+   */
+  void destroy_node(Node* node) {
+    node->~Node();
+    nodes_.deallocate(node);
   }
-  // Copy all chains
-  for (size_type i = 0; i < other.num_buckets_; ++i) {
-    Node* other_curr = other.table_[i];
-    Node* this_prev = nullptr;
-    while (other_curr != nullptr) {
-      Node* new_node = new Node(other_curr->key, other_curr->value);
-      if (this_prev == nullptr) {
-        table_[i] = new_node;
-      } else {
-        this_prev->next = new_node;
+
+  /**
+   * Helper function to compute hash
+   */
+  template <typename Key>
+  size_type hash(const Key& key) const {
+    return hasher_(key);
+  }
+
+  /**
+   * Helper function that returns a node's full hash, from the node itself
+   * when hashes are cached
+   */
+  size_type node_hash(const Node* node) const {
+    if constexpr (CacheHash) {
+      return node->hash;
+    } else {
+      return hash(node->key);
+    }
+  }
+
+  /**
+   * Helper function that checks whether node holds key, skipping the key
+   * comparison when a cached hash already rules it out
+   */
+  template <typename Key>
+  bool matches(const Node* node, size_type hashed_key, const Key& key) const {
+    if constexpr (CacheHash) {
+      if (node->hash != hashed_key) {
+        return false;
       }
-      this_prev = new_node;
-      other_curr = other_curr->next;
     }
+    return key_equal_(node->key, key);
+  }
+
+  /**
+   * Helper function that walks the chain starting at head
+   *
+   * RETURNS:
+   * the node holding key, nullptr if the chain does not have it
+   */
+  template <typename Key>
+  Node* find_in_chain(Node* head, size_type hashed_key, const Key& key) const {
+    while (head != nullptr && !matches(head, hashed_key, key)) {
+      head = head->next;
+    }
+    return head;
+  }
+
+  /**
+   * Helper functions behind the lookups, Key is key_type or, with a
+   * transparent Hash and KeyEqual, anything they accept
+   */
+  template <typename Key>
+  Node* find_node(const Key& key) const {
+    size_type hashed_key = hash(key);
+    Node* head = bucket(hashed_key);
+    Node* found = find_in_chain(head, hashed_key, key);
+    sample_lookup(head, found);
+    return found;
+  }
+
+  template <typename Key>
+  Node* at_node(const Key& key) const {
+    Node* found = find_node(key);
+    if (found == nullptr) {
+      throw std::out_of_range("HashTable::at: key not found");
+    }
+    return found;
   }
+
+  template <typename Key>
+  void erase_key(const Key& key);
+
+  /**
+   * Helper function behind every insertion: one hash and one chain walk,
+   * and the node is only built, from key and args, if key is new
+   *
+   * RETURNS:
+   * the node holding key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Node*, bool> emplace_key(KeyArg&& key, Args&&... args);
+
+  /**
+   * Helper function that finds the chain a hash belongs to, in old_table_ if
+   * its old bucket has not been moved yet, else in table_
+   *
+   * RETURNS:
+   * reference to the head pointer of that chain
+   */
+  Node*& bucket(size_type hashed_key);
+  Node* bucket(size_type hashed_key) const;
+
+  // Iterators walk table_ followed by old_table_ as one run of buckets
+  size_type total_buckets() const { return num_buckets_ + old_num_buckets_; }
+  Node* bucket_at(size_type index) const {
+    return index < num_buckets_ ? table_[index]
+                                : old_table_[index - num_buckets_];
+  }
+
+  /**
+   * Helper function that grows the table once it is past the max load
+   * factor, all at once or by starting an incremental rehash
+   */
+  void grow();
+
+  /**
+   * Helper function that swaps in a bucket array of new_num_buckets and keeps
+   * the current one as old_table_ to be drained
+   */
+  void start_rehash(size_type new_num_buckets);
+
+  /**
+   * Helper function that moves up to count old buckets into table_, and
+   * drops old_table_ once it is empty
+   */
+  void migrate(size_type count);
+
+  /**
+   * Helper function that does one bounded step of a rehash in progress
+   */
+  void rehash_step() {
+    if (old_num_buckets_ != 0) {
+      migrate(REHASH_STEP_BUCKETS);
+    }
+  }
+
+  /**
+   * Helper function that moves every remaining old bucket into table_
+   */
+  void finish_rehash() {
+    if (old_num_buckets_ != 0) {
+      migrate(old_num_buckets_);
+    }
+  }
+
+  /**
+   * Helper function that destroys every node in the first num_buckets chains
+   * of buckets, leaving the buckets themselves dangling
+   */
+  void free_chains(Vector<Node*>& buckets, size_type num_buckets);
+
+  /**
+   * Helper function that destroys every node of both bucket arrays and
+   * releases nodes_
+   */
+  void free_nodes() {
+    free_chains(table_, num_buckets_);
+    free_chains(old_table_, old_num_buckets_);
+    nodes_.release();
+  }
+
+  /**
+   * Helper function that replaces to with num_buckets copies of the first
+   * num_buckets chains of from, keeping each chain's order
+   */
+  void copy_chains(const Vector<Node*>& from, Vector<Node*>& to,
+                   size_type num_buckets);
+};
+
+// ----------------------------------------------------------------------------
+// --- MEMBER FUNCTION DEFINITIONS
+// ----------------------------------------------------------------------------
+
+// -- CONSTRUCTOR AND DESTRUCTOR --//
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::HashTable(
+    const Hash& hash, const KeyEqual& equal)
+    : table_(INITIAL_BUCKETS, nullptr),
+      num_elements_(0),
+      num_buckets_(INITIAL_BUCKETS),
+      hasher_(hash),
+      key_equal_(equal) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::HashTable(
+    const HashTable& other)
+    : num_elements_(other.num_elements_),
+      num_buckets_(other.num_buckets_),
+      old_num_buckets_(other.old_num_buckets_),
+      migrate_index_(other.migrate_index_),
+      incremental_rehash_(other.incremental_rehash_),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_) {
+  // one slab for every node with an arena
+  nodes_.reserve(num_elements_);
+  copy_chains(other.table_, table_, num_buckets_);
+  copy_chains(other.old_table_, old_table_, old_num_buckets_);
 }
 
-template <typename K, typename V>
-HashTable<K, V>::HashTable(HashTable&& other)
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::HashTable(
+    HashTable&& other)
     : table_(std::move(other.table_)),
       num_elements_(other.num_elements_),
-      num_buckets_(other.num_buckets_) {
+      num_buckets_(other.num_buckets_),
+      old_table_(std::move(other.old_table_)),
+      old_num_buckets_(other.old_num_buckets_),
+      migrate_index_(other.migrate_index_),
+      incremental_rehash_(other.incremental_rehash_),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_),
+      nodes_(std::move(other.nodes_)) {
   // Reset other to empty state
   other.num_elements_ = 0;
-  other.num_buckets_ = 10;
-  // Reinitialize other's table
-  other.table_ = Vector<Node*>();
-  for (size_type i = 0; i < other.num_buckets_; ++i) {
-    other.table_.push_back(nullptr);
-  }
+  other.num_buckets_ = INITIAL_BUCKETS;
+  other.old_num_buckets_ = 0;
+  other.migrate_index_ = 0;
+  other.table_ = Vector<Node*>(INITIAL_BUCKETS, nullptr);
 }
 
-template <typename K, typename V>
-HashTable<K, V>::~HashTable() {
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    Node* curr = table_[i];
-    while (curr != nullptr) {
-      Node* temp = curr->next;
-      delete curr;
-      curr = temp;
-    }
-  }
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::~HashTable() {
+  free_nodes();
 }
 
-template <typename K, typename V>
-HashTable<K, V>& HashTable<K, V>::operator=(const HashTable& other) {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::operator=(
+    const HashTable& other) {
   if (this == &other) {
     return *this;
   }
   // Clean up current table
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    Node* curr = table_[i];
-    while (curr != nullptr) {
-      Node* temp = curr->next;
-      delete curr;
-      curr = temp;
-    }
-  }
+  free_nodes();
   // Copy member variables
   num_buckets_ = other.num_buckets_;
   num_elements_ = other.num_elements_;
-  // Clear and resize table
-  table_ = Vector<Node*>();
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    table_.push_back(nullptr);
-  }
+  old_num_buckets_ = other.old_num_buckets_;
+  migrate_index_ = other.migrate_index_;
+  incremental_rehash_ = other.incremental_rehash_;
+  hasher_ = other.hasher_;
+  key_equal_ = other.key_equal_;
   // Copy all chains
-  for (size_type i = 0; i < other.num_buckets_; ++i) {
-    Node* other_curr = other.table_[i];
-    Node* this_prev = nullptr;
-    while (other_curr != nullptr) {
-      Node* new_node = new Node(other_curr->key, other_curr->value);
-      if (this_prev == nullptr) {
-        table_[i] = new_node;
-      } else {
-        this_prev->next = new_node;
-      }
-      this_prev = new_node;
-      other_curr = other_curr->next;
-    }
-  }
+  nodes_.reserve(num_elements_);
+  copy_chains(other.table_, table_, num_buckets_);
+  copy_chains(other.old_table_, old_table_, old_num_buckets_);
   return *this;
 }
 
-template <typename K, typename V>
-HashTable<K, V>& HashTable<K, V>::operator=(HashTable&& other) {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::operator=(
+    HashTable&& other) {
   if (this == &other) {
     return *this;
   }
-  // Clean up current table
-  for (size_type i = 0; i < num_buckets_; ++i) {
-    Node* curr = table_[i];
-    while (curr != nullptr) {
-      Node* temp = curr->next;
-      delete curr;
-      curr = temp;
-    }
-  }
+  // Clean up current table, nodes_ is released when other's arena moves in
+  free_chains(table_, num_buckets_);
+  free_chains(old_table_, old_num_buckets_);
   // Move from other
+  nodes_ = std::move(other.nodes_);
   table_ = std::move(other.table_);
+  old_table_ = std::move(other.old_table_);
   num_buckets_ = other.num_buckets_;
   num_elements_ = other.num_elements_;
+  old_num_buckets_ = other.old_num_buckets_;
+  migrate_index_ = other.migrate_index_;
+  incremental_rehash_ = other.incremental_rehash_;
+  hasher_ = other.hasher_;
+  key_equal_ = other.key_equal_;
   // Reset other to empty state
-  other.num_buckets_ = 10;
+  other.num_buckets_ = INITIAL_BUCKETS;
   other.num_elements_ = 0;
-  other.table_ = Vector<Node*>();
-  for (size_type i = 0; i < other.num_buckets_; ++i) {
-    other.table_.push_back(nullptr);
-  }
+  other.old_num_buckets_ = 0;
+  other.migrate_index_ = 0;
+  other.table_ = Vector<Node*>(INITIAL_BUCKETS, nullptr);
   return *this;
 }
 
 // -- MODIFIERS -- //
 
-template <typename K, typename V>
-void HashTable<K, V>::insert(const key_type& key, const value_type& value) {
-  // Check if key already exists
-  Node* existing = find(key);
-  if (existing != nullptr) {
-    // Key already exists, do nothing
-    return;
-  }
-  size_type hashed_key = hash(key);
-  Node* new_node = new Node(key, value);
-  if (table_[hashed_key] == nullptr) {
-    table_[hashed_key] = new_node;
-  } else {
-    // Insert at head of chain
-    new_node->next = table_[hashed_key];
-    table_[hashed_key] = new_node;
-  }
-  num_elements_++;
-  if (load_factor() > max_load_factor()) {
-    rehash();
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::clear() {
+  free_nodes();
+  for (size_type i = 0; i < num_buckets_; ++i) {
+    table_[i] = nullptr;
   }
+  old_table_ = Vector<Node*>();
+  old_num_buckets_ = 0;
+  migrate_index_ = 0;
+  num_elements_ = 0;
 }
 
-template <typename K, typename V>
-void HashTable<K, V>::insert_or_assign(const key_type& key,
-                                       const value_type& value) {
-  size_type hashed_key = hash(key);
-  Node* curr = table_[hashed_key];
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      // Key exists, update value
-      curr->value = value;
-      return;
-    }
-    curr = curr->next;
-  }
-  // Key doesn't exist, insert new node
-  Node* new_node = new Node(key, value);
-  if (table_[hashed_key] == nullptr) {
-    table_[hashed_key] = new_node;
-  } else {
-    // Insert at head of chain
-    new_node->next = table_[hashed_key];
-    table_[hashed_key] = new_node;
-  }
-  num_elements_++;
-  if (load_factor() > max_load_factor()) {
-    rehash();
-  }
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::insert(
+    const key_type& key, const value_type& value) {
+  emplace_key(key, value);
 }
 
-template <typename K, typename V>
-void HashTable<K, V>::erase(const key_type& key) {
-  size_type hashed_key = hash(key);
-  if (table_[hashed_key] == nullptr) {
-    return;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::insert(
+    key_type&& key, value_type&& value) {
+  emplace_key(std::move(key), std::move(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::insert_or_assign(
+    const key_type& key, const value_type& value) {
+  auto [node, inserted] = emplace_key(key, value);
+  if (!inserted) {
+    // Key exists, update value
+    node->value = value;
   }
-  Node* curr = table_[hashed_key];
-  Node* prev = nullptr;
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      if (prev == nullptr) {
-        // Removing head of chain
-        table_[hashed_key] = curr->next;
-      } else {
-        prev->next = curr->next;
-      }
-      delete curr;
-      num_elements_--;
-      return;
-    }
-    prev = curr;
-    curr = curr->next;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::insert_or_assign(
+    key_type&& key, value_type&& value) {
+  // value is only moved from if the key was new
+  auto [node, inserted] = emplace_key(std::move(key), std::move(value));
+  if (!inserted) {
+    node->value = std::move(value);
   }
 }
 
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::erase(
+    const key_type& key) {
+  erase_key(key);
+}
+
 // -- LOOKUP -- //
 
-template <typename K, typename V>
-typename HashTable<K, V>::value_type& HashTable<K, V>::at(const key_type& key) {
-  size_type hashed_key = hash(key);
-  Node* curr = table_[hashed_key];
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      return curr->value;
-    }
-    curr = curr->next;
-  }
-  throw std::out_of_range("HashTable::at: key not found");
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::value_type&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::at(const key_type& key) {
+  return at_node(key)->value;
 }
 
-template <typename K, typename V>
-const typename HashTable<K, V>::value_type& HashTable<K, V>::at(
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+const typename HashTable<K, V, Hash, KeyEqual, CacheHash,
+                         NodeAlloc>::value_type&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::at(
     const key_type& key) const {
-  size_type hashed_key = hash(key);
-  const Node* curr = table_[hashed_key];
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      return curr->value;
-    }
-    curr = curr->next;
-  }
-  throw std::out_of_range("HashTable::at: key not found");
+  return at_node(key)->value;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::value_type& HashTable<K, V>::operator[](
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::value_type&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::operator[](
     const key_type& key) {
-  Node* found = find(key);
-  if (found != nullptr) {
-    return found->value;
-  }
-  insert(key, value_type());
-  return find(key)->value;
+  return emplace_key(key).first->value;
 }
 
-template <typename K, typename V>
-const typename HashTable<K, V>::value_type& HashTable<K, V>::operator[](
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+const typename HashTable<K, V, Hash, KeyEqual, CacheHash,
+                         NodeAlloc>::value_type&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::operator[](
     const key_type& key) const {
   return at(key);
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::Node* HashTable<K, V>::find(const key_type& key) {
-  size_type hashed_key = hash(key);
-  Node* curr = table_[hashed_key];
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      return curr;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::find(
+    const key_type& key) {
+  return find_node(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+const typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::find(
+    const key_type& key) const {
+  return find_node(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+bool HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::contains(
+    const key_type& key) const {
+  return find_node(key) != nullptr;
+}
+
+// -- HASH POLICY -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+double HashTable<K, V, Hash, KeyEqual, CacheHash,
+                 NodeAlloc>::load_factor() const {
+  if (num_buckets_ == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(num_elements_) / static_cast<double>(num_buckets_);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+double HashTable<K, V, Hash, KeyEqual, CacheHash,
+                 NodeAlloc>::max_load_factor() const {
+  return MAX_LOAD_FACTOR;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::rehash() {
+  finish_rehash();
+  start_rehash(num_buckets_ * 2);
+  finish_rehash();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::reserve(
+    size_type count) {
+  if (count > num_elements_) {
+    nodes_.reserve(count - num_elements_);
+  }
+  size_type new_num_buckets = num_buckets_;
+  while (static_cast<double>(count) > new_num_buckets * max_load_factor()) {
+    new_num_buckets *= 2;
+  }
+  if (new_num_buckets != num_buckets_) {
+    start_rehash(new_num_buckets);
+    finish_rehash();
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::set_incremental_rehash(bool enabled) {
+  incremental_rehash_ = enabled;
+  if (!enabled) {
+    finish_rehash();
+  }
+}
+
+#ifndef HASHTABLE_NO_STATS
+// -- STATS -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTableStats HashTable<K, V, Hash, KeyEqual, CacheHash,
+                         NodeAlloc>::stats() const {
+  HashTableStats stats;
+  stats.load_factor = load_factor();
+  // old buckets below migrate_index_ are already empty, they are not part of
+  // the table any more
+  auto add_chains = [&stats](const Vector<Node*>& buckets, size_type first,
+                             size_type last) {
+    for (size_type i = first; i < last; ++i) {
+      size_type length = 0;
+      for (const Node* curr = buckets[i]; curr != nullptr; curr = curr->next) {
+        length++;
+      }
+      stats.chain_length_histogram[std::min(length, STATS_MAX_CHAIN_LENGTH)]++;
+      stats.longest_chain = std::max(stats.longest_chain, length);
     }
-    curr = curr->next;
+  };
+  add_chains(table_, 0, num_buckets_);
+  add_chains(old_table_, migrate_index_, old_num_buckets_);
+
+  const ProbeSamples& samples = probe_samples_;
+  stats.sampled_hits = samples.hits.load(std::memory_order_relaxed);
+  stats.sampled_misses = samples.misses.load(std::memory_order_relaxed);
+  size_type hit_probes = samples.hit_probes.load(std::memory_order_relaxed);
+  size_type miss_probes = samples.miss_probes.load(std::memory_order_relaxed);
+  if (stats.sampled_hits != 0) {
+    stats.average_probes_hit = static_cast<double>(hit_probes) /
+                               static_cast<double>(stats.sampled_hits);
+  }
+  if (stats.sampled_misses != 0) {
+    stats.average_probes_miss = static_cast<double>(miss_probes) /
+                                static_cast<double>(stats.sampled_misses);
   }
-  return nullptr;
+  stats.rehash_count = rehash_count_;
+  stats.rehash_time = rehash_time_;
+  return stats;
 }
 
-template <typename K, typename V>
-const typename HashTable<K, V>::Node* HashTable<K, V>::find(
-    const key_type& key) const {
-  size_type hashed_key = hash(key);
-  const Node* curr = table_[hashed_key];
-  while (curr != nullptr) {
-    if (curr->key == key) {
-      return curr;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::reset_stats() {
+  probe_samples_.hits.store(0, std::memory_order_relaxed);
+  probe_samples_.hit_probes.store(0, std::memory_order_relaxed);
+  probe_samples_.misses.store(0, std::memory_order_relaxed);
+  probe_samples_.miss_probes.store(0, std::memory_order_relaxed);
+  rehash_count_ = 0;
+  rehash_time_ = std::chrono::nanoseconds(0);
+}
+#endif
+
+// -- Private Helper -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::bucket(
+    size_type hashed_key) {
+  if (old_num_buckets_ != 0) {
+    size_type old_index = hashed_key & (old_num_buckets_ - 1);
+    if (old_index >= migrate_index_) {
+      return old_table_[old_index];
     }
-    curr = curr->next;
   }
-  return nullptr;
+  return table_[hashed_key & (num_buckets_ - 1)];
 }
 
-template <typename K, typename V>
-bool HashTable<K, V>::contains(const key_type& key) const {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::bucket(
+    size_type hashed_key) const {
+  if (old_num_buckets_ != 0) {
+    size_type old_index = hashed_key & (old_num_buckets_ - 1);
+    if (old_index >= migrate_index_) {
+      return old_table_[old_index];
+    }
+  }
+  return table_[hashed_key & (num_buckets_ - 1)];
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+template <typename Key>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::erase_key(
+    const Key& key) {
+  rehash_step();
   size_type hashed_key = hash(key);
-  const Node* curr = table_[hashed_key];
+  Node*& head = bucket(hashed_key);
+  Node* curr = head;
+  Node* prev = nullptr;
   while (curr != nullptr) {
-    if (curr->key == key) {
-      return true;
+    if (matches(curr, hashed_key, key)) {
+      if (prev == nullptr) {
+        // Removing head of chain
+        head = curr->next;
+      } else {
+        prev->next = curr->next;
+      }
+      destroy_node(curr);
+      num_elements_--;
+      return;
     }
+    prev = curr;
     curr = curr->next;
   }
-  return false;
 }
 
-// -- HASH POLICY -- //
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+template <typename KeyArg, typename... Args>
+std::pair<typename HashTable<K, V, Hash, KeyEqual, CacheHash,
+                             NodeAlloc>::Node*, bool>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::emplace_key(KeyArg&& key,
+                                                        Args&&... args) {
+  rehash_step();
+  size_type hashed_key = hash(key);
+  Node*& head = bucket(hashed_key);
+  // Check if key already exists
+  Node* existing = find_in_chain(head, hashed_key, key);
+  if (existing != nullptr) {
+    return {existing, false};
+  }
+  Node* new_node = create_node(hashed_key, std::forward<KeyArg>(key),
+                               std::forward<Args>(args)...);
+  // Insert at head of chain
+  new_node->next = head;
+  head = new_node;
+  num_elements_++;
+  // nodes never move, so new_node survives the rehash
+  if (load_factor() > max_load_factor()) {
+    grow();
+  }
+  return {new_node, true};
+}
 
-template <typename K, typename V>
-double HashTable<K, V>::load_factor() const {
-  if (num_buckets_ == 0) {
-    return 0.0;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::grow() {
+  if (incremental_rehash_) {
+    start_rehash(num_buckets_ * 2);
+  } else {
+    rehash();
   }
-  return static_cast<double>(num_elements_) / static_cast<double>(num_buckets_);
 }
 
-template <typename K, typename V>
-double HashTable<K, V>::max_load_factor() const {
-  return MAX_LOAD_FACTOR;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::start_rehash(
+    size_type new_num_buckets) {
+  // a rehash still in flight has to land before the arrays are swapped again
+  finish_rehash();
+  auto start = rehash_timer_start();
+  old_table_ = std::move(table_);
+  old_num_buckets_ = num_buckets_;
+  migrate_index_ = 0;
+  num_buckets_ = new_num_buckets;
+  table_ = Vector<Node*>(num_buckets_, nullptr);
+#ifndef HASHTABLE_NO_STATS
+  rehash_count_++;
+#endif
+  rehash_timer_stop(start);
 }
 
-template <typename K, typename V>
-void HashTable<K, V>::rehash() {
-  size_type old_bucket_size = num_buckets_;
-  num_buckets_ *= 2;
-  Vector<Node*> new_table;
-  for (size_type i = 0; i < num_buckets_; i++) {
-    new_table.push_back(nullptr);
-  }
-  // set num_elements_ to 0 as we are going to use insert
-  std::hash<K> hasher;
-  for (size_type i = 0; i < old_bucket_size; i++) {
-    Node* curr = table_[i];
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::migrate(
+    size_type count) {
+  auto start = rehash_timer_start();
+  const size_type mask = num_buckets_ - 1;
+  size_type stop = std::min(old_num_buckets_, migrate_index_ + count);
+  for (; migrate_index_ < stop; migrate_index_++) {
+    Node* curr = old_table_[migrate_index_];
+    old_table_[migrate_index_] = nullptr;
     while (curr != nullptr) {
       Node* next_curr = curr->next;
 
-      size_type hash = hasher(curr->key) % num_buckets_;
+      size_type index = node_hash(curr) & mask;
 
-      curr->next = new_table[hash];
-      new_table[hash] = curr;
+      curr->next = table_[index];
+      table_[index] = curr;
 
       curr = next_curr;
     }
   }
-  table_ = new_table;
+  if (migrate_index_ == old_num_buckets_) {
+    old_table_ = Vector<Node*>();
+    old_num_buckets_ = 0;
+    migrate_index_ = 0;
+  }
+  rehash_timer_stop(start);
 }
 
-// -- Private Helper -- //
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::free_chains(
+    Vector<Node*>& buckets, size_type num_buckets) {
+  constexpr bool frees_in_bulk = NodeAlloc<Node>::FREES_IN_BULK;
+  // nodes_.release() takes back an arena's nodes wholesale, they only need
+  // visiting if they have destructors to run
+  if constexpr (frees_in_bulk && std::is_trivially_destructible_v<Node>) {
+    return;
+  }
+  for (size_type i = 0; i < num_buckets; ++i) {
+    Node* curr = buckets[i];
+    while (curr != nullptr) {
+      Node* temp = curr->next;
+      if constexpr (frees_in_bulk) {
+        curr->~Node();
+      } else {
+        destroy_node(curr);
+      }
+      curr = temp;
+    }
+  }
+}
 
-template <typename K, typename V>
-typename HashTable<K, V>::size_type HashTable<K, V>::hash(
-    const key_type& key) const {
-  // Use std::hash for generic types, then modulo for bucket assignment
-  std::hash<key_type> hasher;
-  return hasher(key) % num_buckets_;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::copy_chains(
+    const Vector<Node*>& from, Vector<Node*>& to, size_type num_buckets) {
+  to = Vector<Node*>(num_buckets, nullptr);
+  for (size_type i = 0; i < num_buckets; ++i) {
+    Node* other_curr = from[i];
+    Node* this_prev = nullptr;
+    while (other_curr != nullptr) {
+      Node* new_node = create_node(*other_curr);
+      if (this_prev == nullptr) {
+        to[i] = new_node;
+      } else {
+        this_prev->next = new_node;
+      }
+      this_prev = new_node;
+      other_curr = other_curr->next;
+    }
+  }
 }
 
 // ----------------------------------------------------------------------------
 // --- ITERATOR DEFINITIONS
 // ----------------------------------------------------------------------------
 
-template <typename K, typename V>
-HashTable<K, V>::iterator::iterator(HashTable* table, size_type bucket,
-                                    Node* node)
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator::iterator(
+    HashTable* table, size_type bucket, Node* node)
     : table_(table), bucket_index_(bucket), current_(node) {
   if (current_ == nullptr && table_ != nullptr) {
     advance_to_next();
   }
 }
 
-template <typename K, typename V>
-HashTable<K, V>::iterator::iterator()
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator::iterator()
     : table_(nullptr), bucket_index_(0), current_(nullptr) {}
 
-template <typename K, typename V>
-typename HashTable<K, V>::Node& HashTable<K, V>::iterator::operator*() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator::operator*() {
   return *current_;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::Node* HashTable<K, V>::iterator::operator->() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator::operator->() {
   return current_;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::iterator& HashTable<K, V>::iterator::operator++() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator&
+HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator::operator++() {
   if (current_ != nullptr) {
     current_ = current_->next;
     if (current_ == nullptr) {
@@ -777,32 +1487,41 @@ typename HashTable<K, V>::iterator& HashTable<K, V>::iterator::operator++() {
   return *this;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::iterator HashTable<K, V>::iterator::operator++(int) {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::iterator
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::iterator::operator++(int) {
   iterator temp = *this;
   ++(*this);
   return temp;
 }
 
-template <typename K, typename V>
-bool HashTable<K, V>::iterator::operator==(const iterator& other) const {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+bool HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::iterator::operator==(const iterator& other) const {
   return current_ == other.current_;
 }
 
-template <typename K, typename V>
-bool HashTable<K, V>::iterator::operator!=(const iterator& other) const {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+bool HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::iterator::operator!=(const iterator& other) const {
   return !(*this == other);
 }
 
-template <typename K, typename V>
-void HashTable<K, V>::iterator::advance_to_next() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::iterator::advance_to_next() {
   bucket_index_++;
-  while (bucket_index_ < table_->num_buckets_ &&
-         table_->table_[bucket_index_] == nullptr) {
+  while (bucket_index_ < table_->total_buckets() &&
+         table_->bucket_at(bucket_index_) == nullptr) {
     bucket_index_++;
   }
-  if (bucket_index_ < table_->num_buckets_) {
-    current_ = table_->table_[bucket_index_];
+  if (bucket_index_ < table_->total_buckets()) {
+    current_ = table_->bucket_at(bucket_index_);
   } else {
     current_ = nullptr;
   }
@@ -812,41 +1531,52 @@ void HashTable<K, V>::iterator::advance_to_next() {
 // --- CONST_ITERATOR DEFINITIONS
 // ----------------------------------------------------------------------------
 
-template <typename K, typename V>
-HashTable<K, V>::const_iterator::const_iterator(const HashTable* table,
-                                                size_type bucket,
-                                                const Node* node)
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::const_iterator(
+    const HashTable* table, size_type bucket, const Node* node)
     : table_(table), bucket_index_(bucket), current_(node) {
   if (current_ == nullptr && table_ != nullptr) {
     advance_to_next();
   }
 }
 
-template <typename K, typename V>
-HashTable<K, V>::const_iterator::const_iterator()
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::const_iterator()
     : table_(nullptr), bucket_index_(0), current_(nullptr) {}
 
-template <typename K, typename V>
-HashTable<K, V>::const_iterator::const_iterator(const iterator& it)
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::const_iterator(const iterator& it)
     : table_(it.table_),
       bucket_index_(it.bucket_index_),
       current_(it.current_) {}
 
-template <typename K, typename V>
-const typename HashTable<K, V>::Node&
-HashTable<K, V>::const_iterator::operator*() const {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+const typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node&
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::operator*() const {
   return *current_;
 }
 
-template <typename K, typename V>
-const typename HashTable<K, V>::Node*
-HashTable<K, V>::const_iterator::operator->() const {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+const typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::Node*
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::operator->() const {
   return current_;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::const_iterator&
-HashTable<K, V>::const_iterator::operator++() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::const_iterator&
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::operator++() {
   if (current_ != nullptr) {
     current_ = current_->next;
     if (current_ == nullptr) {
@@ -856,35 +1586,43 @@ HashTable<K, V>::const_iterator::operator++() {
   return *this;
 }
 
-template <typename K, typename V>
-typename HashTable<K, V>::const_iterator
-HashTable<K, V>::const_iterator::operator++(int) {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+typename HashTable<K, V, Hash, KeyEqual, CacheHash, NodeAlloc>::const_iterator
+HashTable<K, V, Hash, KeyEqual, CacheHash,
+          NodeAlloc>::const_iterator::operator++(int) {
   const_iterator temp = *this;
   ++(*this);
   return temp;
 }
 
-template <typename K, typename V>
-bool HashTable<K, V>::const_iterator::operator==(
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+bool HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::const_iterator::operator==(
     const const_iterator& other) const {
   return current_ == other.current_;
 }
 
-template <typename K, typename V>
-bool HashTable<K, V>::const_iterator::operator!=(
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+bool HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::const_iterator::operator!=(
     const const_iterator& other) const {
   return !(*this == other);
 }
 
-template <typename K, typename V>
-void HashTable<K, V>::const_iterator::advance_to_next() {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          bool CacheHash, template <typename> class NodeAlloc>
+void HashTable<K, V, Hash, KeyEqual, CacheHash,
+               NodeAlloc>::const_iterator::advance_to_next() {
   bucket_index_++;
-  while (bucket_index_ < table_->num_buckets_ &&
-         table_->table_[bucket_index_] == nullptr) {
+  while (bucket_index_ < table_->total_buckets() &&
+         table_->bucket_at(bucket_index_) == nullptr) {
     bucket_index_++;
   }
-  if (bucket_index_ < table_->num_buckets_) {
-    current_ = table_->table_[bucket_index_];
+  if (bucket_index_ < table_->total_buckets()) {
+    current_ = table_->bucket_at(bucket_index_);
   } else {
     current_ = nullptr;
   }
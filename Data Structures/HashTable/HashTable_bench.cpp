@@ -0,0 +1,326 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlatHashTable.h"
+#include "HashTable.h"
+#include "MappedHashTable.h"
+#include "RobinHoodTable.h"
+
+// Chained HashTable against the open addressing FlatHashTable and
+// RobinHoodTable. Lookups walk a shuffled key order so no table gets help from
+// the prefetcher, misses use keys that were never inserted.
+
+static std::vector<int> make_keys(size_t n, uint32_t seed) {
+  std::vector<int> keys(n);
+  std::mt19937 rng(seed);
+  for (int& key : keys) {
+    key = static_cast<int>(rng() >> 1);
+  }
+  return keys;
+}
+
+template <typename Table>
+static void BM_FindHit(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  Table table;
+  for (int key : keys) {
+    table.insert(key, key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.find(keys[i]));
+    i = i + 1 == n ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Table>
+static void BM_FindMiss(benchmark::State& state) {
+  const size_t n = state.range(0);
+  Table table;
+  for (int key : make_keys(n, 1)) {
+    table.insert(key, key);
+  }
+  // negative keys are never inserted
+  std::vector<int> misses = make_keys(n, 3);
+  for (int& key : misses) {
+    key = -key - 1;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.find(misses[i]));
+    i = i + 1 == n ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Table>
+static void BM_InsertErase(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  for (auto _ : state) {
+    Table table;
+    for (int key : keys) {
+      table.insert(key, key);
+    }
+    for (int key : keys) {
+      table.erase(key);
+    }
+    benchmark::DoNotOptimize(table.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n * 2);
+}
+
+// Times every insert into a table growing from empty to range(0) entries and
+// reports the tail, with range(1) choosing incremental rehashing. The insert
+// that triggers an all at once rehash shows up in max_ns
+static void BM_InsertTailLatency(benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  std::vector<double> latencies(n);
+  for (auto _ : state) {
+    HashTable<int, int> table;
+    table.set_incremental_rehash(state.range(1) != 0);
+    for (size_t i = 0; i < n; i++) {
+      Clock::time_point start = Clock::now();
+      table.insert(keys[i], keys[i]);
+      latencies[i] =
+          std::chrono::duration<double, std::nano>(Clock::now() - start)
+              .count();
+    }
+    benchmark::DoNotOptimize(table.size());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p99_ns"] = latencies[n * 99 / 100];
+  state.counters["p9999_ns"] = latencies[n * 9999 / 10000];
+  state.counters["max_ns"] = latencies[n - 1];
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_InsertTailLatency)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// String keys looked up through std::string_view, as a request path holding
+// a slice of its input would. Without transparent hashing every lookup has to
+// build a std::string first
+template <typename Table>
+static void BM_FindStringView(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<std::string> keys;
+  for (int key : make_keys(n, 1)) {
+    // long enough to miss the small string buffer
+    keys.push_back("request/path/segment/" + std::to_string(key));
+  }
+  Table table;
+  for (size_t i = 0; i < n; i++) {
+    table.insert(keys[i], static_cast<int>(i));
+  }
+  std::vector<std::string_view> views(keys.begin(), keys.end());
+  std::shuffle(views.begin(), views.end(), std::mt19937(2));
+  size_t i = 0;
+  for (auto _ : state) {
+    if constexpr (hash_table_is_transparent<typename Table::key_equal>) {
+      benchmark::DoNotOptimize(table.find(views[i]));
+    } else {
+      benchmark::DoNotOptimize(table.find(std::string(views[i])));
+    }
+    i = i + 1 == n ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+using StringTable = HashTable<std::string, int>;
+using TransparentStringTable =
+    HashTable<std::string, int, XXHash<std::string>, std::equal_to<>>;
+
+BENCHMARK_TEMPLATE(BM_FindStringView, StringTable)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_FindStringView, TransparentStringTable)->Arg(1 << 16);
+
+// Robin Hood lookups with the table pinned at range(0) percent full, to see
+// how hit and miss cost grows with the load factor
+static constexpr size_t SWEEP_CAPACITY = 1 << 16;
+
+static RobinHoodTable<int, int> make_loaded_table(double load,
+                                                  std::vector<int>& keys) {
+  RobinHoodTable<int, int> table(SWEEP_CAPACITY, 0.99);
+  keys = make_keys(static_cast<size_t>(SWEEP_CAPACITY * load), 1);
+  for (int key : keys) {
+    table.insert(key, key);
+  }
+  return table;
+}
+
+static void BM_RobinHoodHitAtLoad(benchmark::State& state) {
+  std::vector<int> keys;
+  RobinHoodTable<int, int> table =
+      make_loaded_table(state.range(0) / 100.0, keys);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.find(keys[i]));
+    i = i + 1 == keys.size() ? 0 : i + 1;
+  }
+  state.counters["load"] = table.load_factor();
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_RobinHoodMissAtLoad(benchmark::State& state) {
+  std::vector<int> keys;
+  RobinHoodTable<int, int> table =
+      make_loaded_table(state.range(0) / 100.0, keys);
+  std::vector<int> misses = make_keys(keys.size(), 3);
+  for (int& key : misses) {
+    key = -key - 1;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.find(misses[i]));
+    i = i + 1 == misses.size() ? 0 : i + 1;
+  }
+  state.counters["load"] = table.load_factor();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RobinHoodHitAtLoad)->Arg(50)->Arg(75)->Arg(90)->Arg(95);
+BENCHMARK(BM_RobinHoodMissAtLoad)->Arg(50)->Arg(75)->Arg(90)->Arg(95);
+
+// Copies a table of range(0) entries, one allocation per node with the
+// default NodeHeap against a single slab with NodeArena
+template <typename Table>
+static void BM_CopyTable(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  Table table;
+  for (int key : keys) {
+    table.insert(key, key);
+  }
+  for (auto _ : state) {
+    Table copy = table;
+    benchmark::DoNotOptimize(copy.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Fills an empty table with range(0) entries, reserving up front when
+// range(1) is set
+template <typename Table>
+static void BM_Fill(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  for (auto _ : state) {
+    Table table;
+    if (state.range(1) != 0) {
+      table.reserve(n);
+    }
+    for (int key : keys) {
+      table.insert(key, key);
+    }
+    benchmark::DoNotOptimize(table.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+using ChainedArena =
+    HashTable<int, int, XXHash<int>, std::equal_to<int>, true, NodeArena>;
+
+BENCHMARK_TEMPLATE(BM_CopyTable, HashTable<int, int>)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_CopyTable, ChainedArena)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fill, HashTable<int, int>)
+    ->ArgsProduct({{1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fill, ChainedArena)
+    ->ArgsProduct({{1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Startup cost of a lookup table of range(0) entries: rebuilding it from
+// its source data against mapping a snapshot, with and without checking
+// the checksum. Lookups then go straight to the mapping
+static const char* SNAPSHOT_PATH = "/tmp/hashtable_bench.snapshot";
+
+static void BM_RebuildTable(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  for (auto _ : state) {
+    HashTable<int, int> table;
+    for (int key : keys) {
+      table.insert(key, key);
+    }
+    benchmark::DoNotOptimize(table.size());
+  }
+}
+
+static void BM_OpenSnapshot(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  HashTable<int, int> table;
+  for (int key : keys) {
+    table.insert(key, key);
+  }
+  MappedHashTable<int, int>::save(table, SNAPSHOT_PATH);
+  for (auto _ : state) {
+    auto mapped =
+        MappedHashTable<int, int>::open(SNAPSHOT_PATH, state.range(1) != 0);
+    benchmark::DoNotOptimize(mapped.size());
+  }
+  std::remove(SNAPSHOT_PATH);
+}
+
+static void BM_MappedFindHit(benchmark::State& state) {
+  const size_t n = state.range(0);
+  std::vector<int> keys = make_keys(n, 1);
+  HashTable<int, int> table;
+  for (int key : keys) {
+    table.insert(key, key);
+  }
+  MappedHashTable<int, int>::save(table, SNAPSHOT_PATH);
+  auto mapped = MappedHashTable<int, int>::open(SNAPSHOT_PATH);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mapped.find(keys[i]));
+    i = i + 1 == n ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  std::remove(SNAPSHOT_PATH);
+}
+
+BENCHMARK(BM_RebuildTable)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OpenSnapshot)
+    ->ArgsProduct({{1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MappedFindHit)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+
+#define TABLE_BENCHMARKS(Table)                                         \
+  BENCHMARK_TEMPLATE(BM_FindHit, Table)->RangeMultiplier(32)->Range(    \
+      1 << 10, 1 << 20);                                                \
+  BENCHMARK_TEMPLATE(BM_FindMiss, Table)->RangeMultiplier(32)->Range(   \
+      1 << 10, 1 << 20);                                                \
+  BENCHMARK_TEMPLATE(BM_InsertErase, Table)->RangeMultiplier(32)->Range( \
+      1 << 10, 1 << 20)
+
+using Chained = HashTable<int, int>;
+using Flat = FlatHashTable<int, int>;
+using RobinHood = RobinHoodTable<int, int>;
+
+TABLE_BENCHMARKS(Chained);
+TABLE_BENCHMARKS(Flat);
+TABLE_BENCHMARKS(RobinHood);
+
+BENCHMARK_MAIN();
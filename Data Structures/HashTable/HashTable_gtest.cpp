@@ -1,6 +1,28 @@
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+
 #include "HashTable.h"
 #include "gtest/gtest.h"
 
+// counts heap allocations so tests can check a call makes none
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
 TEST(HashTableTest, default_constructor) {
   HashTable<int, int> ht;
   ASSERT_EQ(ht.size(), 0);
@@ -228,25 +250,388 @@ TEST(HashTableTest, const_find) {
 TEST(HashTableTest, load_Factor) {
   HashTable<int, int> ht;
   ASSERT_EQ(ht.load_factor(), 0.0);
-  ht.insert(0, 0);
-  ASSERT_EQ(ht.load_factor(), 0.1);
-  ht.insert(1, 1);
-  ASSERT_EQ(ht.load_factor(), 0.2);
-  ht.insert(2, 0);
-  ASSERT_EQ(ht.load_factor(), 0.3);
-  ht.insert(3, 0);
-  ASSERT_EQ(ht.load_factor(), 0.4);
-  ht.insert(4, 0);
-  ASSERT_EQ(ht.load_factor(), 0.5);
-  ht.insert(5, 0);
-  ASSERT_EQ(ht.load_factor(), 0.6);
-  ht.insert(6, 0);
-  ASSERT_EQ(ht.load_factor(), 0.7);
-  ht.insert(7, 0);
-  ASSERT_EQ(ht.load_factor(), 0.4);
+  ASSERT_EQ(ht.bucket_count(), 16);
+  for (int i = 0; i < 12; i++) {
+    ht.insert(i, 0);
+    ASSERT_EQ(ht.load_factor(), (i + 1) / 16.0);
+  }
+  // the 13th element crosses 0.75 and doubles the buckets
+  ht.insert(12, 0);
+  ASSERT_EQ(ht.bucket_count(), 32);
+  ASSERT_EQ(ht.load_factor(), 13 / 32.0);
 }
 
 TEST(HashTableTest, max_load_factor) {
   HashTable<int, int> ht;
   ASSERT_EQ(ht.max_load_factor(), 0.75);
 }
+
+TEST(HashTableTest, incremental_rehash) {
+  HashTable<int, int> ht;
+  ht.set_incremental_rehash(true);
+  ASSERT_TRUE(ht.incremental_rehash());
+  bool saw_rehash = false;
+  for (int i = 0; i < 2000; i++) {
+    ht.insert(i, i);
+    saw_rehash = saw_rehash || ht.rehashing();
+    // every key stays reachable while buckets are split across both arrays
+    if (ht.rehashing()) {
+      for (int j = 0; j <= i; j++) {
+        ASSERT_EQ(ht.at(j), j);
+      }
+    }
+    ASSERT_LE(ht.load_factor(), ht.max_load_factor());
+  }
+  ASSERT_TRUE(saw_rehash);
+  ASSERT_EQ(ht.size(), 2000);
+}
+
+TEST(HashTableTest, operations_during_incremental_rehash) {
+  HashTable<int, int> ht;
+  ht.set_incremental_rehash(true);
+  int n = 0;
+  while (!ht.rehashing()) {
+    ht.insert(n, n);
+    n++;
+  }
+  // erase and overwrite keys that still sit in old buckets
+  ht.erase(0);
+  ht.insert_or_assign(1, 100);
+  ht[n] = n;
+  ASSERT_FALSE(ht.contains(0));
+  ASSERT_EQ(ht.at(1), 100);
+
+  size_t count = 0;
+  for (auto it = ht.begin(); it != ht.end(); ++it) {
+    count++;
+  }
+  ASSERT_EQ(count, ht.size());
+
+  HashTable<int, int> copy = ht;
+  HashTable<int, int> moved = std::move(ht);
+  for (int i = 1; i <= n; i++) {
+    ASSERT_EQ(copy.at(i), i == 1 ? 100 : i);
+    ASSERT_EQ(moved.at(i), i == 1 ? 100 : i);
+  }
+
+  // turning it off lands the rehash in progress
+  moved.set_incremental_rehash(false);
+  ASSERT_FALSE(moved.rehashing());
+  ASSERT_EQ(moved.size(), static_cast<size_t>(n));
+}
+
+// Hash and KeyEqual that ignore case
+struct CaseInsensitiveHash {
+  size_t operator()(const std::string& key) const {
+    std::string lower;
+    for (char c : key) {
+      lower += static_cast<char>(std::tolower(c));
+    }
+    return XXHash<std::string>{}(lower);
+  }
+};
+
+struct CaseInsensitiveEqual {
+  bool operator()(const std::string& a, const std::string& b) const {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+      if (std::tolower(a[i]) != std::tolower(b[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+TEST(HashTableTest, custom_hash_and_key_equal) {
+  HashTable<std::string, int, CaseInsensitiveHash, CaseInsensitiveEqual> ht;
+  ht.insert("Hello", 1);
+  ht.insert("HELLO", 2);
+  ASSERT_EQ(ht.size(), 1);
+  ASSERT_EQ(ht.at("hello"), 1);
+  ht.erase("hElLo");
+  ASSERT_TRUE(ht.empty());
+}
+
+// every key lands in one bucket, so every lookup is a full chain walk
+struct ConstantHash {
+  size_t operator()(int) const { return 42; }
+};
+
+TEST(HashTableTest, colliding_hash) {
+  HashTable<int, int, ConstantHash> ht;
+  for (int i = 0; i < 100; i++) {
+    ht.insert(i, i);
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(ht.at(i), i);
+  }
+  ht.erase(50);
+  ASSERT_FALSE(ht.contains(50));
+  ASSERT_EQ(ht.size(), 99);
+}
+
+TEST(HashTableTest, without_cached_hash) {
+  HashTable<std::string, int, XXHash<std::string>, std::equal_to<std::string>,
+            false>
+      ht;
+  ht.set_incremental_rehash(true);
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(std::to_string(i), i);
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(ht.at(std::to_string(i)), i);
+  }
+  // power of two bucket counts all the way up
+  ASSERT_EQ(ht.bucket_count() & (ht.bucket_count() - 1), 0);
+  HashTable<std::string, int, XXHash<std::string>, std::equal_to<std::string>,
+            false>
+      copy = ht;
+  ASSERT_EQ(copy.at("999"), 999);
+}
+
+TEST(HashTableTest, try_emplace) {
+  HashTable<std::string, std::unique_ptr<int>> ht;
+  auto [node, inserted] = ht.try_emplace("a", new int(1));
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(*node->value, 1);
+
+  // a duplicate key leaves the arguments alone
+  std::unique_ptr<int> value(new int(2));
+  std::tie(node, inserted) = ht.try_emplace("a", std::move(value));
+  ASSERT_FALSE(inserted);
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(*node->value, 1);
+
+  // default constructed value
+  std::tie(node, inserted) = ht.try_emplace("b");
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(node->value, nullptr);
+  ASSERT_EQ(ht.size(), 2);
+}
+
+TEST(HashTableTest, emplace) {
+  HashTable<std::string, std::string> ht;
+  // key built from a const char*, value from (count, char)
+  auto [node, inserted] = ht.emplace("key", 3, 'x');
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(node->key, "key");
+  ASSERT_EQ(ht.at("key"), "xxx");
+  ASSERT_FALSE(ht.emplace("key", 1, 'y').second);
+  ASSERT_EQ(ht.at("key"), "xxx");
+}
+
+TEST(HashTableTest, rvalue_insert) {
+  HashTable<int, std::unique_ptr<int>> ht;
+  ht.insert(1, std::make_unique<int>(1));
+  ht.insert(1, std::make_unique<int>(100));
+  ASSERT_EQ(*ht.at(1), 1);
+  ht.insert_or_assign(1, std::make_unique<int>(2));
+  ASSERT_EQ(*ht.at(1), 2);
+  ht.insert_or_assign(2, std::make_unique<int>(3));
+  ASSERT_EQ(*ht.at(2), 3);
+  ASSERT_EQ(*ht[1], 2);
+  ASSERT_EQ(ht[3], nullptr);
+  ASSERT_EQ(ht.size(), 3);
+}
+
+TEST(HashTableTest, heterogeneous_lookup) {
+  HashTable<std::string, int, XXHash<std::string>, std::equal_to<>> ht;
+  // longer than any small string buffer, so a temporary would allocate
+  const std::string key = "a key far too long for small string optimization";
+  ht.insert(key, 1);
+  std::string_view view = key;
+  const char* c_str = key.c_str();
+
+  size_t before = allocations;
+  ASSERT_NE(ht.find(view), nullptr);
+  ASSERT_NE(ht.find(c_str), nullptr);
+  ASSERT_TRUE(ht.contains(view));
+  ASSERT_FALSE(ht.contains("missing"));
+  ASSERT_EQ(ht.at(c_str), 1);
+  const auto& cht = ht;
+  ASSERT_EQ(cht.at(view), 1);
+  ASSERT_NE(cht.find(view), nullptr);
+  ASSERT_EQ(allocations, before);
+  ASSERT_THROW(cht.at(std::string_view("missing")), std::out_of_range);
+
+  ht.erase(view);
+  ASSERT_TRUE(ht.empty());
+}
+
+TEST(HashTableTest, reserve) {
+  HashTable<int, int> ht;
+  ht.reserve(1000);
+  size_t buckets = ht.bucket_count();
+  ASSERT_GE(buckets * ht.max_load_factor(), 1000);
+  ASSERT_FALSE(ht.rehashing());
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.bucket_count(), buckets);
+
+  // never shrinks, and keeps every element when it grows a full table
+  ht.reserve(10);
+  ASSERT_EQ(ht.bucket_count(), buckets);
+  ht.reserve(10000);
+  ASSERT_GT(ht.bucket_count(), buckets);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(ht.at(i), i);
+  }
+}
+
+TEST(HashTableTest, clear) {
+  HashTable<int, std::string> ht;
+  ht.set_incremental_rehash(true);
+  for (int i = 0; i < 100; i++) {
+    ht.insert(i, std::to_string(i));
+  }
+  size_t buckets = ht.bucket_count();
+  ht.clear();
+  ASSERT_TRUE(ht.empty());
+  ASSERT_FALSE(ht.rehashing());
+  ASSERT_EQ(ht.bucket_count(), buckets);
+  ASSERT_EQ(ht.begin(), ht.end());
+  ASSERT_FALSE(ht.contains(1));
+  ht.insert(1, "1");
+  ASSERT_EQ(ht.at(1), "1");
+}
+
+template <typename K, typename V>
+using ArenaTable = HashTable<K, V, XXHash<K>, std::equal_to<K>, true,
+                             NodeArena>;
+
+TEST(HashTableTest, arena_nodes) {
+  // std::string values have destructors that must still run
+  ArenaTable<int, std::string> ht;
+  for (int i = 0; i < 10000; i++) {
+    ht.insert(i, std::to_string(i));
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    ht.erase(i);
+  }
+  for (int i = 0; i < 10000; i += 2) {
+    ht.insert(i, std::to_string(-i));
+  }
+  ASSERT_EQ(ht.size(), 10000);
+
+  ArenaTable<int, std::string> copy = ht;
+  ArenaTable<int, std::string> moved = std::move(ht);
+  ASSERT_TRUE(ht.empty());
+  ht.insert(1, "again");
+  for (int i = 0; i < 10000; i++) {
+    std::string expected = std::to_string(i % 2 == 0 ? -i : i);
+    ASSERT_EQ(copy.at(i), expected);
+    ASSERT_EQ(moved.at(i), expected);
+  }
+
+  copy = moved;
+  moved.clear();
+  ASSERT_TRUE(moved.empty());
+  moved.insert(5, "5");
+  ASSERT_EQ(moved.at(5), "5");
+  ASSERT_EQ(copy.size(), 10000);
+  moved = std::move(copy);
+  ASSERT_EQ(moved.size(), 10000);
+}
+
+TEST(HashTableTest, arena_copy_allocates_in_bulk) {
+  ArenaTable<int, int> ht;
+  HashTable<int, int> heap_ht;
+  for (int i = 0; i < 10000; i++) {
+    ht.insert(i, i);
+    heap_ht.insert(i, i);
+  }
+
+  // the bucket arrays and a single slab for every node
+  size_t before = allocations;
+  ArenaTable<int, int> copy = ht;
+  ASSERT_LT(allocations - before, 10);
+  ASSERT_EQ(copy.size(), 10000);
+
+  before = allocations;
+  HashTable<int, int> heap_copy = heap_ht;
+  ASSERT_GE(allocations - before, 10000);
+
+  // nor does a reserved table allocate per insert
+  ArenaTable<int, int> reserved;
+  reserved.reserve(10000);
+  before = allocations;
+  for (int i = 0; i < 10000; i++) {
+    reserved.insert(i, i);
+  }
+  ASSERT_EQ(allocations, before);
+}
+
+#ifndef HASHTABLE_NO_STATS
+TEST(HashTableTest, stats_chain_histogram) {
+  HashTable<int, int> ht;
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(i, i);
+  }
+  HashTableStats stats = ht.stats();
+  size_t buckets = 0;
+  for (size_t count : stats.chain_length_histogram) {
+    buckets += count;
+  }
+  ASSERT_EQ(buckets, ht.bucket_count());
+  ASSERT_GE(stats.longest_chain, 1);
+  ASSERT_LT(stats.longest_chain, STATS_MAX_CHAIN_LENGTH);
+  ASSERT_EQ(stats.load_factor, ht.load_factor());
+
+  // a well spread table compares about one node per lookup
+  for (int i = 0; i < 64 * 100; i++) {
+    ht.contains(i % 2000);
+  }
+  stats = ht.stats();
+  ASSERT_GE(stats.sampled_hits + stats.sampled_misses, 99);
+  ASSERT_GE(stats.average_probes_hit, 1.0);
+  ASSERT_LT(stats.average_probes_hit, 2.0);
+  ASSERT_LT(stats.average_probes_miss, 2.0);
+}
+
+TEST(HashTableTest, stats_bad_hash) {
+  HashTable<int, int, ConstantHash> ht;
+  for (int i = 0; i < 100; i++) {
+    ht.insert(i, i);
+  }
+  HashTableStats stats = ht.stats();
+  ASSERT_EQ(stats.longest_chain, 100);
+  ASSERT_EQ(stats.chain_length_histogram[STATS_MAX_CHAIN_LENGTH], 1);
+  ASSERT_EQ(stats.chain_length_histogram[0], ht.bucket_count() - 1);
+
+  // every miss walks the whole chain
+  for (int i = 0; i < 64 * 10; i++) {
+    ht.find(-1);
+  }
+  stats = ht.stats();
+  ASSERT_GE(stats.sampled_misses, 9);
+  ASSERT_EQ(stats.average_probes_miss, 100.0);
+  ASSERT_EQ(stats.sampled_hits, 0);
+}
+
+TEST(HashTableTest, stats_rehashes) {
+  HashTable<int, int> ht;
+  // 16 buckets doubling to 2048, the first size that keeps 1000 under 0.75
+  for (int i = 0; i < 1000; i++) {
+    ht.insert(i, i);
+  }
+  HashTableStats stats = ht.stats();
+  ASSERT_EQ(stats.rehash_count, 7);
+  ASSERT_GT(stats.rehash_time.count(), 0);
+
+  ht.reset_stats();
+  stats = ht.stats();
+  ASSERT_EQ(stats.rehash_count, 0);
+  ASSERT_EQ(stats.rehash_time.count(), 0);
+  ASSERT_EQ(stats.sampled_hits, 0);
+
+  ht.set_incremental_rehash(true);
+  for (int i = 1000; i < 2000; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.stats().rehash_count, 1);
+}
+#endif
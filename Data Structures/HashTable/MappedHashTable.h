@@ -0,0 +1,475 @@
+#ifndef MAPPED_HASHTABLE_H_
+#define MAPPED_HASHTABLE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define XXH_INLINE_ALL
+#include "../BloomFilter/xxhash.h"
+
+// Slots per entry in a snapshot, at half full a linear probe miss still ends
+// within a couple of slots
+inline constexpr double SNAPSHOT_MAX_LOAD_FACTOR = 0.5;
+
+inline constexpr char SNAPSHOT_MAGIC[8] = {'H', 'T', 'S', 'N', 'A', 'P', 0, 0};
+inline constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// Written as a native integer, so a snapshot opened on a machine with the
+// other byte order is rejected instead of misread
+inline constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+/**
+ * First bytes of a snapshot file. Every offset is relative to the start of
+ * the file, so the file can be mapped at any address.
+ */
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t checksum;  // XXH3 of every byte after the header
+  uint64_t file_size;
+  uint64_t num_elements;
+  uint64_t num_slots;     // power of two
+  uint64_t slots_offset;  // num_slots SnapshotSlots
+  uint64_t blob_offset;   // keys and values, 8 byte aligned per entry
+  uint32_t key_width;     // sizeof the key type, 0 for strings
+  uint32_t value_width;   // sizeof the value type, 0 for strings
+};
+
+/**
+ * One open addressing slot. The key's bytes start at blob_offset + offset
+ * and its value's bytes follow right after them
+ */
+struct SnapshotSlot {
+  uint64_t hash;
+  uint64_t offset;  // EMPTY_OFFSET when the slot is free
+  uint32_t key_size;
+  uint32_t value_size;
+
+  static constexpr uint64_t EMPTY_OFFSET = ~uint64_t{0};
+};
+
+/**
+ * How a type is laid out in a snapshot. Strings are stored as their bytes
+ * and read back as std::string_view into the mapping; trivially copyable
+ * types are stored as their object representation and read back by value.
+ */
+template <typename T, typename = void>
+struct SnapshotCodec;
+
+template <typename T>
+struct SnapshotCodec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+  using view_type = T;
+  static constexpr uint32_t WIDTH = sizeof(T);
+
+  static std::string_view bytes(const T& value) {
+    return {reinterpret_cast<const char*>(&value), sizeof(T)};
+  }
+
+  static T read(const char* data, std::size_t) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+  }
+};
+
+template <>
+struct SnapshotCodec<std::string> {
+  using view_type = std::string_view;
+  static constexpr uint32_t WIDTH = 0;
+
+  static std::string_view bytes(std::string_view value) { return value; }
+
+  static std::string_view read(const char* data, std::size_t size) {
+    return {data, size};
+  }
+};
+
+/**
+ * Read-only view of a HashTable snapshot file.
+ *
+ * save() writes any table whose iterators expose key and value (HashTable,
+ * FlatHashTable, RobinHoodTable) into a single file: a header, an open
+ * addressing slot array and a blob holding the keys and values. open() maps
+ * that file and find() probes the mapping directly, nothing is copied or
+ * rebuilt, so opening costs the same for ten entries or a hundred million
+ * and every process that opens the same file shares its page cache.
+ *
+ * Keys are hashed and compared by their stored bytes with XXH3, never with
+ * the table's Hash, so a snapshot stays valid across builds and processes.
+ * Keys therefore have to be std::string or have a unique object
+ * representation (no padding, no floating point).
+ *
+ * Strings come back as std::string_view into the mapping and stay valid
+ * for as long as the MappedHashTable does.
+ */
+template <typename K, typename V>
+class MappedHashTable {
+  static_assert(std::is_same_v<K, std::string> ||
+                    std::has_unique_object_representations_v<K>,
+                "snapshot keys are compared byte for byte");
+
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+  using key_view = typename SnapshotCodec<K>::view_type;
+  using value_view = typename SnapshotCodec<V>::view_type;
+
+  /**
+   * Writes table to a snapshot at path. The file is written next to path
+   * and renamed over it, so a process still mapping the old snapshot keeps
+   * reading the old contents
+   *
+   * ARGS:
+   * table: the table to save
+   * path: where the snapshot goes
+   *
+   * THROWS:
+   * std::length_error if a key or value is 4 GiB or longer
+   * std::system_error if the file cannot be written
+   */
+  template <typename Table>
+  static void save(const Table& table, const std::string& path);
+
+  /**
+   * Maps the snapshot at path
+   *
+   * ARGS:
+   * path: the snapshot file
+   * verify_checksum: hashes the whole file against the header's checksum.
+   * Skipping it makes opening O(1), pages are then only read as lookups
+   * touch them
+   *
+   * THROWS:
+   * std::system_error if the file cannot be opened or mapped
+   * std::runtime_error if it is not a snapshot of K and V, or it is corrupt
+   */
+  static MappedHashTable open(const std::string& path,
+                              bool verify_checksum = true);
+
+  MappedHashTable(const MappedHashTable& other) = delete;
+  MappedHashTable& operator=(const MappedHashTable& other) = delete;
+
+  MappedHashTable(MappedHashTable&& other) noexcept
+      : base_(std::exchange(other.base_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        blob_(std::exchange(other.blob_, nullptr)),
+        blob_size_(std::exchange(other.blob_size_, 0)),
+        num_elements_(std::exchange(other.num_elements_, 0)),
+        mask_(std::exchange(other.mask_, 0)) {}
+
+  MappedHashTable& operator=(MappedHashTable&& other) noexcept {
+    if (this != &other) {
+      reset();
+      base_ = std::exchange(other.base_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      slots_ = std::exchange(other.slots_, nullptr);
+      blob_ = std::exchange(other.blob_, nullptr);
+      blob_size_ = std::exchange(other.blob_size_, 0);
+      num_elements_ = std::exchange(other.num_elements_, 0);
+      mask_ = std::exchange(other.mask_, 0);
+    }
+    return *this;
+  }
+
+  /**
+   * Unmaps the file
+   */
+  ~MappedHashTable() { reset(); }
+
+  // -- CAPACITY -- //
+
+  bool empty() const { return num_elements_ == 0; }
+
+  size_type size() const { return num_elements_; }
+
+  // -- LOOKUP -- //
+
+  /**
+   * Finds the value stored for key
+   *
+   * ARGS:
+   * key: the key to search for, std::string keys take any string_view
+   *
+   * RETURNS:
+   * the value, or std::nullopt if key is not in the snapshot
+   *
+   * THROWS:
+   * std::runtime_error if the slot found points outside the file, which only
+   * a corrupt file opened without verify_checksum can do
+   */
+  std::optional<value_view> find(const key_view& key) const;
+
+  /**
+   * RETURNS:
+   * true if key is in the snapshot, else false
+   */
+  bool contains(const key_view& key) const { return find(key).has_value(); }
+
+  /**
+   * Accesses the value stored for key
+   *
+   * RETURNS:
+   * the value
+   *
+   * THROWS:
+   * std::out_of_range if key is not found
+   */
+  value_view at(const key_view& key) const {
+    std::optional<value_view> value = find(key);
+    if (!value) {
+      throw std::out_of_range("MappedHashTable::at: key not found");
+    }
+    return *value;
+  }
+
+ private:
+  MappedHashTable() = default;
+
+  static uint64_t hash_bytes(std::string_view bytes) {
+    return XXH3_64bits(bytes.data(), bytes.size());
+  }
+
+  static std::size_t align_entry(std::size_t offset) {
+    return (offset + 7) & ~std::size_t{7};
+  }
+
+  static void write_file(const std::string& path,
+                         const std::vector<char>& file);
+
+  // checks the header against the mapped file before anything trusts it
+  void validate(bool verify_checksum) const;
+
+  void reset() {
+    if (base_ != nullptr) {
+      ::munmap(const_cast<char*>(base_), size_);
+      base_ = nullptr;
+    }
+    size_ = 0;
+  }
+
+  const char* base_ = nullptr;
+  size_type size_ = 0;
+  const SnapshotSlot* slots_ = nullptr;
+  const char* blob_ = nullptr;
+  size_type blob_size_ = 0;
+  size_type num_elements_ = 0;
+  size_type mask_ = 0;
+};
+
+// ----------------------------------------------------------------------------
+// --- MEMBER FUNCTION DEFINITIONS
+// ----------------------------------------------------------------------------
+
+template <typename K, typename V>
+template <typename Table>
+void MappedHashTable<K, V>::save(const Table& table, const std::string& path) {
+  size_type num_slots = 1;
+  while (static_cast<double>(table.size()) >
+         num_slots * SNAPSHOT_MAX_LOAD_FACTOR) {
+    num_slots *= 2;
+  }
+  std::vector<SnapshotSlot> slots(num_slots);
+  for (SnapshotSlot& slot : slots) {
+    slot = SnapshotSlot{0, SnapshotSlot::EMPTY_OFFSET, 0, 0};
+  }
+
+  std::vector<char> blob;
+  for (const auto& entry : table) {
+    std::string_view key = SnapshotCodec<K>::bytes(entry.key);
+    std::string_view value = SnapshotCodec<V>::bytes(entry.value);
+    if (key.size() > UINT32_MAX || value.size() > UINT32_MAX) {
+      throw std::length_error("MappedHashTable::save: entry too large");
+    }
+    size_type offset = align_entry(blob.size());
+    blob.resize(offset + key.size() + value.size());
+    std::memcpy(blob.data() + offset, key.data(), key.size());
+    std::memcpy(blob.data() + offset + key.size(), value.data(), value.size());
+
+    uint64_t hash = hash_bytes(key);
+    size_type index = hash & (num_slots - 1);
+    while (slots[index].offset != SnapshotSlot::EMPTY_OFFSET) {
+      index = (index + 1) & (num_slots - 1);
+    }
+    slots[index] = SnapshotSlot{hash, offset, static_cast<uint32_t>(key.size()),
+                                static_cast<uint32_t>(value.size())};
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.num_elements = table.size();
+  header.num_slots = num_slots;
+  header.slots_offset = sizeof(SnapshotHeader);
+  header.blob_offset = header.slots_offset + num_slots * sizeof(SnapshotSlot);
+  header.file_size = header.blob_offset + blob.size();
+  header.key_width = SnapshotCodec<K>::WIDTH;
+  header.value_width = SnapshotCodec<V>::WIDTH;
+
+  std::vector<char> file(header.file_size);
+  std::memcpy(file.data() + header.slots_offset, slots.data(),
+              num_slots * sizeof(SnapshotSlot));
+  if (!blob.empty()) {
+    std::memcpy(file.data() + header.blob_offset, blob.data(), blob.size());
+  }
+  header.checksum = XXH3_64bits(file.data() + sizeof(SnapshotHeader),
+                                file.size() - sizeof(SnapshotHeader));
+  std::memcpy(file.data(), &header, sizeof(SnapshotHeader));
+  write_file(path, file);
+}
+
+template <typename K, typename V>
+void MappedHashTable<K, V>::write_file(const std::string& path,
+                                       const std::vector<char>& file) {
+  std::string temp_path = path + ".tmp";
+  int fd = ::open(temp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC,
+                  0644);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open");
+  }
+  size_type written = 0;
+  while (written < file.size()) {
+    ssize_t n = ::write(fd, file.data() + written, file.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int err = errno;
+      ::close(fd);
+      ::unlink(temp_path.c_str());
+      throw std::system_error(err, std::generic_category(), "write");
+    }
+    written += static_cast<size_type>(n);
+  }
+  if (::fsync(fd) != 0 || ::close(fd) != 0) {
+    int err = errno;
+    ::unlink(temp_path.c_str());
+    throw std::system_error(err, std::generic_category(), "fsync");
+  }
+  if (::rename(temp_path.c_str(), path.c_str()) != 0) {
+    int err = errno;
+    ::unlink(temp_path.c_str());
+    throw std::system_error(err, std::generic_category(), "rename");
+  }
+}
+
+template <typename K, typename V>
+MappedHashTable<K, V> MappedHashTable<K, V>::open(const std::string& path,
+                                                  bool verify_checksum) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "open");
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category(), "fstat");
+  }
+  size_type size = static_cast<size_type>(st.st_size);
+  if (size < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    throw std::runtime_error("MappedHashTable::open: not a snapshot");
+  }
+  // the mapping outlives the descriptor
+  void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+
+  MappedHashTable table;
+  table.base_ = static_cast<const char*>(base);
+  table.size_ = size;
+  table.validate(verify_checksum);
+
+  const auto* header = reinterpret_cast<const SnapshotHeader*>(table.base_);
+  table.slots_ =
+      reinterpret_cast<const SnapshotSlot*>(table.base_ + header->slots_offset);
+  table.blob_ = table.base_ + header->blob_offset;
+  table.blob_size_ = size - header->blob_offset;
+  table.num_elements_ = header->num_elements;
+  table.mask_ = header->num_slots - 1;
+  // lookups land anywhere in the file, read ahead would only waste IO
+  ::madvise(base, size, MADV_RANDOM);
+  return table;
+}
+
+template <typename K, typename V>
+void MappedHashTable<K, V>::validate(bool verify_checksum) const {
+  const auto* header = reinterpret_cast<const SnapshotHeader*>(base_);
+  if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != SNAPSHOT_VERSION ||
+      header->byte_order != SNAPSHOT_BYTE_ORDER) {
+    throw std::runtime_error("MappedHashTable::open: not a snapshot");
+  }
+  if (header->key_width != SnapshotCodec<K>::WIDTH ||
+      header->value_width != SnapshotCodec<V>::WIDTH) {
+    throw std::runtime_error("MappedHashTable::open: wrong key or value type");
+  }
+  uint64_t num_slots = header->num_slots;
+  uint64_t max_slots = (size_ - sizeof(SnapshotHeader)) / sizeof(SnapshotSlot);
+  if (header->file_size != size_ || num_slots == 0 ||
+      (num_slots & (num_slots - 1)) != 0 || num_slots > max_slots ||
+      header->num_elements >= num_slots ||
+      header->slots_offset != sizeof(SnapshotHeader) ||
+      header->blob_offset !=
+          header->slots_offset + num_slots * sizeof(SnapshotSlot)) {
+    throw std::runtime_error("MappedHashTable::open: corrupt header");
+  }
+  if (verify_checksum &&
+      XXH3_64bits(base_ + sizeof(SnapshotHeader),
+                  size_ - sizeof(SnapshotHeader)) != header->checksum) {
+    throw std::runtime_error("MappedHashTable::open: checksum mismatch");
+  }
+}
+
+template <typename K, typename V>
+std::optional<typename MappedHashTable<K, V>::value_view>
+MappedHashTable<K, V>::find(const key_view& key) const {
+  std::string_view bytes = SnapshotCodec<K>::bytes(key);
+  uint64_t hash = hash_bytes(bytes);
+  size_type index = hash & mask_;
+  // at most half the slots are full, so a probe normally ends at an empty
+  // slot long before it could wrap around
+  for (size_type probes = 0; probes <= mask_; probes++) {
+    const SnapshotSlot& slot = slots_[index];
+    index = (index + 1) & mask_;
+    if (slot.offset == SnapshotSlot::EMPTY_OFFSET) {
+      return std::nullopt;
+    }
+    if (slot.hash != hash || slot.key_size != bytes.size()) {
+      continue;
+    }
+    if (slot.offset > blob_size_ ||
+        blob_size_ - slot.offset <
+            uint64_t{slot.key_size} + uint64_t{slot.value_size}) {
+      throw std::runtime_error("MappedHashTable::find: corrupt slot");
+    }
+    const char* entry = blob_ + slot.offset;
+    if (bytes.empty() || std::memcmp(entry, bytes.data(), bytes.size()) == 0) {
+      return SnapshotCodec<V>::read(entry + slot.key_size, slot.value_size);
+    }
+  }
+  return std::nullopt;
+}
+
+#endif  // MAPPED_HASHTABLE_H_
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "FlatHashTable.h"
+#include "HashTable.h"
+#include "MappedHashTable.h"
+#include "gtest/gtest.h"
+
+static std::string snapshot_path(const std::string& name) {
+  return ::testing::TempDir() + "/" + name + ".snapshot";
+}
+
+using IntSnapshot = MappedHashTable<int, int>;
+using IntLongSnapshot = MappedHashTable<int, long>;
+using StringIntSnapshot = MappedHashTable<std::string, int>;
+
+// overwrites one byte of the file at offset
+static void corrupt(const std::string& path, long offset) {
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(offset);
+  char byte = static_cast<char>(file.get());
+  file.seekp(offset);
+  file.put(static_cast<char>(byte ^ 0xFF));
+}
+
+TEST(MappedHashTableTest, int_round_trip) {
+  HashTable<int, long> ht;
+  for (int i = 0; i < 10000; i++) {
+    ht.insert(i, static_cast<long>(i) * 3);
+  }
+  std::string path = snapshot_path("int_round_trip");
+  MappedHashTable<int, long>::save(ht, path);
+
+  auto mapped = MappedHashTable<int, long>::open(path);
+  ASSERT_EQ(mapped.size(), 10000);
+  ASSERT_FALSE(mapped.empty());
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_EQ(mapped.find(i), static_cast<long>(i) * 3);
+  }
+  ASSERT_FALSE(mapped.find(-1).has_value());
+  ASSERT_FALSE(mapped.contains(10000));
+  ASSERT_EQ(mapped.at(7), 21);
+  ASSERT_THROW(mapped.at(-7), std::out_of_range);
+  std::remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, string_round_trip) {
+  FlatHashTable<std::string, std::string> ht;
+  for (int i = 0; i < 1000; i++) {
+    ht.insert("key" + std::to_string(i), std::string(i % 50, 'v'));
+  }
+  ht.insert("", "empty key");
+  std::string path = snapshot_path("string_round_trip");
+  MappedHashTable<std::string, std::string>::save(ht, path);
+
+  auto mapped = MappedHashTable<std::string, std::string>::open(path);
+  ASSERT_EQ(mapped.size(), 1001);
+  for (int i = 0; i < 1000; i++) {
+    std::string key = "key" + std::to_string(i);
+    ASSERT_EQ(mapped.at(key), std::string(i % 50, 'v'));
+  }
+  ASSERT_EQ(mapped.at(""), "empty key");
+  // looked up by view, the result points into the mapping
+  std::string_view key = "key10";
+  ASSERT_EQ(mapped.find(key)->size(), 10);
+  ASSERT_FALSE(mapped.contains("key"));
+  std::remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, empty_table) {
+  HashTable<int, int> ht;
+  std::string path = snapshot_path("empty_table");
+  MappedHashTable<int, int>::save(ht, path);
+  auto mapped = MappedHashTable<int, int>::open(path);
+  ASSERT_TRUE(mapped.empty());
+  ASSERT_FALSE(mapped.contains(0));
+  std::remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, save_replaces_old_snapshot) {
+  HashTable<int, int> ht;
+  ht.insert(1, 1);
+  std::string path = snapshot_path("save_replaces_old_snapshot");
+  MappedHashTable<int, int>::save(ht, path);
+  auto old_mapping = MappedHashTable<int, int>::open(path);
+
+  ht.insert_or_assign(1, 2);
+  MappedHashTable<int, int>::save(ht, path);
+  auto new_mapping = MappedHashTable<int, int>::open(path);
+  ASSERT_EQ(old_mapping.at(1), 1);
+  ASSERT_EQ(new_mapping.at(1), 2);
+
+  // moving hands the mapping over
+  MappedHashTable<int, int> moved = std::move(new_mapping);
+  ASSERT_EQ(moved.at(1), 2);
+  ASSERT_TRUE(new_mapping.empty());
+  std::remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, rejects_bad_files) {
+  ASSERT_THROW(IntSnapshot::open(snapshot_path("missing")), std::system_error);
+
+  HashTable<int, int> ht;
+  for (int i = 0; i < 100; i++) {
+    ht.insert(i, i);
+  }
+  std::string path = snapshot_path("rejects_bad_files");
+  IntSnapshot::save(ht, path);
+  // written for other types
+  ASSERT_THROW(StringIntSnapshot::open(path), std::runtime_error);
+  ASSERT_THROW(IntLongSnapshot::open(path), std::runtime_error);
+
+  // a flipped byte in the blob is only caught by the checksum
+  std::ifstream size_probe(path, std::ios::binary | std::ios::ate);
+  long size = static_cast<long>(size_probe.tellg());
+  corrupt(path, size - 1);
+  ASSERT_THROW(IntSnapshot::open(path), std::runtime_error);
+  ASSERT_NO_THROW(IntSnapshot::open(path, false));
+
+  corrupt(path, 0);
+  ASSERT_THROW(IntSnapshot::open(path, false), std::runtime_error);
+
+  std::ofstream(path, std::ios::binary) << "short";
+  ASSERT_THROW(IntSnapshot::open(path), std::runtime_error);
+  std::remove(path.c_str());
+}
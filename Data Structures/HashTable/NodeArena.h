@@ -0,0 +1,201 @@
+#ifndef NODE_ARENA_H_
+#define NODE_ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * Node allocation policies for HashTable, picked through its NodeAlloc
+ * parameter. Both hand out raw storage for one Node at a time:
+ *
+ *   void* allocate();               storage for one Node
+ *   void deallocate(void* ptr);     gives one Node's storage back
+ *   void reserve(size_t count);     prepares for count more allocate() calls
+ *   void release();                 gives back every Node's storage at once
+ *
+ * FREES_IN_BULK tells the table that release() alone reclaims everything, so
+ * nodes that need no destructor do not have to be visited one by one.
+ */
+
+// allocates storage the way a plain new Node would, so extended alignments
+// are honoured and everything else goes through the replaceable operator new
+inline void* node_storage_new(std::size_t size, std::size_t align) {
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    return ::operator new(size, std::align_val_t(align));
+  }
+  return ::operator new(size);
+}
+
+inline void node_storage_delete(void* ptr, std::size_t align) {
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    ::operator delete(ptr, std::align_val_t(align));
+  } else {
+    ::operator delete(ptr);
+  }
+}
+
+/**
+ * Default policy: every node is its own heap allocation, exactly like new
+ * and delete. Stateless.
+ */
+template <typename Node>
+class NodeHeap {
+ public:
+  static constexpr bool FREES_IN_BULK = false;
+
+  void* allocate() { return node_storage_new(sizeof(Node), alignof(Node)); }
+
+  void deallocate(void* ptr) { node_storage_delete(ptr, alignof(Node)); }
+
+  void reserve(std::size_t) {}
+
+  void release() {}
+};
+
+/**
+ * Slab policy: nodes are carved out of large slabs with a bump pointer, so
+ * filling or copying a table costs a handful of allocations instead of one
+ * per node, and neighbouring inserts land next to each other in memory.
+ *
+ * Slabs start at FIRST_SLAB_NODES nodes and double up to MAX_SLAB_NODES,
+ * unless reserve() asks for a bigger one up front. Erased nodes go on a free
+ * list and are reused by the next allocate(). Memory only goes back to the
+ * system on release() or destruction, so a table that shrinks keeps its peak
+ * footprint until it is cleared.
+ *
+ * Each table owns its arena, so it is movable but not copyable.
+ */
+template <typename Node>
+class NodeArena {
+ public:
+  static constexpr bool FREES_IN_BULK = true;
+  static constexpr std::size_t FIRST_SLAB_NODES = 64;
+  static constexpr std::size_t MAX_SLAB_NODES = 1 << 16;
+
+  NodeArena() = default;
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  NodeArena(NodeArena&& other) noexcept { swap(other); }
+
+  NodeArena& operator=(NodeArena&& other) noexcept {
+    if (this != &other) {
+      release();
+      swap(other);
+    }
+    return *this;
+  }
+
+  ~NodeArena() { release(); }
+
+  void* allocate() {
+    if (free_ != nullptr) {
+      FreeNode* node = free_;
+      free_ = node->next;
+      --free_count_;
+      return node;
+    }
+    if (cursor_ == end_) {
+      add_slab(next_slab_nodes_);
+      if (next_slab_nodes_ < MAX_SLAB_NODES) {
+        next_slab_nodes_ *= 2;
+      }
+    }
+    void* node = cursor_;
+    cursor_ += BLOCK_SIZE;
+    return node;
+  }
+
+  void deallocate(void* ptr) {
+    free_ = ::new (ptr) FreeNode{free_};
+    ++free_count_;
+  }
+
+  /**
+   * Makes sure the next count allocate() calls need no new slab, allocating
+   * a single slab for all of them if the arena cannot already cover them
+   *
+   * ARGS:
+   * count: the number of nodes about to be allocated
+   */
+  void reserve(std::size_t count) {
+    std::size_t available =
+        free_count_ + static_cast<std::size_t>(end_ - cursor_) / BLOCK_SIZE;
+    if (available >= count) {
+      return;
+    }
+    // the rest of the current slab would be skipped by the new bump range,
+    // keep it on the free list instead
+    for (; cursor_ != end_; cursor_ += BLOCK_SIZE) {
+      deallocate(cursor_);
+    }
+    add_slab(count - free_count_);
+  }
+
+  /**
+   * Frees every slab. Every node handed out becomes invalid, so the caller
+   * must have destroyed any node that needs it first
+   */
+  void release() {
+    while (slabs_ != nullptr) {
+      Slab* next = slabs_->next;
+      node_storage_delete(slabs_, BLOCK_ALIGN);
+      slabs_ = next;
+    }
+    cursor_ = nullptr;
+    end_ = nullptr;
+    free_ = nullptr;
+    free_count_ = 0;
+    next_slab_nodes_ = FIRST_SLAB_NODES;
+  }
+
+ private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  // slabs are chained through a header in front of their first node
+  struct Slab {
+    Slab* next;
+  };
+
+  static constexpr std::size_t round_up(std::size_t size, std::size_t align) {
+    return (size + align - 1) / align * align;
+  }
+
+  static constexpr std::size_t BLOCK_ALIGN =
+      alignof(Node) > alignof(FreeNode) ? alignof(Node) : alignof(FreeNode);
+  static constexpr std::size_t BLOCK_SIZE = round_up(
+      sizeof(Node) > sizeof(FreeNode) ? sizeof(Node) : sizeof(FreeNode),
+      BLOCK_ALIGN);
+  static constexpr std::size_t HEADER_SIZE = round_up(sizeof(Slab),
+                                                      BLOCK_ALIGN);
+
+  void add_slab(std::size_t nodes) {
+    void* memory = node_storage_new(HEADER_SIZE + nodes * BLOCK_SIZE,
+                                    BLOCK_ALIGN);
+    slabs_ = ::new (memory) Slab{slabs_};
+    cursor_ = static_cast<char*>(memory) + HEADER_SIZE;
+    end_ = cursor_ + nodes * BLOCK_SIZE;
+  }
+
+  void swap(NodeArena& other) noexcept {
+    std::swap(slabs_, other.slabs_);
+    std::swap(cursor_, other.cursor_);
+    std::swap(end_, other.end_);
+    std::swap(free_, other.free_);
+    std::swap(free_count_, other.free_count_);
+    std::swap(next_slab_nodes_, other.next_slab_nodes_);
+  }
+
+  Slab* slabs_ = nullptr;
+  char* cursor_ = nullptr;  // next never used node in the newest slab
+  char* end_ = nullptr;
+  FreeNode* free_ = nullptr;
+  std::size_t free_count_ = 0;
+  std::size_t next_slab_nodes_ = FIRST_SLAB_NODES;
+};
+
+#endif  // NODE_ARENA_H_
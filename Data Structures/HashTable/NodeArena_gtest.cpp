@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "NodeArena.h"
+#include "gtest/gtest.h"
+
+struct ArenaNode {
+  long value;
+  ArenaNode* next;
+};
+
+struct alignas(64) AlignedArenaNode {
+  int value;
+};
+
+TEST(NodeArenaTest, distinct_blocks) {
+  NodeArena<ArenaNode> arena;
+  std::set<void*> blocks;
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(blocks.insert(arena.allocate()).second);
+  }
+}
+
+TEST(NodeArenaTest, reuses_freed_block) {
+  NodeArena<ArenaNode> arena;
+  void* first = arena.allocate();
+  arena.allocate();
+  arena.deallocate(first);
+  ASSERT_EQ(arena.allocate(), first);
+}
+
+TEST(NodeArenaTest, respects_alignment) {
+  NodeArena<AlignedArenaNode> arena;
+  for (int i = 0; i < 200; i++) {
+    void* block = arena.allocate();
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % 64, 0u);
+  }
+}
+
+TEST(NodeArenaTest, reserve_takes_one_slab) {
+  NodeArena<ArenaNode> arena;
+  arena.allocate();
+  const size_t count = 10 * NodeArena<ArenaNode>::MAX_SLAB_NODES;
+  arena.reserve(count);
+  // the rest of the first slab is used up before the reserved one
+  for (size_t i = 1; i < NodeArena<ArenaNode>::FIRST_SLAB_NODES; i++) {
+    arena.allocate();
+  }
+  char* prev = static_cast<char*>(arena.allocate());
+  for (size_t i = NodeArena<ArenaNode>::FIRST_SLAB_NODES; i < count; i++) {
+    char* block = static_cast<char*>(arena.allocate());
+    ASSERT_EQ(block - prev, static_cast<long>(sizeof(ArenaNode)));
+    prev = block;
+  }
+}
+
+TEST(NodeArenaTest, release_and_move) {
+  NodeArena<ArenaNode> arena;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 100; i++) {
+    blocks.push_back(arena.allocate());
+  }
+  NodeArena<ArenaNode> other = std::move(arena);
+  other.deallocate(blocks[0]);
+  ASSERT_EQ(other.allocate(), blocks[0]);
+  other.release();
+  // both arenas are usable afterwards
+  ASSERT_NE(other.allocate(), nullptr);
+  ASSERT_NE(arena.allocate(), nullptr);
+}
@@ -0,0 +1,726 @@
+#ifndef ROBINHOODTABLE_H_
+#define ROBINHOODTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "SlotArray.h"
+#include "XXHash.h"
+
+// Default maximum load factor, Robin Hood probing keeps both hit and miss
+// lookups short well past what plain linear probing tolerates
+inline constexpr double ROBIN_HOOD_MAX_LOAD_FACTOR = 0.9;
+
+/**
+ * Robin Hood open addressing hash table that can stand in for HashTable
+ * wherever code sticks to insert, insert_or_assign, try_emplace, emplace,
+ * erase, at, operator[], find, contains, clear, reserve and the iterators.
+ * Heterogeneous lookup, incremental rehashing and stats() exist only on
+ * HashTable.
+ *
+ * Every slot records how far its entry sits from its home slot. Inserting
+ * walks forward from the home slot, and whenever the entry being placed is
+ * further from home than the resident it takes the slot and the resident
+ * moves on instead ("take from the rich"). The result is that along any run
+ * distances never drop by more than one from slot to slot, so a lookup for a
+ * key at distance d can stop as soon as it meets a slot whose distance is
+ * below d: had the key been there it would have displaced that entry. Misses
+ * end after a handful of slots even at high load, where a chained table has
+ * to walk the whole chain.
+ *
+ * Deletion shifts the rest of the run back by one slot (decrementing each
+ * distance) until it hits an empty slot or an entry already at home, so no
+ * tombstones are ever left behind.
+ *
+ * The distances are the metadata bytes of a SlotArray, the storage
+ * FlatHashTable uses too.
+ *
+ * Hash and KeyEqual work as in HashTable. The home slot is the low bits of
+ * the hash, so Hash must spread its entropy into them; the default XXHash
+ * does, a plain std::hash, which is the identity for integers, does not.
+ *
+ * Inserting or erasing may move other entries, which invalidates pointers
+ * returned by find() and all iterators.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class RobinHoodTable {
+ private:
+  struct Entry;
+
+  // a slot's metadata byte is 0 when it is empty, otherwise 1 + the distance
+  // of its entry from its home slot
+  static constexpr uint8_t EMPTY = 0;
+
+  using Slots = SlotArray<Entry, EMPTY>;
+
+ public:
+  using key_type = K;
+  using value_type = V;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using iterator = typename Slots::iterator;
+  using const_iterator = typename Slots::const_iterator;
+
+  // -- CONSTRUCTOR AND DESTRUCTOR --//
+
+  /**
+   * Constructs an empty RobinHoodTable
+   */
+  RobinHoodTable() : RobinHoodTable(MIN_CAPACITY) {}
+
+  /**
+   * Constructs an empty RobinHoodTable with room for capacity slots
+   *
+   * ARGS:
+   * capacity: number of slots, rounded up to a power of two
+   * max_load_factor: fraction of slots that may be full before the table
+   *                  doubles
+   * hash: hashes keys, its low bits pick the home slot
+   * equal: compares keys
+   *
+   * THROWS:
+   * std::invalid_argument if max_load_factor is not in (0, 1)
+   */
+  explicit RobinHoodTable(size_type capacity,
+                          double max_load_factor = ROBIN_HOOD_MAX_LOAD_FACTOR,
+                          const Hash& hash = Hash(),
+                          const KeyEqual& equal = KeyEqual());
+
+  /**
+   * Copy constructor that constructs this table with another table
+   *
+   * ARGS:
+   * other: the table that will be copied
+   */
+  RobinHoodTable(const RobinHoodTable& other);
+
+  /**
+   * Move Constructor that takes over the other table's slots, other is left
+   * empty without any slots until its next insert
+   *
+   * ARGS:
+   * other: the table that will be stolen from
+   */
+  RobinHoodTable(RobinHoodTable&& other) noexcept;
+
+  /**
+   * Destroys this table
+   */
+  ~RobinHoodTable() = default;
+
+  /**
+   * Copy assignment operator
+   *
+   * ARGS:
+   * other: the table that will be copied
+   */
+  RobinHoodTable& operator=(const RobinHoodTable& other);
+
+  /**
+   * Move assignment operator, other is left empty
+   *
+   * ARGS:
+   * other: the table that will be stolen from
+   */
+  RobinHoodTable& operator=(RobinHoodTable&& other) noexcept;
+
+  // -- CAPACITY -- //
+
+  /**
+   * RETURNS:
+   * true if the table contains no elements, else false
+   */
+  bool empty() const { return num_elements_ == 0; }
+
+  /**
+   * RETURNS:
+   * the number of key-value pairs in the table
+   */
+  size_type size() const { return num_elements_; }
+
+  // -- MODIFIERS -- //
+
+  /**
+   * Removes every element. The slots stay allocated, so refilling the table
+   * to the same size does not resize again
+   */
+  void clear() {
+    slots_.clear();
+    num_elements_ = 0;
+  }
+
+  /**
+   * Adds the key-value pair into the table, if the key already exists then
+   * nothing happens
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   */
+  void insert(const key_type& key, const value_type& value);
+  void insert(key_type&& key, value_type&& value);
+
+  /**
+   * Adds the key-value pair into the table, if the key already exists then
+   * it will replace the value of the existing key
+   *
+   * ARGS:
+   * key: the unique identifier of the value
+   * value: the value of the key
+   */
+  void insert_or_assign(const key_type& key, const value_type& value);
+  void insert_or_assign(key_type&& key, value_type&& value);
+
+  /**
+   * Constructs the value in place from args if the key is not in the table
+   * yet, otherwise nothing happens and args are left untouched
+   *
+   * ARGS:
+   * key: the unique identifier of the value, moved from only on insertion
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the entry holding key, and true if it was just inserted
+   */
+  template <typename... Args>
+  std::pair<Entry*, bool> try_emplace(const key_type& key, Args&&... args) {
+    return emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  std::pair<Entry*, bool> try_emplace(key_type&& key, Args&&... args) {
+    return emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Constructs the key from key_arg, then behaves as try_emplace, so the
+   * value is only built when the key turns out to be new
+   *
+   * ARGS:
+   * key_arg: forwarded to the key's constructor
+   * args: forwarded to the value's constructor
+   *
+   * RETURNS:
+   * the entry holding the key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Entry*, bool> emplace(KeyArg&& key_arg, Args&&... args) {
+    return emplace_key(key_type(std::forward<KeyArg>(key_arg)),
+                       std::forward<Args>(args)...);
+  }
+
+  /**
+   * Removes the element with the specified key from the table, the rest of
+   * its run shifts back by one slot
+   *
+   * ARGS:
+   * key: the key of the element to remove
+   */
+  void erase(const key_type& key);
+
+  // -- LOOKUP -- //
+
+  /**
+   * Accesses the value associated with the key.
+   *
+   * ARGS:
+   * key: the key to look up
+   *
+   * RETURNS:
+   * reference to the value associated with the key
+   *
+   * THROWS:
+   * std::out_of_range if key is not found
+   */
+  value_type& at(const key_type& key);
+  const value_type& at(const key_type& key) const;
+
+  /**
+   * Accesses or inserts element with the given key.
+   * If key doesn't exist, creates it with default value.
+   *
+   * ARGS:
+   * key: the key to look up or insert
+   *
+   * RETURNS:
+   * reference to the value associated with the key
+   */
+  value_type& operator[](const key_type& key);
+  const value_type& operator[](const key_type& key) const;
+
+  /**
+   * Finds the entry containing the specified key.
+   *
+   * ARGS:
+   * key: the key to search for
+   *
+   * RETURNS:
+   * pointer to the entry (with key and value members) if found, nullptr
+   * otherwise
+   */
+  Entry* find(const key_type& key);
+  const Entry* find(const key_type& key) const;
+
+  /**
+   * RETURNS:
+   * true if key is within the table, else false
+   */
+  bool contains(const key_type& key) const {
+    return find_index(key) != NOT_FOUND;
+  }
+
+  // -- HASH POLICY -- //
+
+  /**
+   * RETURNS:
+   * the load factor (elements / slots)
+   */
+  double load_factor() const {
+    return capacity() == 0 ? 0.0
+                           : static_cast<double>(num_elements_) /
+                                 static_cast<double>(capacity());
+  }
+
+  /**
+   * RETURNS:
+   * the max load factor this table was built with
+   */
+  double max_load_factor() const { return max_load_factor_; }
+
+  /**
+   * Number of slots, always a power of two (or 0 once moved from)
+   */
+  size_type capacity() const { return slots_.capacity(); }
+
+  /**
+   * Doubles the number of slots and reinserts every entry
+   */
+  void rehash() { resize(capacity() == 0 ? MIN_CAPACITY : capacity() * 2); }
+
+  /**
+   * Grows the table so that count elements stay under the max load factor
+   * it was built with. Inserting up to count elements afterwards never
+   * resizes. Never shrinks the table.
+   *
+   * ARGS:
+   * count: the number of elements the table should hold without growing
+   */
+  void reserve(size_type count);
+
+  /**
+   * How many slots past its home slot key sits, 0 when it is at home
+   *
+   * THROWS:
+   * std::out_of_range if key is not found
+   */
+  size_type probe_distance(const key_type& key) const {
+    size_type index = find_index(key);
+    if (index == NOT_FOUND) {
+      throw std::out_of_range("RobinHoodTable::probe_distance: key not found");
+    }
+    return slots_.meta()[index] - 1;
+  }
+
+  /**
+   * RETURNS:
+   * the hash function
+   */
+  hasher hash_function() const { return hasher_; }
+
+  /**
+   * RETURNS:
+   * the key equality function
+   */
+  key_equal key_eq() const { return key_equal_; }
+
+  // -- ITERATORS -- //
+  // forward iterators over the full slots
+  iterator begin() { return slots_.begin(); }
+  const_iterator begin() const { return slots_.begin(); }
+  const_iterator cbegin() const { return begin(); }
+
+  iterator end() { return slots_.end(); }
+  const_iterator end() const { return slots_.end(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  struct Entry {
+    key_type key;
+    value_type value;
+
+    // the tag keeps this from standing in for the copy and move
+    // constructors
+    template <typename KeyArg, typename... Args>
+    Entry(std::in_place_t, KeyArg&& key, Args&&... args)
+        : key(std::forward<KeyArg>(key)), value(std::forward<Args>(args)...) {}
+  };
+
+  static constexpr uint8_t MAX_DIST = 255;
+  static constexpr size_type MIN_CAPACITY = 16;
+  static constexpr size_type NOT_FOUND = static_cast<size_type>(-1);
+
+  size_type home(const key_type& key) const {
+    return static_cast<size_type>(hasher_(key)) & (capacity() - 1);
+  }
+
+  /**
+   * RETURNS:
+   * slot index of key, NOT_FOUND if it is not in the table
+   */
+  size_type find_index(const key_type& key) const;
+
+  /**
+   * Helper function that Robin Hood inserts a new entry, first doubling the
+   * table for as long as the insertion would push some entry MAX_DIST slots
+   * from home. IMPORTANT: the key must not be in the table
+   *
+   * RETURNS:
+   * the slot the new entry ended up in
+   */
+  size_type place(Entry&& entry);
+
+  /**
+   * Helper function that replays an insertion from slot index on the
+   * distances alone, without moving any entry
+   *
+   * RETURNS:
+   * true if an entry carried along the run would reach MAX_DIST
+   */
+  bool run_too_long(size_type index) const;
+
+  /**
+   * Helper function that grows the table first if one more entry would push
+   * it past the max load factor
+   */
+  void reserve_one() {
+    if (static_cast<double>(num_elements_ + 1) >
+        static_cast<double>(capacity()) * max_load_factor_) {
+      rehash();
+    }
+  }
+
+  /**
+   * Helper function behind every insertion, the entry is only built, from
+   * key and args, if key is new
+   *
+   * RETURNS:
+   * the entry holding key, and true if it was just inserted
+   */
+  template <typename KeyArg, typename... Args>
+  std::pair<Entry*, bool> emplace_key(KeyArg&& key, Args&&... args);
+
+  void erase_at(size_type index);
+
+  void resize(size_type new_capacity);
+
+  // the probe distances are the slots' metadata, a moved from table has no
+  // slots at all
+  Slots slots_;
+  size_type num_elements_ = 0;
+  double max_load_factor_;
+  Hash hasher_;
+  KeyEqual key_equal_;
+};
+
+// ----------------------------------------------------------------------------
+// --- MEMBER FUNCTION DEFINITIONS
+// ----------------------------------------------------------------------------
+
+// -- CONSTRUCTOR AND DESTRUCTOR --//
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+RobinHoodTable<K, V, Hash, KeyEqual>::RobinHoodTable(size_type capacity,
+                                                     double max_load_factor,
+                                                     const Hash& hash,
+                                                     const KeyEqual& equal)
+    : max_load_factor_(max_load_factor), hasher_(hash), key_equal_(equal) {
+  if (!(max_load_factor > 0.0 && max_load_factor < 1.0)) {
+    throw std::invalid_argument(
+        "RobinHoodTable: max_load_factor must be in (0, 1)");
+  }
+  size_type rounded = MIN_CAPACITY;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  slots_ = Slots(rounded);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+RobinHoodTable<K, V, Hash, KeyEqual>::RobinHoodTable(
+    const RobinHoodTable& other)
+    : slots_(other.slots_),
+      num_elements_(other.num_elements_),
+      max_load_factor_(other.max_load_factor_),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+RobinHoodTable<K, V, Hash, KeyEqual>::RobinHoodTable(
+    RobinHoodTable&& other) noexcept
+    : slots_(std::move(other.slots_)),
+      num_elements_(std::exchange(other.num_elements_, 0)),
+      max_load_factor_(other.max_load_factor_),
+      hasher_(other.hasher_),
+      key_equal_(other.key_equal_) {}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+RobinHoodTable<K, V, Hash, KeyEqual>&
+RobinHoodTable<K, V, Hash, KeyEqual>::operator=(const RobinHoodTable& other) {
+  if (this == &other) {
+    return *this;
+  }
+  slots_ = other.slots_;
+  num_elements_ = other.num_elements_;
+  max_load_factor_ = other.max_load_factor_;
+  hasher_ = other.hasher_;
+  key_equal_ = other.key_equal_;
+  return *this;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+RobinHoodTable<K, V, Hash, KeyEqual>&
+RobinHoodTable<K, V, Hash, KeyEqual>::operator=(
+    RobinHoodTable&& other) noexcept {
+  if (this != &other) {
+    slots_ = std::move(other.slots_);
+    num_elements_ = std::exchange(other.num_elements_, 0);
+    max_load_factor_ = other.max_load_factor_;
+    hasher_ = other.hasher_;
+    key_equal_ = other.key_equal_;
+  }
+  return *this;
+}
+
+// -- MODIFIERS -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::insert(const key_type& key,
+                                                  const value_type& value) {
+  emplace_key(key, value);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::insert(key_type&& key,
+                                                  value_type&& value) {
+  emplace_key(std::move(key), std::move(value));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::insert_or_assign(
+    const key_type& key, const value_type& value) {
+  auto [entry, inserted] = emplace_key(key, value);
+  if (!inserted) {
+    entry->value = value;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::insert_or_assign(
+    key_type&& key, value_type&& value) {
+  // a key that is already there leaves value untouched, so it can still be
+  // moved from
+  auto [entry, inserted] = emplace_key(std::move(key), std::move(value));
+  if (!inserted) {
+    entry->value = std::move(value);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::erase(const key_type& key) {
+  size_type index = find_index(key);
+  if (index != NOT_FOUND) {
+    erase_at(index);
+  }
+}
+
+// -- LOOKUP -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename RobinHoodTable<K, V, Hash, KeyEqual>::value_type&
+RobinHoodTable<K, V, Hash, KeyEqual>::at(const key_type& key) {
+  size_type index = find_index(key);
+  if (index == NOT_FOUND) {
+    throw std::out_of_range("RobinHoodTable::at: key not found");
+  }
+  return slots_[index].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename RobinHoodTable<K, V, Hash, KeyEqual>::value_type&
+RobinHoodTable<K, V, Hash, KeyEqual>::at(const key_type& key) const {
+  size_type index = find_index(key);
+  if (index == NOT_FOUND) {
+    throw std::out_of_range("RobinHoodTable::at: key not found");
+  }
+  return slots_[index].value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename RobinHoodTable<K, V, Hash, KeyEqual>::value_type&
+RobinHoodTable<K, V, Hash, KeyEqual>::operator[](const key_type& key) {
+  return emplace_key(key).first->value;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename RobinHoodTable<K, V, Hash, KeyEqual>::value_type&
+RobinHoodTable<K, V, Hash, KeyEqual>::operator[](const key_type& key) const {
+  return at(key);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename RobinHoodTable<K, V, Hash, KeyEqual>::Entry*
+RobinHoodTable<K, V, Hash, KeyEqual>::find(const key_type& key) {
+  size_type index = find_index(key);
+  return index == NOT_FOUND ? nullptr : &slots_[index];
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+const typename RobinHoodTable<K, V, Hash, KeyEqual>::Entry*
+RobinHoodTable<K, V, Hash, KeyEqual>::find(const key_type& key) const {
+  size_type index = find_index(key);
+  return index == NOT_FOUND ? nullptr : &slots_[index];
+}
+
+// -- HASH POLICY -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::reserve(size_type count) {
+  size_type new_capacity = capacity() == 0 ? MIN_CAPACITY : capacity();
+  while (static_cast<double>(count) >
+         static_cast<double>(new_capacity) * max_load_factor_) {
+    new_capacity *= 2;
+  }
+  if (new_capacity != capacity()) {
+    resize(new_capacity);
+  }
+}
+
+// -- Private Helpers -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename KeyArg, typename... Args>
+std::pair<typename RobinHoodTable<K, V, Hash, KeyEqual>::Entry*, bool>
+RobinHoodTable<K, V, Hash, KeyEqual>::emplace_key(KeyArg&& key,
+                                                  Args&&... args) {
+  size_type index = find_index(key);
+  if (index != NOT_FOUND) {
+    return {&slots_[index], false};
+  }
+  reserve_one();
+  index = place(Entry(std::in_place, std::forward<KeyArg>(key),
+                      std::forward<Args>(args)...));
+  return {&slots_[index], true};
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename RobinHoodTable<K, V, Hash, KeyEqual>::size_type
+RobinHoodTable<K, V, Hash, KeyEqual>::find_index(const key_type& key) const {
+  if (capacity() == 0) {
+    // moved from, there are no slots to probe
+    return NOT_FOUND;
+  }
+  const uint8_t* dists = slots_.meta();
+  const size_type mask = capacity() - 1;
+  size_type index = home(key);
+  // a resident closer to home than we have come means the key would have
+  // displaced it, so it is not in the table
+  for (uint8_t dist = 1; dists[index] >= dist; ++dist) {
+    if (dists[index] == dist && key_equal_(slots_[index].key, key)) {
+      return index;
+    }
+    index = (index + 1) & mask;
+  }
+  return NOT_FOUND;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+typename RobinHoodTable<K, V, Hash, KeyEqual>::size_type
+RobinHoodTable<K, V, Hash, KeyEqual>::place(Entry&& entry) {
+  size_type index = home(entry.key);
+  // a pathological run, spread the table out before touching it, so the
+  // new entry stays where this insertion puts it
+  while (run_too_long(index)) {
+    resize(capacity() * 2);
+    index = home(entry.key);
+  }
+  uint8_t* dists = slots_.meta();
+  const size_type mask = capacity() - 1;
+  size_type placed = NOT_FOUND;
+  uint8_t dist = 1;
+  Entry carry(std::move(entry));
+  while (true) {
+    if (dists[index] == EMPTY) {
+      slots_.construct(index, std::move(carry));
+      dists[index] = dist;
+      ++num_elements_;
+      return placed == NOT_FOUND ? index : placed;
+    }
+    if (dists[index] < dist) {
+      // the resident is richer, it moves on and we take its slot
+      std::swap(carry, slots_[index]);
+      std::swap(dist, dists[index]);
+      if (placed == NOT_FOUND) {
+        placed = index;
+      }
+    }
+    index = (index + 1) & mask;
+    ++dist;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+bool RobinHoodTable<K, V, Hash, KeyEqual>::run_too_long(
+    size_type index) const {
+  const uint8_t* dists = slots_.meta();
+  const size_type mask = capacity() - 1;
+  // the same walk as place(): whenever a resident is richer it becomes the
+  // entry carried on
+  for (uint8_t dist = 1; dists[index] != EMPTY;) {
+    if (dists[index] < dist) {
+      dist = dists[index];
+    }
+    index = (index + 1) & mask;
+    if (++dist == MAX_DIST) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::erase_at(size_type index) {
+  uint8_t* dists = slots_.meta();
+  const size_type mask = capacity() - 1;
+  slots_.destroy(index);
+  dists[index] = EMPTY;
+  --num_elements_;
+
+  // pull the rest of the run back one slot until an empty slot or an entry
+  // that is already at home
+  size_type next = (index + 1) & mask;
+  while (dists[next] > 1) {
+    slots_.construct(index, std::move(slots_[next]));
+    dists[index] = dists[next] - 1;
+    slots_.destroy(next);
+    dists[next] = EMPTY;
+    index = next;
+    next = (next + 1) & mask;
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual>
+void RobinHoodTable<K, V, Hash, KeyEqual>::resize(size_type new_capacity) {
+  // the old array destroys the moved from entries when it goes away
+  Slots old_slots(std::move(slots_));
+  slots_ = Slots(new_capacity);
+  num_elements_ = 0;
+  for (Entry& entry : old_slots) {
+    place(std::move(entry));
+  }
+}
+
+#endif  // ROBINHOODTABLE_H_
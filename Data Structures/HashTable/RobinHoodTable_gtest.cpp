@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "RobinHoodTable.h"
+#include "gtest/gtest.h"
+
+// Keys are their own hash, so a test decides where every key's home slot is
+struct IdentityHash {
+  size_t operator()(int key) const { return static_cast<size_t>(key); }
+};
+
+// Counts every key comparison a lookup makes
+struct CountingEqual {
+  static inline int calls = 0;
+
+  bool operator()(int a, int b) const {
+    calls++;
+    return a == b;
+  }
+};
+
+// Homes every key in slot 0 of a table of up to 1024 slots, and spreads
+// them over 2 runs once it doubles
+struct ShiftHash {
+  size_t operator()(int key) const { return static_cast<size_t>(key) << 10; }
+};
+
+using IdentityTable = RobinHoodTable<int, int, IdentityHash>;
+using CountingTable = RobinHoodTable<int, int, IdentityHash, CountingEqual>;
+
+// Erasing pulls the rest of the run back, so every later entry ends up one
+// slot closer to home
+TEST(RobinHoodTableTest, erase_shifts_run_back) {
+  IdentityTable ht;
+  // 0, 16 and 32 share home 0 and sit at distances 0, 1 and 2; 1 is pushed
+  // out of its home by them
+  for (int key : {0, 16, 32, 1}) {
+    ht.insert(key, key);
+  }
+  ASSERT_EQ(ht.probe_distance(0), 0u);
+  ASSERT_EQ(ht.probe_distance(16), 1u);
+  ASSERT_EQ(ht.probe_distance(32), 2u);
+  ASSERT_EQ(ht.probe_distance(1), 2u);
+
+  ht.erase(0);
+  ASSERT_EQ(ht.probe_distance(16), 0u);
+  ASSERT_EQ(ht.probe_distance(32), 1u);
+  ASSERT_EQ(ht.probe_distance(1), 1u);
+
+  // the shift stops at 3, which already sits in its home slot
+  ht.insert(3, 3);
+  ht.erase(16);
+  ASSERT_EQ(ht.probe_distance(32), 0u);
+  ASSERT_EQ(ht.probe_distance(1), 0u);
+  ASSERT_EQ(ht.probe_distance(3), 0u);
+  ASSERT_THROW(ht.probe_distance(16), std::out_of_range);
+}
+
+// A miss stops at the first slot whose entry is closer to home than the
+// lookup has come, and only compares keys at its own distance
+TEST(RobinHoodTableTest, miss_exits_early) {
+  CountingTable ht(64, 0.99);
+  // 0, 64 and 128 fill slots 0 to 2 from home 0, then keys 1 to 30 each sit
+  // two slots past their home, so the run is 33 slots long
+  for (int key : {0, 64, 128}) {
+    ht.insert(key, key);
+  }
+  for (int key = 1; key <= 30; key++) {
+    ht.insert(key, key);
+  }
+  ASSERT_EQ(ht.probe_distance(30), 2u);
+
+  // home 0: the three keys from home 0 are compared, then key 1 at distance
+  // 2 ends the search, plain linear probing would walk all 33 slots
+  CountingEqual::calls = 0;
+  ASSERT_FALSE(ht.contains(192));
+  ASSERT_EQ(CountingEqual::calls, 3);
+
+  // home 5: only key 5, at the miss's distance of 2, is compared
+  CountingEqual::calls = 0;
+  ASSERT_FALSE(ht.contains(69));
+  ASSERT_EQ(CountingEqual::calls, 1);
+
+  // past the end of the run the miss stops at once
+  CountingEqual::calls = 0;
+  ASSERT_FALSE(ht.contains(40));
+  ASSERT_EQ(CountingEqual::calls, 0);
+}
+
+// Along a run a distance never drops by more than one from one slot to the
+// next, through any mix of inserts and backward-shift erases
+TEST(RobinHoodTableTest, distance_invariant) {
+  RobinHoodTable<int, int> ht(1 << 10, 0.95);
+  XXHash<int> hash;
+  std::mt19937 rng(99);
+  std::uniform_int_distribution<int> key_dist(0, 1 << 20);
+  std::vector<int> keys;
+  for (int round = 0; round < 20; round++) {
+    while (ht.size() < 900) {
+      int key = key_dist(rng);
+      if (!ht.contains(key)) {
+        ht.insert(key, key);
+        keys.push_back(key);
+      }
+    }
+    ASSERT_EQ(ht.capacity(), 1u << 10);
+    const size_t mask = ht.capacity() - 1;
+    std::vector<int> dist(ht.capacity(), -1);
+    for (int key : keys) {
+      size_t home = hash(key) & mask;
+      size_t d = ht.probe_distance(key);
+      size_t slot = (home + d) & mask;
+      ASSERT_EQ(dist[slot], -1);
+      dist[slot] = static_cast<int>(d);
+    }
+    for (size_t slot = 0; slot <= mask; slot++) {
+      if (dist[slot] > 0) {
+        ASSERT_GE(dist[(slot - 1) & mask], dist[slot] - 1);
+      }
+    }
+    // erase half the keys so the next round runs over shifted runs
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = keys.size() / 2; i < keys.size(); i++) {
+      ht.erase(keys[i]);
+    }
+    keys.resize(keys.size() / 2);
+  }
+}
+
+// A run that reaches MAX_DIST doubles the table from inside place(), and the
+// key being inserted has to be in the right place afterwards
+TEST(RobinHoodTableTest, long_run_resizes) {
+  RobinHoodTable<int, int, ShiftHash> ht(1024, 0.99);
+  for (int i = 0; i < 254; i++) {
+    ht[i] = i;
+  }
+  ASSERT_EQ(ht.capacity(), 1024u);
+  // the 255th key would sit 255 slots from home
+  ht[254] = 254;
+  ASSERT_EQ(ht.capacity(), 2048u);
+  ASSERT_EQ(ht.at(254), 254);
+  for (int i = 255; i < 300; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.size(), 300u);
+  for (int i = 0; i < 300; i++) {
+    ASSERT_EQ(ht.at(i), i);
+    ASSERT_LT(ht.probe_distance(i), 255u);
+  }
+}
+
+// Inserting a moved key into a run that is too long resizes first, the
+// returned entry is still the new one
+TEST(RobinHoodTableTest, try_emplace_through_resize) {
+  RobinHoodTable<int, std::unique_ptr<int>, ShiftHash> ht(1024, 0.99);
+  for (int i = 0; i < 254; i++) {
+    ht.try_emplace(i, std::make_unique<int>(i));
+  }
+  auto [entry, inserted] = ht.try_emplace(254, std::make_unique<int>(254));
+  ASSERT_TRUE(inserted);
+  ASSERT_EQ(ht.capacity(), 2048u);
+  ASSERT_EQ(entry->key, 254);
+  ASSERT_EQ(*entry->value, 254);
+
+  ASSERT_FALSE(ht.try_emplace(254).second);
+  ht.insert_or_assign(254, std::make_unique<int>(-1));
+  ASSERT_EQ(*ht.at(254), -1);
+  ht.insert(255, std::make_unique<int>(255));
+  ASSERT_EQ(*ht[255], 255);
+  ASSERT_EQ(ht[256], nullptr);
+  ASSERT_EQ(ht.size(), 257u);
+}
+
+TEST(RobinHoodTableTest, reserve_and_clear) {
+  RobinHoodTable<int, std::string> ht;
+  ht.reserve(1000);
+  size_t capacity = ht.capacity();
+  ASSERT_GE(capacity * ht.max_load_factor(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    ht.emplace(i, 1, 'x');
+  }
+  ASSERT_EQ(ht.capacity(), capacity);
+  ht.reserve(10);
+  ASSERT_EQ(ht.capacity(), capacity);
+
+  ht.clear();
+  ASSERT_TRUE(ht.empty());
+  ASSERT_EQ(ht.capacity(), capacity);
+  ASSERT_EQ(ht.begin(), ht.end());
+  ASSERT_FALSE(ht.contains(1));
+  ht.insert(1, "1");
+  ASSERT_EQ(ht.at(1), "1");
+  ASSERT_EQ(ht.probe_distance(1), 0u);
+}
+
+TEST(RobinHoodTableTest, capacity_constructor) {
+  RobinHoodTable<int, int> ht(1000, 0.5);
+  ASSERT_EQ(ht.capacity(), 1024u);
+  ASSERT_EQ(ht.max_load_factor(), 0.5);
+  for (int i = 0; i < 512; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.capacity(), 1024u);
+  ht.insert(512, 512);
+  ASSERT_EQ(ht.capacity(), 2048u);
+
+  ASSERT_THROW((RobinHoodTable<int, int>(16, 0.0)), std::invalid_argument);
+  ASSERT_THROW((RobinHoodTable<int, int>(16, 1.0)), std::invalid_argument);
+}
+
+// At a very high load every key must still be found and misses must still
+// terminate
+TEST(RobinHoodTableTest, high_load_factor) {
+  RobinHoodTable<int, int> ht(1 << 12, 0.99);
+  const int n = static_cast<int>(ht.capacity() * 0.99) - 1;
+  for (int i = 0; i < n; i++) {
+    ht.insert(i, i);
+  }
+  ASSERT_EQ(ht.capacity(), 1u << 12);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(ht.at(i), i);
+  }
+  for (int i = n; i < 2 * n; i++) {
+    ASSERT_FALSE(ht.contains(i));
+  }
+}
+
+TEST(RobinHoodTableTest, matches_unordered_map) {
+  RobinHoodTable<int, int> ht;
+  std::unordered_map<int, int> reference;
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> key_dist(0, 2000);
+  for (int i = 0; i < 50000; i++) {
+    int key = key_dist(rng);
+    switch (rng() % 3) {
+      case 0:
+        ht.insert_or_assign(key, i);
+        reference[key] = i;
+        break;
+      case 1:
+        ht.erase(key);
+        reference.erase(key);
+        break;
+      default:
+        auto found = reference.find(key);
+        if (found == reference.end()) {
+          ASSERT_FALSE(ht.contains(key));
+        } else {
+          ASSERT_EQ(ht.at(key), found->second);
+        }
+    }
+    ASSERT_EQ(ht.size(), reference.size());
+  }
+}
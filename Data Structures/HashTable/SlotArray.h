@@ -0,0 +1,281 @@
+#ifndef SLOT_ARRAY_H_
+#define SLOT_ARRAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/**
+ * Slot storage shared by the open addressing tables (FlatHashTable,
+ * RobinHoodTable): a raw array of entries next to one metadata byte per
+ * slot. A slot holds a live entry exactly when its byte is not EMPTY, what
+ * the other byte values mean is up to the table.
+ *
+ * PADDING extra metadata bytes follow the last slot, for tables that read
+ * past the end (FlatHashTable mirrors its first group there). They start
+ * out EMPTY and are copied along with the rest, but never mark a live slot.
+ *
+ * The array owns the entries: copying copies every live entry into the same
+ * slot, and destruction destroys them. A default constructed or moved from
+ * array has no slots at all and allocates nothing.
+ *
+ * Tables construct entries with construct() and then set the slot's byte,
+ * and clear the byte when they destroy() one, the array never touches the
+ * metadata itself.
+ */
+template <typename Entry, uint8_t EMPTY, std::size_t PADDING = 0>
+class SlotArray {
+ public:
+  using size_type = std::size_t;
+
+  SlotArray() = default;
+
+  /**
+   * Allocates capacity slots, all EMPTY
+   */
+  explicit SlotArray(size_type capacity);
+
+  SlotArray(const SlotArray& other);
+
+  SlotArray(SlotArray&& other) noexcept
+      : meta_(std::exchange(other.meta_, nullptr)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)) {}
+
+  ~SlotArray();
+
+  SlotArray& operator=(const SlotArray& other) {
+    SlotArray copy(other);
+    swap(copy);
+    return *this;
+  }
+
+  SlotArray& operator=(SlotArray&& other) noexcept {
+    SlotArray taken(std::move(other));
+    swap(taken);
+    return *this;
+  }
+
+  void swap(SlotArray& other) noexcept {
+    std::swap(meta_, other.meta_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+  /**
+   * Number of slots, 0 when nothing is allocated
+   */
+  size_type capacity() const { return capacity_; }
+
+  /**
+   * capacity() + PADDING metadata bytes
+   */
+  uint8_t* meta() { return meta_; }
+  const uint8_t* meta() const { return meta_; }
+
+  /**
+   * The entry in slot index, only valid while its byte is not EMPTY
+   */
+  Entry& operator[](size_type index) { return slots_[index]; }
+  const Entry& operator[](size_type index) const { return slots_[index]; }
+
+  /**
+   * Constructs an entry in the free slot index from args. The caller sets
+   * its metadata byte afterwards
+   */
+  template <typename... Args>
+  void construct(size_type index, Args&&... args) {
+    ::new (&slots_[index]) Entry(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Destroys the entry in slot index. The caller resets its metadata byte
+   */
+  void destroy(size_type index) { slots_[index].~Entry(); }
+
+  /**
+   * Destroys every live entry and sets every metadata byte, the padding too,
+   * back to EMPTY. The slots stay allocated
+   */
+  void clear();
+
+  class iterator;
+  class const_iterator;
+
+  iterator begin() { return iterator(this, 0); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  // Forward iterator over the live entries, in slot order
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Entry*;
+    using reference = Entry&;
+
+    iterator() : array_(nullptr), index_(0) {}
+
+    Entry& operator*() const { return (*array_)[index_]; }
+    Entry* operator->() const { return &(*array_)[index_]; }
+
+    iterator& operator++() {
+      ++index_;
+      skip_empty();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+
+    bool operator==(const iterator& other) const {
+      return array_ == other.array_ && index_ == other.index_;
+    }
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class SlotArray;
+    friend class const_iterator;
+
+    iterator(SlotArray* array, size_type index)
+        : array_(array), index_(index) {
+      skip_empty();
+    }
+
+    void skip_empty() {
+      while (index_ < array_->capacity_ && array_->meta_[index_] == EMPTY) {
+        ++index_;
+      }
+    }
+
+    SlotArray* array_;
+    size_type index_;
+  };
+
+  // Const forward iterator over the live entries, in slot order
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Entry*;
+    using reference = const Entry&;
+
+    const_iterator() : array_(nullptr), index_(0) {}
+
+    const_iterator(const iterator& it) : array_(it.array_), index_(it.index_) {}
+
+    const Entry& operator*() const { return (*array_)[index_]; }
+    const Entry* operator->() const { return &(*array_)[index_]; }
+
+    const_iterator& operator++() {
+      ++index_;
+      skip_empty();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return array_ == other.array_ && index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class SlotArray;
+
+    const_iterator(const SlotArray* array, size_type index)
+        : array_(array), index_(index) {
+      skip_empty();
+    }
+
+    void skip_empty() {
+      while (index_ < array_->capacity_ && array_->meta_[index_] == EMPTY) {
+        ++index_;
+      }
+    }
+
+    const SlotArray* array_;
+    size_type index_;
+  };
+
+ private:
+  uint8_t* meta_ = nullptr;
+  Entry* slots_ = nullptr;  // raw storage, only slots with a live byte
+  size_type capacity_ = 0;
+};
+
+template <typename Entry, uint8_t EMPTY, std::size_t PADDING>
+SlotArray<Entry, EMPTY, PADDING>::SlotArray(size_type capacity)
+    : capacity_(capacity) {
+  if (capacity_ == 0) {
+    return;
+  }
+  meta_ = new uint8_t[capacity_ + PADDING];
+  std::memset(meta_, EMPTY, capacity_ + PADDING);
+  try {
+    slots_ = static_cast<Entry*>(::operator new(
+        capacity_ * sizeof(Entry), std::align_val_t(alignof(Entry))));
+  } catch (...) {
+    delete[] meta_;
+    throw;
+  }
+}
+
+template <typename Entry, uint8_t EMPTY, std::size_t PADDING>
+SlotArray<Entry, EMPTY, PADDING>::SlotArray(const SlotArray& other)
+    : SlotArray(other.capacity_) {
+  // each byte is only copied once its entry exists, so if a copy throws the
+  // destructor frees exactly the entries built so far
+  for (size_type i = 0; i < capacity_; ++i) {
+    if (other.meta_[i] != EMPTY) {
+      construct(i, other.slots_[i]);
+      meta_[i] = other.meta_[i];
+    }
+  }
+  if (capacity_ != 0) {
+    std::memcpy(meta_ + capacity_, other.meta_ + capacity_, PADDING);
+  }
+}
+
+template <typename Entry, uint8_t EMPTY, std::size_t PADDING>
+void SlotArray<Entry, EMPTY, PADDING>::clear() {
+  for (size_type i = 0; i < capacity_; ++i) {
+    if (meta_[i] != EMPTY) {
+      destroy(i);
+    }
+  }
+  if (capacity_ != 0) {
+    std::memset(meta_, EMPTY, capacity_ + PADDING);
+  }
+}
+
+template <typename Entry, uint8_t EMPTY, std::size_t PADDING>
+SlotArray<Entry, EMPTY, PADDING>::~SlotArray() {
+  if (meta_ == nullptr) {
+    return;
+  }
+  for (size_type i = 0; i < capacity_; ++i) {
+    if (meta_[i] != EMPTY) {
+      destroy(i);
+    }
+  }
+  ::operator delete(slots_, std::align_val_t(alignof(Entry)));
+  delete[] meta_;
+}
+
+#endif  // SLOT_ARRAY_H_
@@ -0,0 +1,68 @@
+#ifndef XXHASH_FUNCTOR_H_
+#define XXHASH_FUNCTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#define XXH_INLINE_ALL
+#include "../BloomFilter/xxhash.h"
+
+/**
+ * Hash function object built on the xxHash bundled with BloomFilter.
+ *
+ * Unlike std::hash, which is the identity for integers, every output bit
+ * depends on every input bit, so a table can take the low bits as the bucket
+ * index.
+ *
+ * Strings are hashed from their bytes with XXH3. Integral, enum and pointer
+ * keys fit in a word and only go through the xxHash avalanche. Any other
+ * type with a std::hash goes through std::hash first and the avalanche then
+ * mixes the result.
+ */
+template <typename T>
+struct XXHash {
+  std::size_t operator()(const T& value) const {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      return static_cast<std::size_t>(XXH3_64bits(value.data(), value.size()));
+    } else if constexpr ((std::is_integral_v<T> || std::is_enum_v<T> ||
+                          std::is_pointer_v<T>) &&
+                         sizeof(T) <= 8) {
+      // a word only needs xxHash's final avalanche, the full XXH3 pass reads
+      // its secret and costs about twice as much for nothing
+      return static_cast<std::size_t>(XXH64_avalanche(to_word(value)));
+    } else {
+      // floating point goes this way too, std::hash knows 0.0 == -0.0
+      std::size_t hash = std::hash<T>{}(value);
+      return static_cast<std::size_t>(XXH64_avalanche(hash));
+    }
+  }
+
+ private:
+  static uint64_t to_word(const T& value) {
+    if constexpr (std::is_pointer_v<T>) {
+      return static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+    } else {
+      return static_cast<uint64_t>(value);
+    }
+  }
+};
+
+/**
+ * Strings hash through std::string_view, so a transparent table keyed by
+ * std::string can also be searched with a std::string_view or a const char*
+ * without building a std::string first
+ */
+template <>
+struct XXHash<std::string> {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view value) const {
+    return XXHash<std::string_view>{}(value);
+  }
+};
+
+#endif  // XXHASH_FUNCTOR_H_
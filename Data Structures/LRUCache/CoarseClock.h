@@ -0,0 +1,33 @@
+#ifndef COARSE_CLOCK_H_
+#define COARSE_CLOCK_H_
+
+#include <time.h>
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Monotonic clock with the interface of std::chrono::steady_clock, read
+ * from CLOCK_MONOTONIC_COARSE.
+ *
+ * The kernel only moves it once per scheduler tick, every 1 to 4 ms, but in
+ * exchange reading it is a couple of loads from the vDSO page with no
+ * hardware timer read, so a cache can afford to look at it on every lookup.
+ * Plenty for expiry measured in seconds.
+ */
+struct CoarseClock {
+  using duration = std::chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<CoarseClock>;
+
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return time_point(duration(int64_t{ts.tv_sec} * 1000000000 + ts.tv_nsec));
+  }
+};
+
+#endif  // COARSE_CLOCK_H_
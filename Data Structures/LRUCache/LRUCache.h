@@ -1,27 +1,71 @@
 #ifndef LRU_CACHE_H_
 #define LRU_CACHE_H_
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
 #include <stdexcept>
-#include <unordered_map>
-
-template <typename K, typename V>
+#include <utility>
+
+#include "../HashTable/XXHash.h"
+#include "CoarseClock.h"
+#include "TimerWheel.h"
+
+// Index slots per cached entry. The index is sized once for capacity_, so it
+// never grows, and at half full a linear probe stays within a slot or two
+inline constexpr std::size_t LRU_INDEX_SLOTS_PER_ENTRY = 2;
+
+/**
+ * Least recently used cache with a fixed capacity.
+ *
+ * Every node lives in one array of capacity_ nodes allocated up front, and
+ * the recency list is threaded through the nodes themselves. A full cache
+ * reuses the evicted node for the new entry, so once it has filled up, put
+ * never allocates. Keys are found through an open addressing index of node
+ * numbers beside the array; each operation hashes its key once and probes
+ * the index once.
+ *
+ * An entry can also be given a time to live. Those entries are indexed in
+ * a TimerWheel by deadline: a lookup that finds one past its deadline drops
+ * it on the spot, and expire_up_to() reclaims the rest in amortized O(1)
+ * each, without scanning the cache. The wheel links sit in a second array
+ * beside the nodes, allocated by the first put with a ttl, so a cache that
+ * never uses one pays nothing for it. Time comes from Clock and is only
+ * read for entries that have a deadline. A removed entry's node goes on a
+ * free list threaded through the dead nodes, and the next put takes it from
+ * there.
+ *
+ * Nodes never move, so a pointer returned by find() stays valid until its
+ * own entry is evicted, expires or is removed.
+ */
+template <typename K, typename V, typename Hash = XXHash<K>,
+          typename KeyEqual = std::equal_to<K>, typename Clock = CoarseClock>
 class LRUCache {
+ public:
   using size_type = std::size_t;
   using key_type = K;
   using value_type = V;
+  using duration = typename Clock::duration;
+  using time_point = typename Clock::time_point;
 
- public:
   /**
-   * Initalizes an empty LRU cache with the given capacity
-   *
-   * REQUIRES:
-   * capacity > 0
+   * Initalizes an empty LRU cache with the given capacity, allocating room
+   * for every entry it will ever hold
    *
    * ARGS:
    * capacity: user defined capacity which will be used for the LRU protocol
+   * hash: hashes keys for the index
+   * equal: compares keys
+   * clock: tells the time for entries with a time to live
+   *
+   * THROWS:
+   * std::invalid_argument if capacity is 0 or does not fit the index
    */
-  LRUCache(size_type capacity);
+  LRUCache(size_type capacity, const Hash& hash = Hash(),
+           const KeyEqual& equal = KeyEqual(), const Clock& clock = Clock());
 
   LRUCache(const LRUCache& other);
 
@@ -33,6 +77,19 @@ class LRUCache {
 
   LRUCache& operator=(LRUCache&& other);
 
+  /**
+   * Finds the value associated with the given key and marks it as the most
+   * recently used. A miss costs one probe and never throws. An entry past
+   * its deadline is removed and counts as a miss
+   *
+   * ARGS:
+   * key: the key that we are trying to find the value associated with
+   *
+   * RETURNS:
+   * pointer to the value, nullptr if the key is not inside the cache
+   */
+  value_type* find(const key_type& key);
+
   /**
    * Returns the value associated with the given key
    *
@@ -43,213 +100,593 @@ class LRUCache {
    * std::out_of_range if the key is not inside the cache
    *
    * RETURNS:
-   * the value associated with the key
+   * reference to the value associated with the key
    */
-  value_type get(const key_type& key);
+  value_type& get(const key_type& key);
 
   /**
    * Adds the key-value pair into the cache (or if they key already exists
-   * it will replace the value with the given one)
+   * it will replace the value with the given one in place)
    * if the new item exceeds the capacity it will then remove the least
    * recentely used key-value pair
    * in the cache to make space for the new item
    *
+   * An existing entry loses any time to live it had
+   *
    * ARGS:
    * key: the key assocaited with the value that is unique to the value
    * value: the value of the key
    */
   void put(const key_type& key, const value_type& value);
+  void put(key_type&& key, value_type&& value);
+
+  /**
+   * Same as put(key, value), but the entry expires once ttl has passed on
+   * the clock. An existing entry gets the new deadline
+   *
+   * ARGS:
+   * key: the key assocaited with the value that is unique to the value
+   * value: the value of the key
+   * ttl: how long the entry lives
+   *
+   * THROWS:
+   * std::invalid_argument if ttl is not positive
+   */
+  void put(const key_type& key, const value_type& value, duration ttl);
+  void put(key_type&& key, value_type&& value, duration ttl);
+
+  /**
+   * Removes every entry whose deadline has passed by now, up to the
+   * millisecond granularity of the TimerWheel. Costs amortized O(1) per
+   * reclaimed entry, plus a bounded walk over the wheel's slots
+   *
+   * ARGS:
+   * now: a time read from the cache's clock
+   *
+   * RETURNS:
+   * the number of entries removed
+   */
+  size_type expire_up_to(time_point now);
+
+  /**
+   * Number of entries, including expired ones not yet looked up or reclaimed
+   * by expire_up_to()
+   */
+  size_type size() const { return size_; }
+
+  size_type capacity() const { return capacity_; }
+
+  bool empty() const { return size_ == 0; }
 
  private:
-  struct Node {
+  // recency list links, the sentinel head_ only has these
+  struct Links {
+    Links* prev = nullptr;
+    Links* next = nullptr;
+  };
+
+  struct Node : Links {
     key_type key;
     value_type value;
-    Node* prev = nullptr;
-    Node* next = nullptr;
+    size_type hash;
 
-    Node();
+    template <typename KeyArg, typename ValueArg>
+    Node(size_type hash, KeyArg&& key, ValueArg&& value)
+        : key(std::forward<KeyArg>(key)),
+          value(std::forward<ValueArg>(value)),
+          hash(hash) {}
+  };
 
-    Node(key_type key, value_type val);
+  // An index entry: which node, and the low bits of its hash so most
+  // mismatches are rejected without touching the node
+  struct Slot {
+    uint32_t node;
+    uint32_t tag;
   };
 
-  std::unordered_map<K, Node*> map_;
-  Node* head_;
-  Node* tail_;
-  size_type capacity_;
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+  Node* nodes_ = nullptr;  // capacity_ nodes, the live ones are on the list
+  // removed nodes, each holding only the Links of the next in next
+  Links* free_ = nullptr;
+  size_type used_ = 0;  // nodes_[used_] onwards have never been handed out
+  Slot* slots_ = nullptr;
+  // wheel links of nodes_[i] at timers_[i], nullptr until a ttl is used
+  TimerLinks* timers_ = nullptr;
+  size_type mask_ = 0;
+  size_type size_ = 0;
+  size_type capacity_ = 0;
+  Links head_;  // head_.next is the least recently used, head_.prev the most
+  Hash hasher_;
+  KeyEqual key_equal_;
+  Clock clock_;
+  TimerWheel wheel_;
+
+  /**
+   * Helper function that walks the index from hash's home slot
+   *
+   * RETURNS:
+   * the slot holding key, or the empty slot that ends its run
+   */
+  size_type probe(size_type hash, const key_type& key) const;
+
+  /**
+   * Helper function that finds the slot pointing at node
+   */
+  size_type slot_of(const Node* node) const;
+
+  /**
+   * Helper function that empties an index slot, shifting the rest of its run
+   * back so no probe is cut short by the hole
+   */
+  void erase_slot(size_type index);
+
+  /**
+   * Helper function behind every put
+   *
+   * ARGS:
+   * deadline: nanoseconds on the clock, or TimerLinks::NEVER
+   */
+  template <typename KeyArg, typename ValueArg>
+  void put_entry(KeyArg&& key, ValueArg&& value, int64_t deadline);
+
+  /**
+   * Helper function that turns a ttl into a deadline
+   */
+  int64_t deadline_after(duration ttl);
+
+  /**
+   * Helper function that gives node a new deadline, moving it on the wheel
+   */
+  void set_deadline(const Node* node, int64_t deadline);
+
+  int64_t deadline_of(const Node* node) const {
+    return timers_ == nullptr ? TimerLinks::NEVER
+                              : timers_[node - nodes_].deadline;
+  }
 
+  /**
+   * Helper function that drops node from the list, the wheel and the index,
+   * then destroys it and puts its storage on the free list
+   */
   void remove(Node* node);
-  void insert(Node* node);
-  bool empty();
-  void clear();
-};
 
-template <typename K, typename V>
-LRUCache<K, V>::Node::Node() : key(K()), value(V()) {}
+  void push_free(void* storage) {
+    free_ = ::new (storage) Links{nullptr, free_};
+  }
 
-template <typename K, typename V>
-LRUCache<K, V>::Node::Node(typename LRUCache<K, V>::key_type key,
-                           typename LRUCache<K, V>::value_type val)
-    : key(key), value(val) {}
+  /**
+   * Helper function behind the lazy expiry in find(), kept out of line so
+   * find() stays small enough to inline
+   *
+   * RETURNS:
+   * true if node was past its deadline and has been removed
+   */
+  bool remove_if_expired(Node* node);
 
-template <typename K, typename V>
-LRUCache<K, V>::LRUCache(size_type capacity) : capacity_(capacity) {
-  head_ = new Node();
-  tail_ = new Node();
-  head_->next = tail_;
-  tail_->prev = head_;
-}
+  static int64_t to_nanos(time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch())
+        .count();
+  }
+
+  void unlink(Links* node);
+  void link_back(Links* node);
+
+  /**
+   * Helper function that moves node to the most recently used end
+   */
+  void touch(Node* node) {
+    if (head_.prev != node) {
+      unlink(node);
+      link_back(node);
+    }
+  }
+
+  /**
+   * Helper function that takes other's arrays and list, leaving it empty
+   * with no capacity. IMPORTANT: this must not own any arrays
+   */
+  void steal(LRUCache& other);
 
-template <typename K, typename V>
-LRUCache<K, V>::LRUCache(const LRUCache& other) : capacity_(other.capacity_) {
-  head_ = new Node();
-  tail_ = new Node();
-  head_->next = tail_;
-  tail_->prev = head_;
+  /**
+   * Helper function that destroys every node and frees both arrays
+   */
+  void release();
+};
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>::LRUCache(size_type capacity,
+                                                const Hash& hash,
+                                                const KeyEqual& equal,
+                                                const Clock& clock)
+    : capacity_(capacity),
+      hasher_(hash),
+      key_equal_(equal),
+      clock_(clock),
+      wheel_(to_nanos(clock_.now())) {
+  if (capacity == 0 || capacity >= EMPTY_SLOT / LRU_INDEX_SLOTS_PER_ENTRY) {
+    throw std::invalid_argument("LRUCache: capacity out of range");
+  }
+  size_type num_slots = 1;
+  while (num_slots < capacity * LRU_INDEX_SLOTS_PER_ENTRY) {
+    num_slots *= 2;
+  }
+  mask_ = num_slots - 1;
+  nodes_ = std::allocator<Node>().allocate(capacity_);
+  slots_ = new Slot[num_slots];
+  for (size_type i = 0; i < num_slots; i++) {
+    slots_[i].node = EMPTY_SLOT;
+  }
+  head_.next = &head_;
+  head_.prev = &head_;
+}
 
-  // Deep copy the linked list
-  Node* other_curr = other.head_->next;
-  while (other_curr != other.tail_) {
-    Node* new_node = new Node(other_curr->key, other_curr->value);
-    map_[new_node->key] = new_node;
-    insert(new_node);
-    other_curr = other_curr->next;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>::LRUCache(const LRUCache& other)
+    : LRUCache(other.capacity_, other.hasher_, other.key_equal_,
+               other.clock_) {
+  // least recently used first, so the copy ends up in the same order
+  for (Links* curr = other.head_.next; curr != &other.head_;
+       curr = curr->next) {
+    Node* node = static_cast<Node*>(curr);
+    put_entry(node->key, node->value, other.deadline_of(node));
   }
 }
 
-template <typename K, typename V>
-LRUCache<K, V>::LRUCache(LRUCache&& other)
-    : map_(std::move(other.map_)),
-      head_(other.head_),
-      tail_(other.tail_),
-      capacity_(other.capacity_) {
-  // Steal resources
-  other.head_ = nullptr;
-  other.tail_ = nullptr;
-  other.capacity_ = 0;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>::LRUCache(LRUCache&& other)
+    : hasher_(other.hasher_),
+      key_equal_(other.key_equal_),
+      clock_(other.clock_) {
+  steal(other);
 }
 
-template <typename K, typename V>
-LRUCache<K, V>::~LRUCache() {
-  Node* curr = head_;
-  while (curr != nullptr) {
-    Node* temp = curr->next;
-    delete curr;
-    curr = temp;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>::~LRUCache() {
+  release();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>&
+LRUCache<K, V, Hash, KeyEqual, Clock>::operator=(const LRUCache& other) {
+  if (this == &other) {
+    return *this;
   }
+  LRUCache copy(other);
+  release();
+  hasher_ = copy.hasher_;
+  key_equal_ = copy.key_equal_;
+  clock_ = copy.clock_;
+  steal(copy);
+  return *this;
 }
 
-template <typename K, typename V>
-LRUCache<K, V>& LRUCache<K, V>::operator=(const LRUCache& other) {
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+LRUCache<K, V, Hash, KeyEqual, Clock>&
+LRUCache<K, V, Hash, KeyEqual, Clock>::operator=(LRUCache&& other) {
   if (this == &other) {
     return *this;
   }
+  release();
+  hasher_ = other.hasher_;
+  key_equal_ = other.key_equal_;
+  clock_ = other.clock_;
+  steal(other);
+  return *this;
+}
 
-  clear();
-  capacity_ = other.capacity_;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+typename LRUCache<K, V, Hash, KeyEqual, Clock>::value_type*
+LRUCache<K, V, Hash, KeyEqual, Clock>::find(const key_type& key) {
+  if (size_ == 0) {
+    return nullptr;
+  }
+  size_type index = probe(hasher_(key), key);
+  if (slots_[index].node == EMPTY_SLOT) {
+    return nullptr;
+  }
+  Node* node = &nodes_[slots_[index].node];
+  if (timers_ != nullptr && remove_if_expired(node)) {
+    return nullptr;
+  }
+  touch(node);
+  return &node->value;
+}
 
-  // Deep copy
-  Node* other_curr = other.head_->next;
-  while (other_curr != other.tail_) {
-    Node* new_node = new Node(other_curr->key, other_curr->value);
-    map_[new_node->key] = new_node;
-    insert(new_node);
-    other_curr = other_curr->next;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+typename LRUCache<K, V, Hash, KeyEqual, Clock>::value_type&
+LRUCache<K, V, Hash, KeyEqual, Clock>::get(const key_type& key) {
+  value_type* value = find(key);
+  if (value == nullptr) {
+    throw std::out_of_range("LRUCache::get, key doesnt exist in the table");
   }
+  return *value;
+}
 
-  return *this;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::put(const key_type& key,
+                                                const value_type& value) {
+  put_entry(key, value, TimerLinks::NEVER);
 }
 
-template <typename K, typename V>
-LRUCache<K, V>& LRUCache<K, V>::operator=(LRUCache&& other) {
-  if (this == &other) {
-    return *this;
-  }
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::put(key_type&& key,
+                                                value_type&& value) {
+  put_entry(std::move(key), std::move(value), TimerLinks::NEVER);
+}
 
-  // Clean up current resources
-  clear();
-  delete head_;
-  delete tail_;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::put(const key_type& key,
+                                                const value_type& value,
+                                                duration ttl) {
+  put_entry(key, value, deadline_after(ttl));
+}
 
-  // Steal resources
-  map_ = std::move(other.map_);
-  head_ = other.head_;
-  tail_ = other.tail_;
-  capacity_ = other.capacity_;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::put(key_type&& key,
+                                                value_type&& value,
+                                                duration ttl) {
+  put_entry(std::move(key), std::move(value), deadline_after(ttl));
+}
 
-  other.head_ = nullptr;
-  other.tail_ = nullptr;
-  other.capacity_ = 0;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+typename LRUCache<K, V, Hash, KeyEqual, Clock>::size_type
+LRUCache<K, V, Hash, KeyEqual, Clock>::expire_up_to(time_point now) {
+  size_type reclaimed = 0;
+  wheel_.advance(to_nanos(now), [&](TimerLinks* entry) {
+    remove(&nodes_[entry - timers_]);
+    reclaimed++;
+  });
+  return reclaimed;
+}
 
-  return *this;
+// -- Private Helper -- //
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+template <typename KeyArg, typename ValueArg>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::put_entry(KeyArg&& key,
+                                                      ValueArg&& value,
+                                                      int64_t deadline) {
+  if (capacity_ == 0) {
+    // moved from
+    return;
+  }
+  size_type hash = hasher_(key);
+  size_type index = probe(hash, key);
+  if (slots_[index].node != EMPTY_SLOT) {
+    Node* node = &nodes_[slots_[index].node];
+    node->value = std::forward<ValueArg>(value);
+    set_deadline(node, deadline);
+    touch(node);
+    return;
+  }
+
+  Node* node;
+  if (size_ < capacity_) {
+    void* storage;
+    if (free_ != nullptr) {
+      storage = std::exchange(free_, free_->next);
+    } else {
+      storage = &nodes_[used_++];
+    }
+    try {
+      node = ::new (storage)
+          Node(hash, std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+    } catch (...) {
+      push_free(storage);
+      throw;
+    }
+    size_++;
+  } else {
+    // the least recently used node takes the new entry
+    node = static_cast<Node*>(head_.next);
+    unlink(node);
+    erase_slot(slot_of(node));
+    try {
+      node->key = std::forward<KeyArg>(key);
+      node->value = std::forward<ValueArg>(value);
+    } catch (...) {
+      // the node is already off the list and the index, so finish evicting
+      // it rather than leave it half replaced
+      set_deadline(node, TimerLinks::NEVER);
+      node->~Node();
+      push_free(node);
+      size_--;
+      throw;
+    }
+    node->hash = hash;
+    // the shift may have opened a hole earlier in the key's run, and the
+    // key is new, so its slot is the first empty one from home
+    index = hash & mask_;
+    while (slots_[index].node != EMPTY_SLOT) {
+      index = (index + 1) & mask_;
+    }
+  }
+  slots_[index] = Slot{static_cast<uint32_t>(node - nodes_),
+                       static_cast<uint32_t>(hash)};
+  link_back(node);
+  set_deadline(node, deadline);
 }
 
-template <typename K, typename V>
-typename LRUCache<K, V>::value_type LRUCache<K, V>::get(const key_type& key) {
-  const auto& it = map_.find(key);
-  if (it == map_.end()) {
-    throw std::out_of_range("LRUCache::get, key doesnt exist in the table");
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+int64_t LRUCache<K, V, Hash, KeyEqual, Clock>::deadline_after(duration ttl) {
+  if (ttl <= duration::zero()) {
+    throw std::invalid_argument("LRUCache::put, ttl must be positive");
+  }
+  return to_nanos(clock_.now() + ttl);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::set_deadline(const Node* node,
+                                                         int64_t deadline) {
+  if (timers_ == nullptr) {
+    if (deadline == TimerLinks::NEVER) {
+      return;
+    }
+    timers_ = new TimerLinks[capacity_];
+  }
+  TimerLinks* timer = &timers_[node - nodes_];
+  TimerWheel::cancel(timer);
+  timer->deadline = deadline;
+  if (deadline != TimerLinks::NEVER) {
+    wheel_.schedule(timer);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+bool LRUCache<K, V, Hash, KeyEqual, Clock>::remove_if_expired(Node* node) {
+  int64_t deadline = deadline_of(node);
+  if (deadline == TimerLinks::NEVER || deadline > to_nanos(clock_.now())) {
+    return false;
   }
-  Node* node = it->second;
-  V value = node->value;
-  // this is the currently used one so we can delete it and then add it back
   remove(node);
-  insert(node);
-  return value;
+  return true;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::remove(Node* node) {
+  unlink(node);
+  erase_slot(slot_of(node));
+  set_deadline(node, TimerLinks::NEVER);
+  node->~Node();
+  push_free(node);
+  size_--;
 }
 
-template <typename K, typename V>
-void LRUCache<K, V>::put(const key_type& key, const value_type& value) {
-  auto iter = map_.find(key);
-  if (iter != map_.end()) {
-    remove(iter->second);
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+typename LRUCache<K, V, Hash, KeyEqual, Clock>::size_type
+LRUCache<K, V, Hash, KeyEqual, Clock>::probe(size_type hash,
+                                             const key_type& key) const {
+  const uint32_t tag = static_cast<uint32_t>(hash);
+  size_type index = hash & mask_;
+  while (slots_[index].node != EMPTY_SLOT) {
+    if (slots_[index].tag == tag &&
+        key_equal_(nodes_[slots_[index].node].key, key)) {
+      return index;
+    }
+    index = (index + 1) & mask_;
   }
+  return index;
+}
 
-  Node* new_node = new Node(key, value);
-  map_[key] = new_node;
-  insert(new_node);
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+typename LRUCache<K, V, Hash, KeyEqual, Clock>::size_type
+LRUCache<K, V, Hash, KeyEqual, Clock>::slot_of(const Node* node) const {
+  const uint32_t number = static_cast<uint32_t>(node - nodes_);
+  size_type index = node->hash & mask_;
+  while (slots_[index].node != number) {
+    index = (index + 1) & mask_;
+  }
+  return index;
+}
 
-  if (map_.size() > capacity_) {
-    Node* node_to_eject = head_->next;
-    remove(node_to_eject);
-    map_.erase(node_to_eject->key);
-    delete node_to_eject;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::erase_slot(size_type index) {
+  size_type hole = index;
+  size_type next = (hole + 1) & mask_;
+  while (slots_[next].node != EMPTY_SLOT) {
+    // the tag holds the low bits of the hash, enough to find the home slot
+    size_type home = slots_[next].tag & mask_;
+    // an entry can fill the hole if the hole lies between its home and it
+    if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+    next = (next + 1) & mask_;
   }
+  slots_[hole].node = EMPTY_SLOT;
 }
 
-template <typename K, typename V>
-void LRUCache<K, V>::remove(Node* node) {
-  Node* previous_node = node->prev;
-  Node* next_node = node->next;
-  previous_node->next = next_node;
-  next_node->prev = previous_node;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::unlink(Links* node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
 }
 
-template <typename K, typename V>
-void LRUCache<K, V>::insert(Node* node) {
-  Node* previous_end = tail_->prev;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::link_back(Links* node) {
+  Links* previous_end = head_.prev;
   previous_end->next = node;
-  tail_->prev = node;
+  head_.prev = node;
 
   node->prev = previous_end;
-  node->next = tail_;
+  node->next = &head_;
 }
 
-template <typename K, typename V>
-bool LRUCache<K, V>::empty() {
-  return head_->next == tail_;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::steal(LRUCache& other) {
+  nodes_ = std::exchange(other.nodes_, nullptr);
+  free_ = std::exchange(other.free_, nullptr);
+  used_ = std::exchange(other.used_, 0);
+  slots_ = std::exchange(other.slots_, nullptr);
+  mask_ = std::exchange(other.mask_, 0);
+  size_ = std::exchange(other.size_, 0);
+  capacity_ = std::exchange(other.capacity_, 0);
+  timers_ = std::exchange(other.timers_, nullptr);
+  wheel_ = std::move(other.wheel_);
+  // the list runs through the sentinel, which does not move with it
+  if (size_ == 0) {
+    head_.next = &head_;
+    head_.prev = &head_;
+  } else {
+    head_ = other.head_;
+    head_.next->prev = &head_;
+    head_.prev->next = &head_;
+  }
+  other.head_.next = &other.head_;
+  other.head_.prev = &other.head_;
 }
 
-template <typename K, typename V>
-void LRUCache<K, V>::clear() {
-  Node* curr = head_->next;
-  while (curr != tail_) {
-    Node* temp = curr->next;
-    delete curr;
-    curr = temp;
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Clock>
+void LRUCache<K, V, Hash, KeyEqual, Clock>::release() {
+  if (nodes_ != nullptr) {
+    // only the nodes on the list are alive
+    for (Links* curr = head_.next; curr != &head_;) {
+      Node* node = static_cast<Node*>(curr);
+      curr = curr->next;
+      node->~Node();
+    }
+    std::allocator<Node>().deallocate(nodes_, capacity_);
   }
-  head_->next = tail_;
-  tail_->prev = head_;
-  map_.clear();
+  delete[] slots_;
+  delete[] timers_;
+  wheel_.clear();
+  nodes_ = nullptr;
+  free_ = nullptr;
+  used_ = 0;
+  slots_ = nullptr;
+  timers_ = nullptr;
+  mask_ = 0;
+  size_ = 0;
+  capacity_ = 0;
+  head_.next = &head_;
+  head_.prev = &head_;
 }
 
 #endif  // LRU_CACHE_H_
@@ -1,6 +1,29 @@
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+
 #include "LRUCache.h"
 #include "gtest/gtest.h"
 
+// counts heap allocations so tests can check a call makes none
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
 // ============= BASIC FUNCTIONALITY TESTS =============
 
 TEST(LRUCacheTest, BasicConstructor) {
@@ -319,4 +342,302 @@ TEST(LRUCacheTest, InterleavedGetPut) {
     ASSERT_EQ(lru.get(2), 2);
     ASSERT_EQ(lru.get(3), 3);
     ASSERT_EQ(lru.get(4), 4);
-}
\ No newline at end of file
+}
+
+// ============= FIND AND IN PLACE UPDATE TESTS =============
+
+TEST(LRUCacheTest, FindMissReturnsNull) {
+    LRUCache<int, int> lru(2);
+    ASSERT_EQ(lru.find(1), nullptr);
+    lru.put(1, 10);
+    ASSERT_EQ(lru.find(2), nullptr);
+    ASSERT_NE(lru.find(1), nullptr);
+    ASSERT_EQ(*lru.find(1), 10);
+}
+
+TEST(LRUCacheTest, FindRefreshesRecency) {
+    LRUCache<int, int> lru(2);
+    lru.put(1, 1);
+    lru.put(2, 2);
+    *lru.find(1) = 100;  // 1 becomes most recent, updated through the pointer
+    lru.put(3, 3);       // Evicts 2
+    ASSERT_EQ(lru.find(2), nullptr);
+    ASSERT_EQ(lru.get(1), 100);
+}
+
+TEST(LRUCacheTest, PutUpdatesInPlace) {
+    LRUCache<int, std::string> lru(2);
+    lru.put(1, "one");
+    std::string* value = lru.find(1);
+    lru.put(1, "uno");
+    ASSERT_EQ(lru.find(1), value);
+    ASSERT_EQ(*value, "uno");
+    ASSERT_EQ(lru.size(), 1);
+}
+
+TEST(LRUCacheTest, NoAllocationsOnceConstructed) {
+    LRUCache<int, int> lru(64);
+    size_t before = allocations;
+    for (int i = 0; i < 10000; i++) {
+        lru.put(i, i);
+        lru.find(i - 32);
+        lru.find(-i);
+    }
+    ASSERT_EQ(allocations, before);
+    ASSERT_EQ(lru.size(), 64);
+    ASSERT_EQ(lru.capacity(), 64);
+}
+
+TEST(LRUCacheTest, ChurnKeepsIndexConsistent) {
+    // small capacity so evictions keep shifting the same index runs
+    LRUCache<int, int> lru(7);
+    for (int i = 0; i < 5000; i++) {
+        lru.put(i % 23, i);
+        if (i % 3 == 0) {
+            lru.find((i * 7) % 23);
+        }
+        ASSERT_EQ(*lru.find(i % 23), i);
+    }
+    int present = 0;
+    for (int key = 0; key < 23; key++) {
+        present += lru.find(key) != nullptr;
+    }
+    ASSERT_EQ(present, 7);
+}
+
+struct NoDefault {
+    explicit NoDefault(int value) : value(value) {}
+    int value;
+};
+
+TEST(LRUCacheTest, NonDefaultConstructibleValues) {
+    LRUCache<std::string, NoDefault> lru(2);
+    lru.put("a", NoDefault(1));
+    lru.put("b", NoDefault(2));
+    lru.put("c", NoDefault(3));
+    ASSERT_EQ(lru.find("a"), nullptr);
+    ASSERT_EQ(lru.get("c").value, 3);
+}
+
+TEST(LRUCacheTest, MovedFromIsEmpty) {
+    LRUCache<int, int> lru(2);
+    lru.put(1, 1);
+    LRUCache<int, int> other = std::move(lru);
+    ASSERT_TRUE(lru.empty());
+    ASSERT_EQ(lru.find(1), nullptr);
+    ASSERT_EQ(other.get(1), 1);
+    lru = other;
+    ASSERT_EQ(lru.get(1), 1);
+}
+
+TEST(LRUCacheTest, ZeroCapacityThrows) {
+    ASSERT_THROW((LRUCache<int, int>(0)), std::invalid_argument);
+}
+
+// ============= TIME TO LIVE TESTS =============
+
+// clock the tests move by hand
+struct ManualClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<ManualClock>;
+
+    static constexpr bool is_steady = true;
+
+    static inline time_point current{};
+
+    static time_point now() { return current; }
+
+    static void advance(duration by) { current += by; }
+};
+
+using TtlCache = LRUCache<int, std::string, XXHash<int>, std::equal_to<int>,
+                          ManualClock>;
+
+using std::chrono::hours;
+using std::chrono::seconds;
+
+TEST(LRUCacheTest, TtlExpiresOnFind) {
+    TtlCache lru(4);
+    lru.put(1, "one", seconds(5));
+    lru.put(2, "two");
+    ManualClock::advance(seconds(4));
+    ASSERT_NE(lru.find(1), nullptr);
+    ManualClock::advance(seconds(1));
+    ASSERT_EQ(lru.find(1), nullptr);
+    ASSERT_THROW(lru.get(1), std::out_of_range);
+    ASSERT_EQ(lru.size(), 1);
+    ASSERT_EQ(lru.get(2), "two");
+}
+
+TEST(LRUCacheTest, PutReplacesTtl) {
+    TtlCache lru(4);
+    lru.put(1, "one", seconds(5));
+    lru.put(1, "uno");
+    lru.put(2, "two", seconds(5));
+    lru.put(2, "dos", seconds(20));
+    ManualClock::advance(seconds(10));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 0);
+    ASSERT_EQ(lru.get(1), "uno");
+    ASSERT_EQ(lru.get(2), "dos");
+    ManualClock::advance(seconds(11));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 1);
+    ASSERT_EQ(lru.find(2), nullptr);
+    ASSERT_EQ(lru.get(1), "uno");
+}
+
+TEST(LRUCacheTest, ExpireUpToReclaims) {
+    TtlCache lru(200);
+    for (int i = 1; i <= 100; i++) {
+        lru.put(i, std::to_string(i), seconds(i));
+        lru.put(-i, std::to_string(-i));
+    }
+    ManualClock::advance(std::chrono::milliseconds(50500));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 50);
+    ASSERT_EQ(lru.size(), 150);
+    // the array was compacted under the index, every survivor is still found
+    for (int i = 1; i <= 100; i++) {
+        ASSERT_EQ(lru.find(i) != nullptr, i > 50) << i;
+        ASSERT_EQ(lru.get(-i), std::to_string(-i));
+    }
+    ManualClock::advance(hours(1));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 50);
+    ASSERT_EQ(lru.size(), 100);
+}
+
+// Deadlines from seconds to weeks cascade down the wheel's levels
+TEST(LRUCacheTest, LongTtls) {
+    TtlCache lru(8);
+    lru.put(1, "hour", hours(1));
+    lru.put(2, "day", hours(24));
+    lru.put(3, "month", hours(24 * 30));
+    ManualClock::advance(std::chrono::minutes(59));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 0);
+    ManualClock::advance(std::chrono::minutes(2));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 1);
+    ManualClock::advance(hours(24));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 1);
+    ManualClock::advance(hours(24 * 28));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 0);
+    ManualClock::advance(hours(24));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 1);
+    ASSERT_TRUE(lru.empty());
+}
+
+TEST(LRUCacheTest, EvictionAndExpiryTogether) {
+    TtlCache lru(16);
+    std::mt19937 rng(3);
+    for (int i = 0; i < 20000; i++) {
+        int key = static_cast<int>(rng() % 64);
+        if (rng() % 2 == 0) {
+            lru.put(key, std::to_string(key), seconds(1 + rng() % 30));
+        } else {
+            lru.put(key, std::to_string(key));
+        }
+        std::string* value = lru.find(static_cast<int>(rng() % 64));
+        if (value != nullptr) {
+            ASSERT_EQ(lru.find(std::stoi(*value)), value);
+        }
+        if (i % 100 == 0) {
+            ManualClock::advance(seconds(rng() % 10));
+            lru.expire_up_to(ManualClock::now());
+        }
+        ASSERT_LE(lru.size(), 16);
+    }
+}
+
+// Nodes never move, so expiring, reclaiming or replacing one entry leaves a
+// pointer to another alone
+TEST(LRUCacheTest, FindPointerSurvivesOtherExpiry) {
+    TtlCache lru(4);
+    const std::string big(100, 'x');
+    lru.put(1, "one", seconds(1));
+    lru.put(2, big);
+    lru.put(3, "three", seconds(1));
+    std::string* p = lru.find(2);
+    ASSERT_NE(p, nullptr);
+    ManualClock::advance(seconds(2));
+    ASSERT_EQ(lru.find(1), nullptr);
+    ASSERT_EQ(*p, big);
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 1);
+    ASSERT_EQ(*p, big);
+    // new entries reuse the freed nodes
+    lru.put(4, "four");
+    lru.put(5, "five", seconds(1));
+    ASSERT_EQ(*p, big);
+    ASSERT_EQ(lru.find(2), p);
+    ASSERT_EQ(lru.size(), 3);
+    ASSERT_EQ(lru.get(4), "four");
+    ASSERT_EQ(lru.get(5), "five");
+}
+
+TEST(LRUCacheTest, CopyKeepsTtls) {
+    TtlCache lru(4);
+    lru.put(1, "one", seconds(5));
+    lru.put(2, "two");
+    TtlCache copy(lru);
+    TtlCache moved(std::move(lru));
+    ManualClock::advance(seconds(6));
+    ASSERT_EQ(copy.expire_up_to(ManualClock::now()), 1);
+    ASSERT_EQ(moved.expire_up_to(ManualClock::now()), 1);
+    ASSERT_EQ(copy.get(2), "two");
+    ASSERT_EQ(moved.get(2), "two");
+}
+
+// Copy assignment throws once armed, copy construction never does
+struct ThrowingAssign {
+    static inline bool armed = false;
+
+    explicit ThrowingAssign(int value) : value(value) {}
+    ThrowingAssign(const ThrowingAssign&) = default;
+    ThrowingAssign& operator=(const ThrowingAssign& other) {
+        if (armed) {
+            throw std::runtime_error("assignment failed");
+        }
+        value = other.value;
+        return *this;
+    }
+    int value;
+};
+
+// A put that throws while reusing the evicted node still finishes the
+// eviction, so the cache stays consistent
+TEST(LRUCacheTest, ThrowingPutOnFullCache) {
+    using Cache = LRUCache<int, ThrowingAssign, XXHash<int>,
+                           std::equal_to<int>, ManualClock>;
+    Cache lru(2);
+    lru.put(1, ThrowingAssign(1), seconds(1));
+    lru.put(2, ThrowingAssign(2));
+    const ThrowingAssign three(3);
+    ThrowingAssign::armed = true;
+    ASSERT_THROW(lru.put(3, three), std::runtime_error);
+    ThrowingAssign::armed = false;
+    ASSERT_EQ(lru.size(), 1);
+    ASSERT_EQ(lru.find(1), nullptr);
+    ASSERT_EQ(lru.find(3), nullptr);
+    ManualClock::advance(seconds(2));
+    ASSERT_EQ(lru.expire_up_to(ManualClock::now()), 0);
+    ASSERT_EQ(lru.get(2).value, 2);
+    lru.put(4, ThrowingAssign(4));
+    lru.put(5, ThrowingAssign(5));
+    ASSERT_EQ(lru.size(), 2);
+    ASSERT_EQ(lru.find(2), nullptr);
+    ASSERT_EQ(lru.get(4).value, 4);
+    ASSERT_EQ(lru.get(5).value, 5);
+}
+
+TEST(LRUCacheTest, NonPositiveTtlThrows) {
+    TtlCache lru(4);
+    ASSERT_THROW(lru.put(1, "one", seconds(0)), std::invalid_argument);
+    ASSERT_TRUE(lru.empty());
+}
+
+TEST(LRUCacheTest, CoarseClockIsDefault) {
+    LRUCache<int, int> lru(4);
+    lru.put(1, 1, hours(1));
+    ASSERT_EQ(lru.expire_up_to(CoarseClock::now()), 0);
+    ASSERT_EQ(lru.get(1), 1);
+    ASSERT_EQ(lru.expire_up_to(CoarseClock::now() + hours(2)), 1);
+    ASSERT_TRUE(lru.empty());
+}
@@ -0,0 +1,196 @@
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Links an entry embeds to be scheduled on a TimerWheel. deadline is in
+ * nanoseconds on whatever clock the wheel is driven by.
+ */
+struct TimerLinks {
+  static constexpr int64_t NEVER = INT64_MAX;
+
+  TimerLinks* prev = nullptr;  // both null while the entry is not scheduled
+  TimerLinks* next = nullptr;
+  int64_t deadline = NEVER;
+};
+
+/**
+ * Hierarchical timing wheel (Varghese and Lauck) over intrusive entries.
+ *
+ * Level 0 has SLOTS slots of 2^TICK_BITS ns (about a millisecond) each, and
+ * every slot of a higher level spans a whole level below it, so five levels
+ * of 64 slots reach about 13 days. An entry goes into the finest level whose
+ * span still covers its delay, in the slot of its deadline, so scheduling
+ * and cancelling are O(1).
+ *
+ * advance() visits, on every level whose tick moved, the slots the wheel has
+ * passed, at most SLOTS per level. Entries found there are either due and
+ * handed to the caller, or rescheduled, which always lands them on a finer
+ * level. An entry is visited at most a couple of times per level before it
+ * expires, so expiry is amortized O(1) per entry however far apart the calls
+ * are. The price is granularity: an entry is only handed back once the
+ * level 0 tick holding its deadline has passed.
+ *
+ * The slots are allocated on the first schedule(), so a wheel that never
+ * holds an entry costs nothing. Each wheel owns its slots, so it is movable
+ * but not copyable.
+ */
+class TimerWheel {
+ public:
+  static constexpr int LEVELS = 5;
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int64_t SLOTS = int64_t{1} << SLOT_BITS;
+  static constexpr int TICK_BITS = 20;
+
+  /**
+   * ARGS:
+   * now: the time the wheel starts at, in nanoseconds
+   */
+  explicit TimerWheel(int64_t now = 0) : time_(now) {}
+
+  /**
+   * The time of the last advance(), schedule() measures delays from here
+   */
+  int64_t time() const { return time_; }
+
+  /**
+   * Adds entry to the slot of its deadline. A deadline at or before time()
+   * goes into the current slot and is handed back by the next advance() that
+   * crosses a tick
+   *
+   * REQUIRES:
+   * entry is not scheduled and its deadline is not NEVER
+   */
+  void schedule(TimerLinks* entry);
+
+  /**
+   * Removes entry from its slot if it is scheduled
+   */
+  static void cancel(TimerLinks* entry) {
+    if (entry->next != nullptr) {
+      entry->prev->next = entry->next;
+      entry->next->prev = entry->prev;
+      entry->prev = nullptr;
+      entry->next = nullptr;
+    }
+  }
+
+  static bool scheduled(const TimerLinks* entry) {
+    return entry->next != nullptr;
+  }
+
+  /**
+   * Moves the wheel to now and unschedules every entry whose deadline has
+   * passed, calling expire on each. expire may cancel, free or move any
+   * entry, including ones still waiting in the slot being processed, as long
+   * as a moved entry's neighbours are relinked to its new address
+   *
+   * ARGS:
+   * now: the new time in nanoseconds, a time before time() does nothing
+   * expire: callable taking TimerLinks*
+   */
+  template <typename F>
+  void advance(int64_t now, F&& expire);
+
+  /**
+   * Forgets every scheduled entry without touching them
+   */
+  void clear() { slots_.reset(); }
+
+ private:
+  static constexpr int64_t SLOT_MASK = SLOTS - 1;
+
+  static constexpr int shift(int level) {
+    return TICK_BITS + level * SLOT_BITS;
+  }
+
+  TimerLinks& slot(int level, int64_t ticks) {
+    return slots_[level * SLOTS + (ticks & SLOT_MASK)];
+  }
+
+  static void link_back(TimerLinks& sentinel, TimerLinks* entry) {
+    entry->prev = sentinel.prev;
+    entry->next = &sentinel;
+    sentinel.prev->next = entry;
+    sentinel.prev = entry;
+  }
+
+  int64_t time_;
+  // LEVELS * SLOTS circular list sentinels, level by level
+  std::unique_ptr<TimerLinks[]> slots_;
+};
+
+inline void TimerWheel::schedule(TimerLinks* entry) {
+  if (slots_ == nullptr) {
+    slots_.reset(new TimerLinks[LEVELS * SLOTS]);
+    for (int64_t i = 0; i < LEVELS * SLOTS; ++i) {
+      slots_[i].prev = &slots_[i];
+      slots_[i].next = &slots_[i];
+    }
+  }
+  int64_t deadline = std::max(entry->deadline, time_);
+  int64_t delay = deadline - time_;
+  int level = 0;
+  while (level < LEVELS - 1 && (delay >> shift(level + 1)) != 0) {
+    ++level;
+  }
+  int64_t ticks = deadline >> shift(level);
+  if ((delay >> (shift(level) + SLOT_BITS)) != 0) {
+    // past the last level, park it in the furthest slot and let it come
+    // back round
+    ticks = (time_ >> shift(level)) + SLOT_MASK;
+  }
+  link_back(slot(level, ticks), entry);
+}
+
+template <typename F>
+void TimerWheel::advance(int64_t now, F&& expire) {
+  if (now <= time_) {
+    return;
+  }
+  int64_t previous = time_;
+  // rescheduling below measures from the new time
+  time_ = now;
+  if (slots_ == nullptr) {
+    return;
+  }
+  for (int level = 0; level < LEVELS; ++level) {
+    int64_t previous_ticks = previous >> shift(level);
+    int64_t delta = (now >> shift(level)) - previous_ticks;
+    if (delta == 0) {
+      // every coarser level is still on the same tick too
+      break;
+    }
+    int64_t steps = std::min(delta + 1, SLOTS);
+    for (int64_t i = 0; i < steps; ++i) {
+      TimerLinks& sentinel = slot(level, previous_ticks + i);
+      if (sentinel.next == &sentinel) {
+        continue;
+      }
+      // move the slot onto a local list first, rescheduled entries may land
+      // in this very slot again
+      TimerLinks pending;
+      pending.next = sentinel.next;
+      pending.prev = sentinel.prev;
+      pending.next->prev = &pending;
+      pending.prev->next = &pending;
+      sentinel.next = &sentinel;
+      sentinel.prev = &sentinel;
+      while (pending.next != &pending) {
+        TimerLinks* entry = pending.next;
+        cancel(entry);
+        if (entry->deadline <= now) {
+          expire(entry);
+        } else {
+          schedule(entry);
+        }
+      }
+    }
+  }
+}
+
+#endif  // TIMER_WHEEL_H_
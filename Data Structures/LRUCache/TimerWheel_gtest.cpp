@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TimerWheel.h"
+#include "gtest/gtest.h"
+
+struct TimedEntry : TimerLinks {
+  bool expired = false;
+};
+
+static constexpr int64_t TICK = int64_t{1} << TimerWheel::TICK_BITS;
+static constexpr int64_t SECOND = 1000000000;
+
+TEST(TimerWheelTest, expires_once_due) {
+  TimerWheel wheel(0);
+  TimedEntry entry;
+  entry.deadline = 5 * SECOND;
+  wheel.schedule(&entry);
+  int calls = 0;
+  auto expire = [&](TimerLinks* expired) {
+    ASSERT_EQ(expired, &entry);
+    calls++;
+  };
+  wheel.advance(4 * SECOND, expire);
+  ASSERT_EQ(calls, 0);
+  ASSERT_TRUE(TimerWheel::scheduled(&entry));
+  wheel.advance(5 * SECOND + TICK, expire);
+  ASSERT_EQ(calls, 1);
+  ASSERT_FALSE(TimerWheel::scheduled(&entry));
+  wheel.advance(100 * SECOND, expire);
+  ASSERT_EQ(calls, 1);
+}
+
+TEST(TimerWheelTest, cancel) {
+  TimerWheel wheel(0);
+  TimedEntry entry;
+  entry.deadline = SECOND;
+  wheel.schedule(&entry);
+  TimerWheel::cancel(&entry);
+  TimerWheel::cancel(&entry);
+  wheel.advance(10 * SECOND, [](TimerLinks*) { FAIL(); });
+}
+
+// A deadline beyond the top level keeps coming back round until it is due
+TEST(TimerWheelTest, beyond_last_level) {
+  TimerWheel wheel(0);
+  TimedEntry entry;
+  entry.deadline = 100 * 24 * 3600 * SECOND;
+  wheel.schedule(&entry);
+  int calls = 0;
+  for (int day = 1; day < 100; day++) {
+    wheel.advance(day * 24 * 3600 * SECOND, [&](TimerLinks*) { calls++; });
+  }
+  ASSERT_EQ(calls, 0);
+  wheel.advance(101 * 24 * 3600 * SECOND, [&](TimerLinks*) { calls++; });
+  ASSERT_EQ(calls, 1);
+}
+
+// Every entry comes back in the first advance past the tick of its deadline
+// and never earlier, whatever the step sizes
+TEST(TimerWheelTest, random_deadlines) {
+  std::mt19937_64 rng(7);
+  std::vector<TimedEntry> entries(5000);
+  TimerWheel wheel(0);
+  for (TimedEntry& entry : entries) {
+    entry.deadline = static_cast<int64_t>(rng() % (int64_t{1} << 42));
+    wheel.schedule(&entry);
+  }
+  int64_t now = 0;
+  while (now < (int64_t{1} << 42) + TICK) {
+    now += static_cast<int64_t>(rng() % (int64_t{1} << 36));
+    wheel.advance(now, [&](TimerLinks* link) {
+      auto* entry = static_cast<TimedEntry*>(link);
+      ASSERT_LE(entry->deadline, now);
+      ASSERT_FALSE(entry->expired);
+      entry->expired = true;
+    });
+    for (const TimedEntry& entry : entries) {
+      if (entry.deadline < now / TICK * TICK) {
+        ASSERT_TRUE(entry.expired);
+      }
+    }
+  }
+}
+
+// expire may cancel entries still waiting in the same slot
+TEST(TimerWheelTest, expire_cancels_neighbour) {
+  TimerWheel wheel(0);
+  TimedEntry first;
+  TimedEntry second;
+  first.deadline = SECOND;
+  second.deadline = SECOND;
+  wheel.schedule(&first);
+  wheel.schedule(&second);
+  int calls = 0;
+  wheel.advance(2 * SECOND, [&](TimerLinks* link) {
+    calls++;
+    TimerWheel::cancel(link == &first ? &second : &first);
+  });
+  ASSERT_EQ(calls, 1);
+}
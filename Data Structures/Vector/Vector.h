@@ -1,7 +1,8 @@
 #ifndef VECTOR_H_
 #define VECTOR_H_
 
-#include <cstddef>  // for std::size_t
+#include <algorithm>  // for std::fill
+#include <cstddef>    // for std::size_t
 #include <memory>
 #include <stdexcept>  // for std::out_of_range (throws)
 
@@ -38,6 +39,16 @@ class Vector {
    */
   Vector();
 
+  /**
+   * Constructs a vector holding count copies of value with a single
+   * allocation, instead of growing through push_back
+   *
+   * ARGS:
+   * count: number of elements
+   * value: the value every element starts as
+   */
+  Vector(size_type count, const T& value);
+
   /**
    * Constructs a vector by coping the contents of another vector
    *
@@ -291,6 +302,14 @@ template <typename T>
 Vector<T>::Vector()
     : capacity_(initial_capacity), size_(0), array_(new T[capacity_]) {}
 
+template <typename T>
+Vector<T>::Vector(size_type count, const T& value)
+    : capacity_(count > 0 ? count : initial_capacity),
+      size_(count),
+      array_(new T[capacity_]) {
+  std::fill(array_, array_ + size_, value);
+}
+
 template <typename T>
 Vector<T>::Vector(const Vector& other)
     : capacity_(other.capacity_), size_(other.size_) {
@@ -34,6 +34,20 @@ TEST(VectorTest, DefaultConstructorCreatesEmptyVector) {
   EXPECT_TRUE(vec.empty());
 }
 
+TEST(VectorTest, FillConstructor) {
+  Vector<int> vec(5, 7);
+  EXPECT_EQ(vec.size(), 5);
+  EXPECT_EQ(vec.capacity(), 5);
+  for (size_t i = 0; i < vec.size(); i++) {
+    EXPECT_EQ(vec[i], 7);
+  }
+  vec.push_back(8);
+  EXPECT_EQ(vec[5], 8);
+
+  Vector<int> empty(0, 1);
+  EXPECT_TRUE(empty.empty());
+}
+
 TEST(VectorTest, OperatorBrackerRead) {
   Vector<int> vec;
   vec.push_back(1);